@@ -51,6 +51,7 @@ SOURCES += \
     src/Game.cpp \
     src/Game.inl \
     src/Gamepad.cpp \
+    src/GlyphAtlas.cpp \
     src/HeightField.cpp \
     src/Image.cpp \
     src/Image.inl \
@@ -60,6 +61,7 @@ SOURCES += \
     src/Label.cpp \
     src/Layout.cpp \
     src/Light.cpp \
+    src/ListContainer.cpp \
     src/Logger.cpp \
     src/Material.cpp \
     src/MaterialParameter.cpp \
@@ -74,8 +76,10 @@ SOURCES += \
     src/MeshPart.cpp \
     src/MeshSkin.cpp \
     src/Model.cpp \
+    src/ModelBatch.cpp \
     src/Node.cpp \
     src/ParticleEmitter.cpp \
+    src/ParticleSystem.cpp \
     src/Pass.cpp \
     src/PhysicsCharacter.cpp \
     src/PhysicsCollisionObject.cpp \
@@ -106,6 +110,7 @@ SOURCES += \
     src/Ray.inl \
     src/Rectangle.cpp \
     src/Ref.cpp \
+    src/RenderCommandList.cpp \
     src/RenderState.cpp \
     src/RenderTarget.cpp \
     src/Scene.cpp \
@@ -121,12 +126,15 @@ SOURCES += \
     src/Slider.cpp \
     src/Sprite.cpp \
     src/SpriteBatch.cpp \
+    src/SpriteBatcher.cpp \
+    src/StaticBatcher.cpp \
     src/Technique.cpp \
     src/Terrain.cpp \
     src/TerrainPatch.cpp \
     src/Text.cpp \
     src/TextBox.cpp \
     src/Texture.cpp \
+    src/TextureAtlas.cpp \
     src/Theme.cpp \
     src/ThemeStyle.cpp \
     src/TileSet.cpp \
@@ -181,6 +189,7 @@ HEADERS += \
     src/Gamepad.h \
     src/gameplay.h \
     src/Gesture.h \
+    src/GlyphAtlas.h \
     src/HeightField.h \
     src/Image.h \
     src/ImageControl.h \
@@ -190,6 +199,7 @@ HEADERS += \
     src/Label.h \
     src/Layout.h \
     src/Light.h \
+    src/ListContainer.h \
     src/Logger.h \
     src/Material.h \
     src/MaterialParameter.h \
@@ -200,9 +210,11 @@ HEADERS += \
     src/MeshPart.h \
     src/MeshSkin.h \
     src/Model.h \
+    src/ModelBatch.h \
     src/Mouse.h \
     src/Node.h \
     src/ParticleEmitter.h \
+    src/ParticleSystem.h \
     src/Pass.h \
     src/PhysicsCharacter.h \
     src/PhysicsCollisionObject.h \
@@ -225,6 +237,7 @@ HEADERS += \
     src/Ray.h \
     src/Rectangle.h \
     src/Ref.h \
+    src/RenderCommandList.h \
     src/RenderState.h \
     src/RenderTarget.h \
     src/Scene.h \
@@ -240,6 +253,8 @@ HEADERS += \
     src/Slider.h \
     src/Sprite.h \
     src/SpriteBatch.h \
+    src/SpriteBatcher.h \
+    src/StaticBatcher.h \
     src/Stream.h \
     src/Technique.h \
     src/Terrain.h \
@@ -247,6 +262,7 @@ HEADERS += \
     src/Text.h \
     src/TextBox.h \
     src/Texture.h \
+    src/TextureAtlas.h \
     src/Theme.h \
     src/ThemeStyle.h \
     src/TileSet.h \
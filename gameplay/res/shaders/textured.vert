@@ -15,6 +15,10 @@
 // Atributes
 attribute vec4 a_position;
 
+#if defined(INSTANCING)
+attribute mat4 a_instanceMatrix;
+#endif
+
 #if defined(SKINNING)
 attribute vec4 a_blendWeights;
 attribute vec4 a_blendIndices;
@@ -38,17 +42,27 @@ attribute vec3 a_binormal;
 
 ///////////////////////////////////////////////////////////
 // Uniforms
+#if defined(INSTANCING)
+uniform mat4 u_viewProjectionMatrix;
+#else
 uniform mat4 u_worldViewProjectionMatrix;
+#endif
 #if defined(SKINNING)
 uniform vec4 u_matrixPalette[SKINNING_JOINT_COUNT * 3];
 #endif
 
 #if defined(LIGHTING)
+#if defined(INSTANCING)
+uniform mat4 u_viewMatrix;
+#else
 uniform mat4 u_inverseTransposeWorldViewMatrix;
+#endif
 
 #if defined(SPECULAR) || (POINT_LIGHT_COUNT > 0) || (SPOT_LIGHT_COUNT > 0)
+#if !defined(INSTANCING)
 uniform mat4 u_worldViewMatrix;
 #endif
+#endif
 
 #if defined(BUMPED) && (DIRECTIONAL_LIGHT_COUNT > 0)
 uniform vec3 u_directionalLightDirection[DIRECTIONAL_LIGHT_COUNT];
@@ -80,10 +94,21 @@ uniform vec2 u_textureOffset;
 #endif
 
 #if defined(CLIP_PLANE)
+#if !defined(INSTANCING)
 uniform mat4 u_worldMatrix;
+#endif
 uniform vec4 u_clipPlane;
 #endif
 
+#if defined(INSTANCING)
+// The per-node matrices are derived from the per-instance world matrix.
+// Normals are transformed by the world view matrix, which assumes uniform scaling.
+#define u_worldMatrix a_instanceMatrix
+#define u_worldViewMatrix (u_viewMatrix * a_instanceMatrix)
+#define u_worldViewProjectionMatrix (u_viewProjectionMatrix * a_instanceMatrix)
+#define u_inverseTransposeWorldViewMatrix (u_viewMatrix * a_instanceMatrix)
+#endif
+
 ///////////////////////////////////////////////////////////
 // Varyings
 varying vec2 v_texCoord;
@@ -22,6 +22,7 @@
 #include <set>
 #include <stack>
 #include <map>
+#include <unordered_map>
 #include <queue>
 #include <algorithm>
 #include <limits>
@@ -30,6 +31,8 @@
 #include <typeinfo>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <chrono>
 #include "Logger.h"
 
@@ -232,10 +235,16 @@ extern int strcmpnocase(const char* s1, const char* s2);
         #define GLEW_STATIC
         #include <GL/glew.h>
         #define GP_USE_VAO
+        #define GP_USE_UNIFORM_BUFFER
+        #define GP_USE_INSTANCING
+        #define GP_USE_PROGRAM_BINARY
 #elif __linux__
         #define GLEW_STATIC
         #include <GL/glew.h>
         #define GP_USE_VAO
+        #define GP_USE_UNIFORM_BUFFER
+        #define GP_USE_INSTANCING
+        #define GP_USE_PROGRAM_BINARY
 #elif __APPLE__
     #include "TargetConditionals.h"
     #if TARGET_OS_IPHONE || TARGET_IPHONE_SIMULATOR
@@ -274,6 +283,10 @@ extern int strcmpnocase(const char* s1, const char* s2);
 #define VERTEX_ATTRIBUTE_BLENDWEIGHTS_NAME          "a_blendWeights"
 #define VERTEX_ATTRIBUTE_BLENDINDICES_NAME          "a_blendIndices"
 #define VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME       "a_texCoord"
+#define VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME       "a_instanceMatrix"
+#define VERTEX_ATTRIBUTE_INSTANCE_PARAMETER_NAME    "a_instanceParameter"
+#define UNIFORM_BLOCK_MATERIAL_NAME                 "u_material"
+#define UNIFORM_BLOCK_MATERIAL_BINDING              0
 
 // Hardware buffer
 namespace gameplay
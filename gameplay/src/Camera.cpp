@@ -12,7 +12,8 @@
 #define CAMERA_DIRTY_INV_VIEW 8
 #define CAMERA_DIRTY_INV_VIEW_PROJ 16
 #define CAMERA_DIRTY_BOUNDS 32
-#define CAMERA_DIRTY_ALL (CAMERA_DIRTY_VIEW | CAMERA_DIRTY_PROJ | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_INV_VIEW | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_BOUNDS)
+#define CAMERA_DIRTY_TRANSLATION 128
+#define CAMERA_DIRTY_ALL (CAMERA_DIRTY_VIEW | CAMERA_DIRTY_PROJ | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_INV_VIEW | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_BOUNDS | CAMERA_DIRTY_TRANSLATION)
 #define CAMERA_CUSTOM_PROJECTION 64
 #define CAMERA_FIELD_OF_VIEW 60.0f
 #define CAMERA_ZOOM_X WINDOW_WIDTH
@@ -241,7 +242,7 @@ void Camera::setNode(Node* node)
             _node->addListener(this);
         }
 
-        _bits |= CAMERA_DIRTY_VIEW | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_INV_VIEW | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_BOUNDS;
+        _bits |= CAMERA_DIRTY_VIEW | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_INV_VIEW | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_BOUNDS | CAMERA_DIRTY_TRANSLATION;
         cameraChanged();
     }
 }
@@ -342,6 +343,33 @@ const Matrix& Camera::getInverseViewProjectionMatrix() const
     return _inverseViewProjection;
 }
 
+const Vector3& Camera::getTranslationWorld() const
+{
+    if (_bits & CAMERA_DIRTY_TRANSLATION)
+    {
+        if (_node)
+        {
+            _node->getWorldMatrix().getTranslation(&_translationWorld);
+        }
+        else
+        {
+            _translationWorld.set(0.0f, 0.0f, 0.0f);
+        }
+        getViewMatrix().transformPoint(_translationWorld, &_translationView);
+
+        _bits &= ~CAMERA_DIRTY_TRANSLATION;
+    }
+
+    return _translationWorld;
+}
+
+const Vector3& Camera::getTranslationView() const
+{
+    getTranslationWorld();
+
+    return _translationView;
+}
+
 const Frustum& Camera::getFrustum() const
 {
     if (_bits & CAMERA_DIRTY_BOUNDS)
@@ -463,7 +491,7 @@ Camera* Camera::clone(NodeCloneContext& context)
 
 void Camera::transformChanged(Transform* transform, long cookie)
 {
-    _bits |= CAMERA_DIRTY_VIEW | CAMERA_DIRTY_INV_VIEW | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_BOUNDS;
+    _bits |= CAMERA_DIRTY_VIEW | CAMERA_DIRTY_INV_VIEW | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_BOUNDS | CAMERA_DIRTY_TRANSLATION;
 
     cameraChanged();
 }
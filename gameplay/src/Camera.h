@@ -22,6 +22,7 @@ class Camera : public Ref, public Serializable, public Transform::Listener
 {
     friend class Serializer::Activator;
     friend class Node;
+    friend class RenderState;
 
 public:
 
@@ -398,6 +399,19 @@ private:
 
     void cameraChanged();
 
+    /**
+     * Gets the world-space position of the camera's node.
+     *
+     * The position is cached until the node is transformed, so that it is computed
+     * once per camera change rather than once for each drawable that binds it.
+     */
+    const Vector3& getTranslationWorld() const;
+
+    /**
+     * Gets the position of the camera's node in the camera's own view space.
+     */
+    const Vector3& getTranslationView() const;
+
     Camera::Type _type;
     float _fieldOfView;
     Vector2 _zoom;
@@ -410,6 +424,8 @@ private:
     mutable Matrix _inverseView;
     mutable Matrix _inverseViewProjection;
     mutable Frustum _bounds;
+    mutable Vector3 _translationWorld;
+    mutable Vector3 _translationView;
     mutable int _bits;
     Node* _node;
     std::list<Camera::Listener*>* _listeners;
@@ -629,7 +629,8 @@ bool Container::updateChildBounds()
         Control* ctrl = _controls[i];
         GP_ASSERT(ctrl);
 
-        if (ctrl->isVisible())
+        // Skip children whose subtree has nothing to update.
+        if (ctrl->isVisible() && (ctrl->_dirtyBits & (DIRTY_BOUNDS | DIRTY_STATE | DIRTY_CHILDREN)))
         {
             bool changed = ctrl->updateBoundsInternal(_scrollPosition);
 
@@ -1062,6 +1063,35 @@ Layout* Container::createLayout(Layout::Type type)
     }
 }
 
+void Container::getContentSize(float* width, float* height) const
+{
+    GP_ASSERT(width && height);
+
+    *width = *height = 0.0f;
+    for (size_t i = 0, count = _controls.size(); i < count; ++i)
+    {
+        Control* control = _controls[i];
+
+        if (!control->isVisible())
+            continue;
+
+        const Rectangle& bounds = control->getBounds();
+        const Theme::Margin& margin = control->getMargin();
+
+        float newWidth = bounds.x + bounds.width + margin.right;
+        if (newWidth > *width)
+        {
+            *width = newWidth;
+        }
+
+        float newHeight = bounds.y + bounds.height + margin.bottom;
+        if (newHeight > *height)
+        {
+            *height = newHeight;
+        }
+    }
+}
+
 void Container::updateScroll()
 {
     if (_scroll == SCROLL_NONE)
@@ -1082,30 +1112,7 @@ void Container::updateScroll()
     const Theme::Padding& containerPadding = getPadding();
 
     // Calculate total width and height.
-    _totalWidth = _totalHeight = 0.0f;
-    std::vector<Control*> controls = getControls();
-    for (size_t i = 0, count = controls.size(); i < count; ++i)
-    {
-        Control* control = _controls[i];
-
-        if (!control->isVisible())
-            continue;
-
-        const Rectangle& bounds = control->getBounds();
-        const Theme::Margin& margin = control->getMargin();
-
-        float newWidth = bounds.x + bounds.width + margin.right;
-        if (newWidth > _totalWidth)
-        {
-            _totalWidth = newWidth;
-        }
-
-        float newHeight = bounds.y + bounds.height + margin.bottom;
-        if (newHeight > _totalHeight)
-        {
-            _totalHeight = newHeight;
-        }
-    }
+    getContentSize(&_totalWidth, &_totalHeight);
 
     float vWidth = getImageRegion("verticalScrollBar", state).width;
     float hHeight = getImageRegion("horizontalScrollBar", state).height;
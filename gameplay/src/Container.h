@@ -397,6 +397,16 @@ protected:
      */
     void updateScroll();
 
+    /**
+     * Computes the size of the content of this container, which bounds its scroll position.
+     *
+     * By default this is the extent of the visible child controls, including their margins.
+     *
+     * @param width Populated with the width of the content.
+     * @param height Populated with the height of the content.
+     */
+    virtual void getContentSize(float* width, float* height) const;
+
     /**
      * Sorts controls by Z-Order (for absolute layouts only).
      * This method is used by controls to notify their parent container when
@@ -8,7 +8,7 @@ namespace gameplay
 {
 
 Control::Control()
-    : _id(""), _boundsBits(0), _dirtyBits(DIRTY_BOUNDS | DIRTY_STATE), _consumeInputEvents(true), _alignment(ALIGN_TOP_LEFT),
+    : _id(""), _boundsBits(0), _dirtyBits(DIRTY_BOUNDS | DIRTY_STATE | DIRTY_GEOMETRY), _consumeInputEvents(true), _alignment(ALIGN_TOP_LEFT),
     _autoSize(AUTO_SIZE_BOTH), _listeners(NULL), _style(NULL), _visible(true), _opacity(0.0f), _zIndex(-1),
     _contactIndex(INVALID_CONTACT_INDEX), _focusIndex(-1), _canFocus(false), _state(NORMAL), _parent(NULL), _styleOverridden(false), _skin(NULL)
 {
@@ -503,6 +503,9 @@ bool Control::canFocus() const
 void Control::setCanFocus(bool acceptsFocus)
 {
     _canFocus = acceptsFocus;
+
+    // Controls that can be focused are searched differently for input.
+    setDirty(DIRTY_STATE);
 }
 
 bool Control::hasFocus() const
@@ -601,6 +604,8 @@ void Control::setSkinRegion(const Rectangle& region, unsigned char states)
         if( overlays[i] )
             overlays[i]->setSkinRegion(region, _style->_tw, _style->_th);
     }
+
+    setDirty(DIRTY_GEOMETRY);
 }
 
 const Rectangle& Control::getSkinRegion(State state) const
@@ -621,6 +626,8 @@ void Control::setSkinColor(const Vector4& color, unsigned char states)
         if( overlays[i] )
             overlays[i]->setSkinColor(color);
     }
+
+    setDirty(DIRTY_GEOMETRY);
 }
 
 const Vector4& Control::getSkinColor(State state) const
@@ -669,6 +676,8 @@ void Control::setImageRegion(const char* id, const Rectangle& region, unsigned c
         if( overlays[i] )
             overlays[i]->setImageRegion(id, region, _style->_tw, _style->_th);
     }
+
+    setDirty(DIRTY_GEOMETRY);
 }
 
 const Rectangle& Control::getImageRegion(const char* id, State state) const
@@ -689,6 +698,8 @@ void Control::setImageColor(const char* id, const Vector4& color, unsigned char
         if( overlays[i] )
             overlays[i]->setImageColor(id, color);
     }
+
+    setDirty(DIRTY_GEOMETRY);
 }
 
 const Vector4& Control::getImageColor(const char* id, State state) const
@@ -716,6 +727,8 @@ void Control::setCursorRegion(const Rectangle& region, unsigned char states)
         if( overlays[i] )
             overlays[i]->setCursorRegion(region, _style->_tw, _style->_th);
     }
+
+    setDirty(DIRTY_GEOMETRY);
 }
 
 const Rectangle& Control::getCursorRegion(State state) const
@@ -736,6 +749,8 @@ void Control::setCursorColor(const Vector4& color, unsigned char states)
         if( overlays[i] )
             overlays[i]->setCursorColor(color);
     }
+
+    setDirty(DIRTY_GEOMETRY);
 }
 
 const Vector4& Control::getCursorColor(State state)
@@ -910,6 +925,9 @@ Theme::Style::OverlayType Control::getOverlayType() const
 void Control::setConsumeInputEvents(bool consume)
 {
     _consumeInputEvents = consume;
+
+    // Let forms know which controls now accept input.
+    setDirty(DIRTY_STATE);
 }
 
 bool Control::getConsumeInputEvents()
@@ -1089,7 +1107,14 @@ void Control::controlEvent(Control::Listener::EventType evt)
 
 void Control::setDirty(int bits)
 {
-    _dirtyBits |= bits;
+    _dirtyBits |= bits | DIRTY_GEOMETRY;
+
+    // Mark the path to this control so that the next bounds update reaches it.
+    if (bits & (DIRTY_BOUNDS | DIRTY_STATE | DIRTY_CHILDREN))
+    {
+        for (Control* parent = _parent; parent && (parent->_dirtyBits & DIRTY_CHILDREN) == 0; parent = parent->_parent)
+            parent->_dirtyBits |= DIRTY_CHILDREN;
+    }
 }
 
 bool Control::isDirty(int bit) const
@@ -1132,10 +1157,13 @@ bool Control::updateBoundsInternal(const Vector2& offset)
         _dirtyBits &= ~DIRTY_STATE;
     }
 
-    // If we are a container, always update child bounds first
+    // If we are a container, update the bounds of dirty children first
     bool changed = false;
-    if (isContainer())
+    if (isContainer() && (_dirtyBits & (DIRTY_BOUNDS | DIRTY_CHILDREN)))
+    {
+        _dirtyBits &= ~DIRTY_CHILDREN;
         changed = static_cast<Container*>(this)->updateChildBounds();
+    }
 
     // Clear our dirty bounds bit
     bool dirtyBounds = (_dirtyBits & DIRTY_BOUNDS) != 0;
@@ -1298,12 +1326,48 @@ unsigned int Control::draw(Form* form, const Rectangle& clip)
     if (!_visible)
         return 0;
 
-    unsigned int drawCalls = drawBorder(form, clip);
-    drawCalls += drawImages(form, clip);
+    // Draw the retained skin and image sprites again if nothing they depend on has changed.
+    unsigned int drawCalls;
+    if (isGeometryValid(clip))
+    {
+        form->drawGeometry(_geometry.ranges);
+        drawCalls = _geometry.drawCalls;
+        ++form->_reusedControlCount;
+    }
+    else
+    {
+        form->startGeometry(&_geometry.ranges);
+        drawCalls = drawBorder(form, clip);
+        drawCalls += drawImages(form, clip);
+        form->finishGeometry();
+
+        _geometry.bounds = _absoluteBounds;
+        _geometry.viewportClip = _viewportClipBounds;
+        _geometry.clip = clip;
+        _geometry.skin = _skin;
+        _geometry.state = getState();
+        _geometry.opacity = _opacity;
+        _geometry.drawCalls = drawCalls;
+        _dirtyBits &= ~DIRTY_GEOMETRY;
+        ++form->_regeneratedControlCount;
+    }
+
+    // Text is not retained here, since fonts cache their own text layouts.
     drawCalls += drawText(form, clip);
     return drawCalls;
 }
 
+bool Control::isGeometryValid(const Rectangle& clip) const
+{
+    return (_dirtyBits & DIRTY_GEOMETRY) == 0 &&
+        _geometry.bounds == _absoluteBounds &&
+        _geometry.viewportClip == _viewportClipBounds &&
+        _geometry.clip == clip &&
+        _geometry.skin == _skin &&
+        _geometry.state == getState() &&
+        _geometry.opacity == _opacity;
+}
+
 unsigned int Control::drawBorder(Form* form, const Rectangle& clip)
 {
     if (!form || !_skin || _absoluteBounds.width <= 0 || _absoluteBounds.height <= 0)
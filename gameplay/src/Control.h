@@ -997,6 +997,22 @@ protected:
      */
     static const int DIRTY_STATE = 2;
 
+    /**
+     * Indicates that the geometry retained for drawing the control's skin and images is dirty.
+     *
+     * This bit is set along with any other dirty bit. Controls should set it whenever something
+     * other than their bounds, state, skin or opacity changes the way their images are drawn.
+     */
+    static const int DIRTY_GEOMETRY = 4;
+
+    /**
+     * Indicates that the bounds or state of a descendant of the control are dirty.
+     *
+     * This bit is set on all ancestors of a control whose bounds or state are made dirty, so
+     * that bounds updates only visit the paths that lead to dirty controls.
+     */
+    static const int DIRTY_CHILDREN = 8;
+
     /**
      * Indicates that the x position of the control is a percentage.
      */
@@ -1477,11 +1493,38 @@ protected:
 
 private:
 
+    /**
+     * Sprites drawn into one sprite batch, retained so that they can be drawn again unchanged.
+     */
+    struct GeometryRange
+    {
+        SpriteBatch* batch;
+        std::vector<SpriteBatch::SpriteVertex> vertices;
+        std::vector<unsigned short> indices;
+    };
+
+    /**
+     * The skin and image sprites drawn for a control, along with what they were generated from.
+     */
+    struct Geometry
+    {
+        std::vector<GeometryRange> ranges;
+        Rectangle bounds;
+        Rectangle viewportClip;
+        Rectangle clip;
+        Theme::Skin* skin;
+        State state;
+        float opacity;
+        unsigned int drawCalls;
+    };
+
     /*
      * Constructor.
      */    
     Control(const Control& copy);
 
+    bool isGeometryValid(const Rectangle& clip) const;
+
     bool updateBoundsInternal(const Vector2& offset);
 
     AutoSize parseAutoSize(const char* str);
@@ -1506,6 +1549,7 @@ private:
 
     bool _styleOverridden;
     Theme::Skin* _skin;
+    Geometry _geometry;
 
 };
 
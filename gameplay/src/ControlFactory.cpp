@@ -9,6 +9,7 @@
 #include "TextBox.h"
 #include "JoystickControl.h"
 #include "ImageControl.h"
+#include "ListContainer.h"
 
 namespace gameplay
 {
@@ -89,6 +90,7 @@ void ControlFactory::registerStandardControls()
     registerCustomControl("JOYSTICKCONTROL", &JoystickControl::create);
     registerCustomControl("IMAGE", &ImageControl::create);  // convenience alias
     registerCustomControl("IMAGECONTROL", &ImageControl::create);*/
+    registerCustomControl("LISTCONTAINER", &ListContainer::create);
 }
 
 }
@@ -1,6 +1,7 @@
 #include "Base.h"
 #include "Drawable.h"
 #include "Node.h"
+#include "RenderCommandList.h"
 
 
 namespace gameplay
@@ -15,6 +16,19 @@ Drawable::~Drawable()
 {
 }
 
+static unsigned int drawCallback(void* cookie, bool wireframe)
+{
+    return static_cast<Drawable*>(cookie)->draw(wireframe);
+}
+
+unsigned int Drawable::record(RenderCommandList* list, bool wireframe)
+{
+    GP_ASSERT(list);
+
+    list->drawCallback(&drawCallback, this, wireframe);
+    return 1;
+}
+
 Node* Drawable::getNode() const
 {
     return _node;
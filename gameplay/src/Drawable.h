@@ -6,6 +6,7 @@ namespace gameplay
 
 class Node;
 class NodeCloneContext;
+class RenderCommandList;
 
 /**
  * Defines a drawable object that can be attached to a Node.
@@ -35,6 +36,23 @@ public:
 
     virtual unsigned int draw(bool wireframe = false) = 0;
 
+    /**
+     * Records the commands that draw the object into a command list.
+     *
+     * The default implementation records a single command that calls draw() when the
+     * list is executed. Drawables that override this method do not call the graphics
+     * API while recording, so RenderCommandList::recordParallel can record them on worker
+     * threads once it has resolved the node and camera matrices they read. Overrides must
+     * only modify state owned by the drawable, so that no other thread reads it.
+     *
+     * @param list The command list to record into.
+     * @param wireframe true if you want to request to draw the wireframe only.
+     * @return The number of graphics draw calls required to draw the object, as returned by draw().
+     *
+     * @see RenderCommandList
+     */
+    virtual unsigned int record(RenderCommandList* list, bool wireframe = false);
+
     /**
      * Gets the node this drawable is attached to.
      *
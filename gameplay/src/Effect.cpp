@@ -8,18 +8,69 @@
 namespace gameplay
 {
 
-// Cache of unique effects.
-static std::map<std::string, Effect*> __effectCache;
+// Version of the program cache file format.
+#define PROGRAM_CACHE_VERSION 1
+
+// Cache of unique effects, keyed by a hash of their id.
+static std::map<unsigned long long, Effect*> __effectCache;
 static Effect* __currentEffect = NULL;
 
-Effect::Effect() : _program(0), _vshPath(""), _fshPath(""), _defines("")
+// Cache of preprocessed shader files, shared by all variants.
+static std::map<std::string, std::string> __sourceCache;
+static std::mutex __sourceCacheMutex;
+
+// Shader variants being warmed up.
+struct WarmUpVariant
+{
+    std::string vshPath;
+    std::string fshPath;
+    std::string defines;
+    std::string vshSource;
+    std::string fshSource;
+    std::string id;
+    unsigned long long key;
+    bool valid;
+};
+static std::vector<WarmUpVariant> __warmUpVariants;
+static std::vector<WarmUpVariant*> __warmUpReady;
+static std::vector<Effect*> __warmUpEffects;
+static std::thread __warmUpThread;
+static std::mutex __warmUpMutex;
+static unsigned int __warmUpCompiled = 0;
+static bool __warmUpCancelled = false;
+
+// Program binary cache.
+static std::string __programCachePath;
+static std::string __programCacheDriver;
+static unsigned int __programCacheHits = 0;
+static unsigned int __programCacheMisses = 0;
+
+static unsigned long long hashString(const char* str, unsigned long long hash = 14695981039346656037ULL)
+{
+    // 64-bit FNV-1a, including the terminating null so that concatenated strings hash uniquely.
+    const unsigned char* c = (const unsigned char*)str;
+    do
+    {
+        hash ^= *c;
+        hash *= 1099511628211ULL;
+    } while (*c++);
+    return hash;
+}
+
+Effect::Effect() : _program(0), _key(0), _vshPath(""), _fshPath(""), _defines(""),
+    _blockIndex(0), _blockSize(0), _blockMemberCount(0), _blockData(NULL)
 {
 }
 
 Effect::~Effect()
 {
     // Remove this effect from the cache.
-    __effectCache.erase(_id);
+    if (_key)
+    {
+        std::map<unsigned long long, Effect*>::iterator itr = __effectCache.find(_key);
+        if (itr != __effectCache.end() && itr->second == this)
+            __effectCache.erase(itr);
+    }
 
     // Free uniforms.
     for (std::map<std::string, Uniform*>::iterator itr = _uniforms.begin(); itr != _uniforms.end(); ++itr)
@@ -41,22 +92,66 @@ Effect::~Effect()
     }
 }
 
+static std::string canonicalizeDefines(const char* defines)
+{
+    // Split on semicolons and new-lines, trim, then sort and remove duplicates so that
+    // the same set of defines always yields the same variant.
+    std::vector<std::string> list;
+    if (defines)
+    {
+        const char* c = defines;
+        while (*c)
+        {
+            const char* begin = c;
+            while (*c && *c != ';' && *c != '\n')
+                ++c;
+            const char* end = c;
+            while (begin < end && isspace((unsigned char)*begin))
+                ++begin;
+            while (end > begin && isspace((unsigned char)end[-1]))
+                --end;
+            if (end > begin)
+                list.push_back(std::string(begin, end));
+            if (*c)
+                ++c;
+        }
+    }
+    std::sort(list.begin(), list.end());
+    list.erase(std::unique(list.begin(), list.end()), list.end());
+
+    std::string out;
+    for (size_t i = 0, count = list.size(); i < count; ++i)
+    {
+        if (i > 0)
+            out += ';';
+        out += list[i];
+    }
+    return out;
+}
+
+static std::string getVariantId(const char* vshPath, const char* fshPath, const std::string& defines)
+{
+    std::string id = vshPath;
+    id += ';';
+    id += fshPath;
+    id += ';';
+    id += defines;
+    return id;
+}
+
+static bool preprocessFile(const char* path, std::string& out);
+
 Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const char* defines)
 {
     GP_ASSERT(vshPath);
     GP_ASSERT(fshPath);
 
     // Search the effect cache for an identical effect that is already loaded.
-    std::string uniqueId = vshPath;
-    uniqueId += ';';
-    uniqueId += fshPath;
-    uniqueId += ';';
-    if (defines)
-    {
-        uniqueId += defines;
-    }
-    std::map<std::string, Effect*>::const_iterator itr = __effectCache.find(uniqueId);
-    if (itr != __effectCache.end())
+    std::string definesStr = canonicalizeDefines(defines);
+    std::string uniqueId = getVariantId(vshPath, fshPath, definesStr);
+    unsigned long long key = hashString(uniqueId.c_str());
+    std::map<unsigned long long, Effect*>::const_iterator itr = __effectCache.find(key);
+    if (itr != __effectCache.end() && itr->second->_id == uniqueId)
     {
         // Found an exiting effect with this id, so increase its ref count and return it.
         GP_ASSERT(itr->second);
@@ -64,42 +159,44 @@ Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const c
         return itr->second;
     }
 
-    // Read source from file.
-    char* vshSource = FileSystem::readAll(vshPath);
-    if (vshSource == NULL)
+    // Read and preprocess the source from file.
+    std::string vshSource;
+    if (!preprocessFile(vshPath, vshSource))
     {
         GP_ERROR("Failed to read vertex shader from file '%s'.", vshPath);
         return NULL;
     }
-    char* fshSource = FileSystem::readAll(fshPath);
-    if (fshSource == NULL)
+    std::string fshSource;
+    if (!preprocessFile(fshPath, fshSource))
     {
         GP_ERROR("Failed to read fragment shader from file '%s'.", fshPath);
-        SAFE_DELETE_ARRAY(vshSource);
         return NULL;
     }
 
-    Effect* effect = createFromSource(vshPath, vshSource, fshPath, fshSource, defines);
-    
-    SAFE_DELETE_ARRAY(vshSource);
-    SAFE_DELETE_ARRAY(fshSource);
+    return createVariant(key, uniqueId, vshPath, vshSource, fshPath, fshSource, definesStr);
+}
 
+Effect* Effect::createVariant(unsigned long long key, const std::string& id, const char* vshPath, const std::string& vshSource,
+                              const char* fshPath, const std::string& fshSource, const std::string& defines)
+{
+    Effect* effect = createFromSource(vshPath, vshSource.c_str(), fshPath, fshSource.c_str(), defines.c_str());
     if (effect == NULL)
     {
         GP_ERROR("Failed to create effect from shaders '%s', '%s'.", vshPath, fshPath);
+        return NULL;
     }
-    else
+
+    // Store this effect in the cache, unless another variant has the same hash.
+    effect->_id = id;
+    if (__effectCache.find(key) == __effectCache.end())
     {
-        // Store this effect in the cache.
-        effect->_id = uniqueId;
-        __effectCache[uniqueId] = effect;
+        effect->_key = key;
+        __effectCache[key] = effect;
     }
-
     effect->_vshPath = vshPath;
     effect->_fshPath = fshPath;
-    if (defines)
-        effect->_defines = defines;
-    
+    effect->_defines = defines;
+
     return effect;
 }
 
@@ -108,7 +205,7 @@ Effect* Effect::createFromSource(const char* vshSource, const char* fshSource, c
     return createFromSource(NULL, vshSource, NULL, fshSource, defines);
 }
 
-static void replaceDefines(const char* defines, std::string& out)
+static void replaceDefines(const std::string& defines, std::string& out)
 {
     /*Properties* graphicsConfig = Game::getInstance()->getConfig()->getNamespace("graphics", true);
     const char* globalDefines = graphicsConfig ? graphicsConfig->getString("shaderDefines") : NULL;*/
@@ -126,7 +223,7 @@ static void replaceDefines(const char* defines, std::string& out)
             out += ';';
         out += globalDefines;
     }
-    if (defines && strlen(defines) > 0)
+    if (defines.length() > 0)
     {
         if (out.length() > 0)
             out += ';';
@@ -146,7 +243,7 @@ static void replaceDefines(const char* defines, std::string& out)
     }
 }
 
-static void replaceIncludes(const char* filepath, const char* source, std::string& out)
+static bool replaceIncludes(const char* filepath, const char* source, std::string& out)
 {
     // Replace the #include "xxxx.xxx" with the sourced file contents of "filepath/xxxx.xxx"
     std::string str = source;
@@ -180,7 +277,7 @@ static void replaceIncludes(const char* filepath, const char* source, std::strin
             {
                 // We have started an "#include" but missing the leading quote "
                 GP_ERROR("Compile failed for shader '%s' missing leading \".", filepath);
-                return;
+                return false;
             }
             // find the end quote "
             size_t endQuote = str.find("\"", startQuote);
@@ -188,7 +285,7 @@ static void replaceIncludes(const char* filepath, const char* source, std::strin
             {
                 // We have a start quote but missing the trailing quote "
                 GP_ERROR("Compile failed for shader '%s' missing trailing \".", filepath);
-                return;
+                return false;
             }
 
             // jump the head position past the end quote
@@ -200,17 +297,10 @@ static void replaceIncludes(const char* filepath, const char* source, std::strin
             size_t len = endQuote - (startQuote);
             std::string includeStr = str.substr(startQuote, len);
             directoryPath.append(includeStr);
-            const char* includedSource = FileSystem::readAll(directoryPath.c_str());
-            if (includedSource == NULL)
+            if (!preprocessFile(directoryPath.c_str(), out))
             {
                 GP_ERROR("Compile failed for shader '%s' invalid filepath.", filepathStr.c_str());
-                return;
-            }
-            else
-            {
-                // Valid file so lets attempt to see if we need to append anything to it too (recurse...)
-                replaceIncludes(directoryPath.c_str(), includedSource, out);
-                SAFE_DELETE_ARRAY(includedSource);
+                return false;
             }
         }
         else
@@ -219,6 +309,37 @@ static void replaceIncludes(const char* filepath, const char* source, std::strin
             out.append(str.c_str(), lastPos, tailPos);
         }
     }
+    return true;
+}
+
+static bool preprocessFile(const char* path, std::string& out)
+{
+    // Files are included by many variants (and often by many shaders), so they are
+    // only read and expanded once.
+    {
+        std::lock_guard<std::mutex> lock(__sourceCacheMutex);
+        std::map<std::string, std::string>::const_iterator itr = __sourceCache.find(path);
+        if (itr != __sourceCache.end())
+        {
+            out += itr->second;
+            return true;
+        }
+    }
+
+    char* source = FileSystem::readAll(path);
+    if (source == NULL)
+        return false;
+    std::string expanded;
+    bool success = replaceIncludes(path, source, expanded);
+    if (success && source[0] != '\0')
+        expanded += "\n";
+    SAFE_DELETE_ARRAY(source);
+    if (!success)
+        return false;
+
+    std::lock_guard<std::mutex> lock(__sourceCacheMutex);
+    out += __sourceCache.insert(std::make_pair(std::string(path), expanded)).first->second;
+    return true;
 }
 
 static void writeShaderToErrorFile(const char* filePath, const char* source)
@@ -246,21 +367,25 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
     GLint length;
     GLint success;
 
-    // Replace all comma separated definitions with #define prefix and \n suffix
+    // Replace all semicolon separated definitions with #define prefix and \n suffix
     std::string definesStr = "";
-    replaceDefines(defines, definesStr);
-    
-    shaderSource[0] = definesStr.c_str();
-    shaderSource[1] = "\n";
-    std::string vshSourceStr = "";
-    if (vshPath)
+    replaceDefines(canonicalizeDefines(defines), definesStr);
+
+    // Look for the program linked from the same sources on a previous run.
+    unsigned long long cacheKey = 0;
+#ifdef GP_USE_PROGRAM_BINARY
+    if (!__programCachePath.empty() && glProgramBinary && glGetProgramBinary && glProgramParameteri)
     {
-        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
-        replaceIncludes(vshPath, vshSource, vshSourceStr);
-        if (vshSource && strlen(vshSource) != 0)
-            vshSourceStr += "\n";
+        cacheKey = computeProgramCacheKey(definesStr.c_str(), vshSource, fshSource);
+        Effect* effect = loadProgramBinary(cacheKey);
+        if (effect)
+            return effect;
     }
-    shaderSource[2] = vshPath ? vshSourceStr.c_str() :  vshSource;
+#endif
+
+    shaderSource[0] = definesStr.c_str();
+    shaderSource[1] = "\n";
+    shaderSource[2] = vshSource;
     GL_ASSERT( vertexShader = glCreateShader(GL_VERTEX_SHADER) );
     GL_ASSERT( glShaderSource(vertexShader, SHADER_SOURCE_LENGTH, shaderSource, NULL) );
     GL_ASSERT( glCompileShader(vertexShader) );
@@ -293,15 +418,7 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
     }
 
     // Compile the fragment shader.
-    std::string fshSourceStr;
-    if (fshPath)
-    {
-        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
-        replaceIncludes(fshPath, fshSource, fshSourceStr);
-        if (fshSource && strlen(fshSource) != 0)
-            fshSourceStr += "\n";
-    }
-    shaderSource[2] = fshPath ? fshSourceStr.c_str() : fshSource;
+    shaderSource[2] = fshSource;
     GL_ASSERT( fragmentShader = glCreateShader(GL_FRAGMENT_SHADER) );
     GL_ASSERT( glShaderSource(fragmentShader, SHADER_SOURCE_LENGTH, shaderSource, NULL) );
     GL_ASSERT( glCompileShader(fragmentShader) );
@@ -338,6 +455,12 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
     GL_ASSERT( program = glCreateProgram() );
     GL_ASSERT( glAttachShader(program, vertexShader) );
     GL_ASSERT( glAttachShader(program, fragmentShader) );
+#ifdef GP_USE_PROGRAM_BINARY
+    if (cacheKey)
+    {
+        GL_ASSERT( glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE) );
+    }
+#endif
     GL_ASSERT( glLinkProgram(program) );
     GL_ASSERT( glGetProgramiv(program, GL_LINK_STATUS, &success) );
 
@@ -461,9 +584,300 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
         }
     }
 
+    effect->queryUniformBlock();
+
+    if (cacheKey)
+        effect->saveProgramBinary(cacheKey);
+
     return effect;
 }
 
+void Effect::queryUniformBlock()
+{
+#ifdef GP_USE_UNIFORM_BUFFER
+    // Query the optional material uniform block. The members of this block are packed
+    // into a single buffer per material and uploaded at once rather than per uniform.
+    if (glGetUniformBlockIndex)
+    {
+        GLint activeUniforms;
+        GL_ASSERT( glGetProgramiv(_program, GL_ACTIVE_UNIFORMS, &activeUniforms) );
+
+        GLuint blockIndex;
+        GL_ASSERT( blockIndex = glGetUniformBlockIndex(_program, UNIFORM_BLOCK_MATERIAL_NAME) );
+        if (blockIndex != GL_INVALID_INDEX)
+        {
+            _blockIndex = blockIndex;
+            GL_ASSERT( glGetActiveUniformBlockiv(_program, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &_blockSize) );
+            GL_ASSERT( glUniformBlockBinding(_program, blockIndex, UNIFORM_BLOCK_MATERIAL_BINDING) );
+
+            for (int i = 0; i < activeUniforms; ++i)
+            {
+                GLuint uniformIndex = (GLuint)i;
+                GLint uniformBlockIndex;
+                GL_ASSERT( glGetActiveUniformsiv(_program, 1, &uniformIndex, GL_UNIFORM_BLOCK_INDEX, &uniformBlockIndex) );
+                if (uniformBlockIndex != (GLint)blockIndex)
+                    continue;
+
+                GLchar uniformName[256];
+                GL_ASSERT( glGetActiveUniformName(_program, uniformIndex, sizeof(uniformName), NULL, uniformName) );
+                char* c = strrchr(uniformName, '[');
+                if (c)
+                {
+                    *c = '\0';
+                }
+
+                std::map<std::string, Uniform*>::const_iterator itr = _uniforms.find(uniformName);
+                if (itr == _uniforms.end())
+                    continue;
+                Uniform* uniform = itr->second;
+                GL_ASSERT( glGetActiveUniformsiv(_program, 1, &uniformIndex, GL_UNIFORM_OFFSET, &uniform->_blockOffset) );
+                GL_ASSERT( glGetActiveUniformsiv(_program, 1, &uniformIndex, GL_UNIFORM_ARRAY_STRIDE, &uniform->_arrayStride) );
+                GL_ASSERT( glGetActiveUniformsiv(_program, 1, &uniformIndex, GL_UNIFORM_MATRIX_STRIDE, &uniform->_matrixStride) );
+                uniform->_blockMember = _blockMemberCount++;
+            }
+        }
+    }
+#endif
+}
+
+static std::string getProgramCacheFile(unsigned long long key)
+{
+    char name[32];
+    sprintf(name, "%016llx.bin", key);
+    std::string path = __programCachePath;
+    if (path[path.length() - 1] != '/')
+        path += '/';
+    path += name;
+    return path;
+}
+
+static void appendUInt(std::vector<unsigned char>& data, unsigned int value)
+{
+    const unsigned char* bytes = (const unsigned char*)&value;
+    data.insert(data.end(), bytes, bytes + sizeof(unsigned int));
+}
+
+static void appendString(std::vector<unsigned char>& data, const std::string& value)
+{
+    appendUInt(data, (unsigned int)value.length());
+    data.insert(data.end(), value.begin(), value.end());
+}
+
+struct CachedUniform
+{
+    std::string name;
+    unsigned int location;
+    unsigned int type;
+    unsigned int index;
+};
+
+static bool readUInt(const char*& ptr, const char* end, unsigned int* value)
+{
+    if (end - ptr < (ptrdiff_t)sizeof(unsigned int))
+        return false;
+    memcpy(value, ptr, sizeof(unsigned int));
+    ptr += sizeof(unsigned int);
+    return true;
+}
+
+static bool readString(const char*& ptr, const char* end, std::string* value)
+{
+    unsigned int length;
+    if (!readUInt(ptr, end, &length) || (unsigned int)(end - ptr) < length)
+        return false;
+    value->assign(ptr, length);
+    ptr += length;
+    return true;
+}
+
+unsigned long long Effect::computeProgramCacheKey(const char* defines, const char* vshSource, const char* fshSource)
+{
+    GP_ASSERT(defines);
+    GP_ASSERT(vshSource);
+    GP_ASSERT(fshSource);
+
+    // Binaries are only valid for the driver that produced them.
+    if (__programCacheDriver.empty())
+    {
+        const GLubyte* vendor = glGetString(GL_VENDOR);
+        const GLubyte* renderer = glGetString(GL_RENDERER);
+        const GLubyte* version = glGetString(GL_VERSION);
+        __programCacheDriver = vendor ? (const char*)vendor : "";
+        __programCacheDriver += ';';
+        __programCacheDriver += renderer ? (const char*)renderer : "";
+        __programCacheDriver += ';';
+        __programCacheDriver += version ? (const char*)version : "";
+    }
+
+    unsigned long long key = hashString(__programCacheDriver.c_str());
+    key = hashString(defines, key);
+    key = hashString(vshSource, key);
+    key = hashString(fshSource, key);
+    return key ? key : 1;
+}
+
+Effect* Effect::loadProgramBinary(unsigned long long key)
+{
+#ifdef GP_USE_PROGRAM_BINARY
+    std::string path = getProgramCacheFile(key);
+    if (!FileSystem::fileExists(path.c_str()))
+    {
+        ++__programCacheMisses;
+        return NULL;
+    }
+
+    int size = 0;
+    char* data = FileSystem::readAll(path.c_str(), &size);
+    if (data == NULL)
+    {
+        ++__programCacheMisses;
+        return NULL;
+    }
+
+    // Validate the header and read the binary and the reflected attributes and uniforms.
+    const char* ptr = data;
+    const char* end = data + size;
+    unsigned int version = 0;
+    unsigned long long fileKey = 0;
+    std::string driver;
+    unsigned int binaryFormat = 0;
+    unsigned int binaryLength = 0;
+    const char* binary = NULL;
+    bool valid = size >= 4 && memcmp(ptr, "GPPB", 4) == 0;
+    if (valid)
+    {
+        ptr += 4;
+        valid = readUInt(ptr, end, &version) && version == PROGRAM_CACHE_VERSION &&
+            (unsigned int)(end - ptr) >= sizeof(fileKey);
+    }
+    if (valid)
+    {
+        memcpy(&fileKey, ptr, sizeof(fileKey));
+        ptr += sizeof(fileKey);
+        valid = fileKey == key && readString(ptr, end, &driver) && driver == __programCacheDriver &&
+            readUInt(ptr, end, &binaryFormat) && readUInt(ptr, end, &binaryLength) && (unsigned int)(end - ptr) >= binaryLength;
+    }
+    std::vector<std::pair<std::string, VertexAttribute> > attributes;
+    std::vector<CachedUniform> uniforms;
+    if (valid)
+    {
+        binary = ptr;
+        ptr += binaryLength;
+
+        unsigned int count = 0;
+        valid = readUInt(ptr, end, &count);
+        for (unsigned int i = 0; i < count && valid; ++i)
+        {
+            std::pair<std::string, VertexAttribute> attribute;
+            unsigned int location;
+            valid = readString(ptr, end, &attribute.first) && readUInt(ptr, end, &location);
+            attribute.second = (VertexAttribute)location;
+            attributes.push_back(attribute);
+        }
+        valid = valid && readUInt(ptr, end, &count);
+        uniforms.resize(valid ? count : 0);
+        for (unsigned int i = 0; i < count && valid; ++i)
+        {
+            CachedUniform& uniform = uniforms[i];
+            valid = readString(ptr, end, &uniform.name) && readUInt(ptr, end, &uniform.location) &&
+                readUInt(ptr, end, &uniform.type) && readUInt(ptr, end, &uniform.index);
+        }
+    }
+
+    // The driver may still reject a binary, for example after it was updated.
+    GLuint program = 0;
+    if (valid)
+    {
+        GLint success;
+        GL_ASSERT( program = glCreateProgram() );
+        GL_ASSERT( glProgramBinary(program, binaryFormat, binary, binaryLength) );
+        GL_ASSERT( glGetProgramiv(program, GL_LINK_STATUS, &success) );
+        if (success != GL_TRUE)
+        {
+            GL_ASSERT( glDeleteProgram(program) );
+            program = 0;
+        }
+    }
+    SAFE_DELETE_ARRAY(data);
+
+    if (program == 0)
+    {
+        GP_WARN("Discarding invalid program cache file '%s'.", path.c_str());
+        ++__programCacheMisses;
+        return NULL;
+    }
+
+    Effect* effect = new Effect();
+    effect->_program = program;
+    for (size_t i = 0, count = attributes.size(); i < count; ++i)
+    {
+        effect->_vertexAttributes[attributes[i].first] = attributes[i].second;
+    }
+    for (size_t i = 0, count = uniforms.size(); i < count; ++i)
+    {
+        Uniform* uniform = new Uniform();
+        uniform->_effect = effect;
+        uniform->_name = uniforms[i].name;
+        uniform->_location = (GLint)uniforms[i].location;
+        uniform->_type = (GLenum)uniforms[i].type;
+        uniform->_index = uniforms[i].index;
+        effect->_uniforms[uniform->_name] = uniform;
+    }
+    effect->queryUniformBlock();
+
+    ++__programCacheHits;
+    return effect;
+#else
+    return NULL;
+#endif
+}
+
+void Effect::saveProgramBinary(unsigned long long key) const
+{
+#ifdef GP_USE_PROGRAM_BINARY
+    GLint length = 0;
+    GL_ASSERT( glGetProgramiv(_program, GL_PROGRAM_BINARY_LENGTH, &length) );
+    if (length <= 0)
+        return;
+
+    std::vector<unsigned char> binary(length);
+    GLenum binaryFormat = 0;
+    GL_ASSERT( glGetProgramBinary(_program, length, &length, &binaryFormat, &binary[0]) );
+
+    std::vector<unsigned char> data;
+    data.insert(data.end(), "GPPB", "GPPB" + 4);
+    appendUInt(data, PROGRAM_CACHE_VERSION);
+    const unsigned char* keyBytes = (const unsigned char*)&key;
+    data.insert(data.end(), keyBytes, keyBytes + sizeof(key));
+    appendString(data, __programCacheDriver);
+    appendUInt(data, (unsigned int)binaryFormat);
+    appendUInt(data, (unsigned int)length);
+    data.insert(data.end(), binary.begin(), binary.begin() + length);
+    appendUInt(data, (unsigned int)_vertexAttributes.size());
+    for (std::map<std::string, VertexAttribute>::const_iterator itr = _vertexAttributes.begin(); itr != _vertexAttributes.end(); ++itr)
+    {
+        appendString(data, itr->first);
+        appendUInt(data, (unsigned int)itr->second);
+    }
+    appendUInt(data, (unsigned int)_uniforms.size());
+    for (std::map<std::string, Uniform*>::const_iterator itr = _uniforms.begin(); itr != _uniforms.end(); ++itr)
+    {
+        const Uniform* uniform = itr->second;
+        appendString(data, uniform->_name);
+        appendUInt(data, (unsigned int)uniform->_location);
+        appendUInt(data, (unsigned int)uniform->_type);
+        appendUInt(data, uniform->_index);
+    }
+
+    std::string path = getProgramCacheFile(key);
+    std::unique_ptr<Stream> stream(FileSystem::open(path.c_str(), FileSystem::WRITE));
+    if (stream.get() == NULL || !stream->canWrite() || stream->write(&data[0], 1, data.size()) != data.size())
+    {
+        GP_WARN("Failed to write program cache file '%s'.", path.c_str());
+    }
+#endif
+}
+
 const char* Effect::getId() const
 {
     return _id.c_str();
@@ -536,79 +950,127 @@ unsigned int Effect::getUniformCount() const
 void Effect::setValue(Uniform* uniform, float value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform1f(uniform->_location, value) );
+    if (uniform->_blockOffset >= 0)
+        setBlockValue(uniform, &value, 1, 1, 1);
+    else
+        GL_ASSERT( glUniform1f(uniform->_location, value) );
+    uniform->_version = 0;
 }
 
 void Effect::setValue(Uniform* uniform, const float* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
+    if (uniform->_blockOffset >= 0)
+        setBlockValue(uniform, values, 1, 1, count);
+    else
+        GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
+    uniform->_version = 0;
 }
 
 void Effect::setValue(Uniform* uniform, int value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform1i(uniform->_location, value) );
+    if (uniform->_blockOffset >= 0)
+        setBlockValue(uniform, &value, 1, 1, 1);
+    else
+        GL_ASSERT( glUniform1i(uniform->_location, value) );
+    uniform->_version = 0;
 }
 
 void Effect::setValue(Uniform* uniform, const int* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
+    if (uniform->_blockOffset >= 0)
+        setBlockValue(uniform, values, 1, 1, count);
+    else
+        GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
+    uniform->_version = 0;
 }
 
 void Effect::setValue(Uniform* uniform, const Matrix& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
+    if (uniform->_blockOffset >= 0)
+        setBlockValue(uniform, value.m, 4, 4, 1);
+    else
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
+    uniform->_version = 0;
 }
 
 void Effect::setValue(Uniform* uniform, const Matrix* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
+    if (uniform->_blockOffset >= 0)
+        setBlockValue(uniform, values, 4, 4, count);
+    else
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
+    uniform->_version = 0;
 }
 
 void Effect::setValue(Uniform* uniform, const Vector2& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
+    if (uniform->_blockOffset >= 0)
+        setBlockValue(uniform, &value.x, 2, 1, 1);
+    else
+        GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
+    uniform->_version = 0;
 }
 
 void Effect::setValue(Uniform* uniform, const Vector2* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->_blockOffset >= 0)
+        setBlockValue(uniform, values, 2, 1, count);
+    else
+        GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
+    uniform->_version = 0;
 }
 
 void Effect::setValue(Uniform* uniform, const Vector3& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
+    if (uniform->_blockOffset >= 0)
+        setBlockValue(uniform, &value.x, 3, 1, 1);
+    else
+        GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
+    uniform->_version = 0;
 }
 
 void Effect::setValue(Uniform* uniform, const Vector3* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->_blockOffset >= 0)
+        setBlockValue(uniform, values, 3, 1, count);
+    else
+        GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
+    uniform->_version = 0;
 }
 
 void Effect::setValue(Uniform* uniform, const Vector4& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
+    if (uniform->_blockOffset >= 0)
+        setBlockValue(uniform, &value.x, 4, 1, 1);
+    else
+        GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
+    uniform->_version = 0;
 }
 
 void Effect::setValue(Uniform* uniform, const Vector4* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->_blockOffset >= 0)
+        setBlockValue(uniform, values, 4, 1, count);
+    else
+        GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
+    uniform->_version = 0;
 }
 
 void Effect::setValue(Uniform* uniform, const Texture::Sampler* sampler)
@@ -625,6 +1087,7 @@ void Effect::setValue(Uniform* uniform, const Texture::Sampler* sampler)
     const_cast<Texture::Sampler*>(sampler)->bind();
 
     GL_ASSERT( glUniform1i(uniform->_location, uniform->_index) );
+    uniform->_version = 0;
 }
 
 void Effect::setValue(Uniform* uniform, const Texture::Sampler** values, unsigned int count)
@@ -649,6 +1112,31 @@ void Effect::setValue(Uniform* uniform, const Texture::Sampler** values, unsigne
 
     // Pass texture unit array to GL
     GL_ASSERT( glUniform1iv(uniform->_location, count, units) );
+    uniform->_version = 0;
+}
+
+void Effect::setBlockValue(Uniform* uniform, const void* values, unsigned int components, unsigned int columns, unsigned int count)
+{
+    GP_ASSERT(uniform);
+    GP_ASSERT(values);
+
+    // Nothing to write into unless a material block is currently being packed.
+    if (_blockData == NULL)
+        return;
+
+    const unsigned int columnSize = components * sizeof(float);
+    const unsigned char* src = static_cast<const unsigned char*>(values);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        GLint elementOffset = uniform->_blockOffset + i * uniform->_arrayStride;
+        if (elementOffset + (GLint)((columns - 1) * uniform->_matrixStride + columnSize) > _blockSize)
+            break;
+        for (unsigned int c = 0; c < columns; ++c)
+        {
+            memcpy(_blockData + elementOffset + c * uniform->_matrixStride, src, columnSize);
+            src += columnSize;
+        }
+    }
 }
 
 void Effect::bind()
@@ -663,8 +1151,155 @@ Effect* Effect::getCurrentEffect()
     return __currentEffect;
 }
 
+void Effect::setProgramCachePath(const char* path)
+{
+    __programCachePath = path ? path : "";
+}
+
+const char* Effect::getProgramCachePath()
+{
+    return __programCachePath.c_str();
+}
+
+unsigned int Effect::getProgramCacheHits()
+{
+    return __programCacheHits;
+}
+
+unsigned int Effect::getProgramCacheMisses()
+{
+    return __programCacheMisses;
+}
+
+static void warmUpThreadProc()
+{
+    for (size_t i = 0, count = __warmUpVariants.size(); i < count; ++i)
+    {
+        {
+            std::lock_guard<std::mutex> lock(__warmUpMutex);
+            if (__warmUpCancelled)
+                return;
+        }
+
+        // Read and preprocess the shaders here, leaving only the compilation to the rendering thread.
+        WarmUpVariant& variant = __warmUpVariants[i];
+        variant.id = getVariantId(variant.vshPath.c_str(), variant.fshPath.c_str(), variant.defines);
+        variant.key = hashString(variant.id.c_str());
+        variant.valid = preprocessFile(variant.vshPath.c_str(), variant.vshSource) &&
+            preprocessFile(variant.fshPath.c_str(), variant.fshSource);
+        if (!variant.valid)
+            GP_WARN("Failed to read shaders '%s', '%s' for warm-up.", variant.vshPath.c_str(), variant.fshPath.c_str());
+
+        std::lock_guard<std::mutex> lock(__warmUpMutex);
+        __warmUpReady.push_back(&variant);
+    }
+}
+
+bool Effect::warmUp(const char* manifestPath)
+{
+    GP_ASSERT(manifestPath);
+
+    finalizeWarmUp();
+
+    char* manifest = FileSystem::readAll(manifestPath);
+    if (manifest == NULL)
+    {
+        GP_WARN("Failed to read shader warm-up manifest '%s'.", manifestPath);
+        return false;
+    }
+
+    // Each line holds a vertex shader path, a fragment shader path and optional defines.
+    std::istringstream lines(manifest);
+    SAFE_DELETE_ARRAY(manifest);
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        std::istringstream fields(line);
+        WarmUpVariant variant;
+        if (!(fields >> variant.vshPath) || variant.vshPath[0] == '#')
+            continue;
+        std::string defines;
+        if (!(fields >> variant.fshPath))
+        {
+            GP_WARN("Missing fragment shader in shader warm-up manifest '%s': %s", manifestPath, line.c_str());
+            continue;
+        }
+        // The defines are the rest of the line, since valued defines hold spaces.
+        std::getline(fields >> std::ws, defines);
+        variant.defines = canonicalizeDefines(defines.c_str());
+        variant.key = 0;
+        variant.valid = false;
+        __warmUpVariants.push_back(variant);
+    }
+
+    if (!__warmUpVariants.empty())
+        __warmUpThread = std::thread(&warmUpThreadProc);
+    return true;
+}
+
+unsigned int Effect::updateWarmUp(float timeBudget)
+{
+    if (__warmUpCompiled == __warmUpVariants.size())
+        return 0;
+
+    double startTime = Game::getAbsoluteTime();
+    do
+    {
+        WarmUpVariant* variant = NULL;
+        {
+            std::lock_guard<std::mutex> lock(__warmUpMutex);
+            if (__warmUpCompiled < __warmUpReady.size())
+                variant = __warmUpReady[__warmUpCompiled];
+        }
+        if (variant == NULL)
+            break;
+        ++__warmUpCompiled;
+
+        // Compile the variant unless a material has already loaded it, and hold a reference
+        // so that it stays in the effect cache until it is first used.
+        std::map<unsigned long long, Effect*>::const_iterator itr = __effectCache.find(variant->key);
+        if (variant->valid && (itr == __effectCache.end() || itr->second->_id != variant->id))
+        {
+            Effect* effect = createVariant(variant->key, variant->id, variant->vshPath.c_str(), variant->vshSource,
+                                           variant->fshPath.c_str(), variant->fshSource, variant->defines);
+            if (effect)
+                __warmUpEffects.push_back(effect);
+        }
+        variant->vshSource.clear();
+        variant->fshSource.clear();
+    } while (Game::getAbsoluteTime() - startTime < timeBudget);
+
+    unsigned int remaining = (unsigned int)__warmUpVariants.size() - __warmUpCompiled;
+    if (remaining == 0 && __warmUpThread.joinable())
+        __warmUpThread.join();
+    return remaining;
+}
+
+void Effect::finalizeWarmUp()
+{
+    if (__warmUpThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(__warmUpMutex);
+            __warmUpCancelled = true;
+        }
+        __warmUpThread.join();
+    }
+    __warmUpCancelled = false;
+    __warmUpReady.clear();
+    __warmUpVariants.clear();
+    __warmUpCompiled = 0;
+
+    for (size_t i = 0, count = __warmUpEffects.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(__warmUpEffects[i]);
+    }
+    __warmUpEffects.clear();
+}
+
 Uniform::Uniform() :
-    _location(-1), _type(0), _index(0), _effect(NULL)
+    _location(-1), _type(0), _index(0), _effect(NULL), _version(0),
+    _blockOffset(-1), _blockMember(-1), _arrayStride(0), _matrixStride(0)
 {
 }
 
@@ -19,6 +19,10 @@ class Uniform;
  * An effect essentially wraps an OpenGL program object, which includes the
  * vertex and fragment shader.
  *
+ * Where uniform buffers are supported, uniforms declared in a uniform block
+ * named "u_material" are packed per material and uploaded with a single buffer
+ * update instead of being set one at a time.
+ *
  * In the future, this class may be extended to support additional logic that
  * typical effect systems support, such as GPU render state management,
  * techniques and passes.
@@ -26,15 +30,20 @@ class Uniform;
 class Effect: public Ref
 {
     friend class Pass;
+    friend class RenderState;
 
 public:
 
     /**
      * Creates an effect using the specified vertex and fragment shader.
      *
+     * Effects are cached by their shader paths and defines, so creating the same variant
+     * again returns the existing effect. The order of the defines does not matter.
+     * Shader files, including the files they include, are only read and preprocessed once.
+     *
      * @param vshPath The path to the vertex shader file.
      * @param fshPath The path to the fragment shader file.
-     * @param defines A new-line delimited list of preprocessor defines. May be NULL.
+     * @param defines A semicolon or new-line delimited list of preprocessor defines. May be NULL.
      * 
      * @return The created effect.
      */
@@ -45,7 +54,7 @@ public:
      *
      * @param vshSource The vertex shader source code.
      * @param fshSource The fragment shader source code.
-     * @param defines A new-line delimited list of preprocessor defines. May be NULL.
+     * @param defines A semicolon or new-line delimited list of preprocessor defines. May be NULL.
      * 
      * @return The created effect.
      */
@@ -224,6 +233,80 @@ public:
      */
     static Effect* getCurrentEffect();
 
+    /**
+     * Sets the directory that linked programs are cached in between runs.
+     *
+     * When set, and where program binaries are supported, the linked program and the
+     * reflected attributes and uniforms of every effect created from source are stored
+     * in this directory, keyed by a hash of the preprocessed shader source, the defines
+     * and the graphics driver. Later runs load the program binary instead of compiling
+     * and linking the shaders. Binaries that the driver rejects, for example after a
+     * driver update, are compiled again and replaced.
+     *
+     * The directory must already exist. The game configuration's programCache property
+     * sets it at startup.
+     *
+     * @param path The directory to cache programs in, or NULL to disable the cache.
+     */
+    static void setProgramCachePath(const char* path);
+
+    /**
+     * Gets the directory that linked programs are cached in between runs.
+     *
+     * @return The program cache directory, or an empty string if the cache is disabled.
+     */
+    static const char* getProgramCachePath();
+
+    /**
+     * Gets the number of effects that were loaded from the program cache.
+     *
+     * @return The number of program cache hits.
+     */
+    static unsigned int getProgramCacheHits();
+
+    /**
+     * Gets the number of effects that had to be compiled while the program cache was enabled.
+     *
+     * @return The number of program cache misses.
+     */
+    static unsigned int getProgramCacheMisses();
+
+    /**
+     * Starts warming up the shader variants listed in the given manifest.
+     *
+     * Each line of the manifest lists a vertex shader path, a fragment shader path and an
+     * optional semicolon delimited list of defines, separated by whitespace. The defines take
+     * the rest of the line, so they may hold values (e.g. "SKINNING;SKINNING_JOINT_COUNT 32"). Empty lines
+     * and lines starting with '#' are ignored. The shaders are read and preprocessed on a
+     * background thread and the variants are compiled by updateWarmUp, so that they are
+     * already loaded when a material first uses them instead of causing a hitch.
+     *
+     * The game configuration's shaderWarmUp property starts a warm-up at startup.
+     *
+     * @param manifestPath The path to the warm-up manifest.
+     *
+     * @return true if the warm-up was started, false if the manifest could not be read.
+     */
+    static bool warmUp(const char* manifestPath);
+
+    /**
+     * Compiles the warm-up variants that are ready, until the given time budget is spent.
+     *
+     * Compilation requires the graphics context, so this must be called on the rendering
+     * thread. Game calls it once per frame.
+     *
+     * @param timeBudget The time budget in milliseconds. At least one ready variant is
+     *      compiled per call.
+     *
+     * @return The number of variants still waiting to be compiled.
+     */
+    static unsigned int updateWarmUp(float timeBudget);
+
+    /**
+     * Stops the warm-up and releases the warmed up effects that are not in use.
+     */
+    static void finalizeWarmUp();
+
 private:
 
     /**
@@ -243,13 +326,77 @@ private:
 
     static Effect* createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines = NULL);
 
+    /**
+     * Creates an effect from preprocessed shader files and adds it to the effect cache.
+     *
+     * @param key The hash of the variant id.
+     * @param id The variant id.
+     * @param vshPath The path to the vertex shader file.
+     * @param vshSource The preprocessed vertex shader source.
+     * @param fshPath The path to the fragment shader file.
+     * @param fshSource The preprocessed fragment shader source.
+     * @param defines The canonical list of defines.
+     *
+     * @return The created effect.
+     */
+    static Effect* createVariant(unsigned long long key, const std::string& id, const char* vshPath, const std::string& vshSource,
+                                 const char* fshPath, const std::string& fshSource, const std::string& defines);
+
+    /**
+     * Computes the program cache key of the given preprocessed shader sources.
+     *
+     * @param defines The expanded defines, which prefix both shaders.
+     * @param vshSource The preprocessed vertex shader source.
+     * @param fshSource The preprocessed fragment shader source.
+     *
+     * @return The 64-bit key, which also covers the graphics driver.
+     */
+    static unsigned long long computeProgramCacheKey(const char* defines, const char* vshSource, const char* fshSource);
+
+    /**
+     * Creates an effect from the cached program binary with the given key.
+     *
+     * @param key The program cache key.
+     *
+     * @return The effect, or NULL if no valid binary is cached.
+     */
+    static Effect* loadProgramBinary(unsigned long long key);
+
+    /**
+     * Stores the linked program of this effect in the program cache.
+     *
+     * @param key The program cache key.
+     */
+    void saveProgramBinary(unsigned long long key) const;
+
+    /**
+     * Queries the layout of the material uniform block, if the program declares one.
+     */
+    void queryUniformBlock();
+
+    /**
+     * Writes a uniform value into the material uniform block data currently being packed.
+     *
+     * @param uniform The uniform (a member of the material uniform block) to set.
+     * @param values The 4-byte scalar values to write.
+     * @param components The number of scalars per column.
+     * @param columns The number of columns per array element (4 for a matrix, 1 otherwise).
+     * @param count The number of array elements.
+     */
+    void setBlockValue(Uniform* uniform, const void* values, unsigned int components, unsigned int columns, unsigned int count);
+
     GLuint _program;
     std::string _id;
+    unsigned long long _key;
     std::string _vshPath;
     std::string _fshPath;
     std::string _defines;
     std::map<std::string, VertexAttribute> _vertexAttributes;
     mutable std::map<std::string, Uniform*> _uniforms;
+    GLuint _blockIndex;
+    GLint _blockSize;
+    unsigned int _blockMemberCount;
+    unsigned char* _blockData;
     static Uniform _emptyUniform;
 };
 
@@ -259,6 +406,7 @@ private:
 class Uniform
 {
     friend class Effect;
+    friend class RenderState;
 
 public:
 
@@ -310,6 +458,11 @@ private:
     GLenum _type;
     unsigned int _index;
     Effect* _effect;
+    unsigned int _version;
+    GLint _blockOffset;
+    GLint _blockMember;
+    GLint _arrayStride;
+    GLint _matrixStride;
 };
 
 }
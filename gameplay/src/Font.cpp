@@ -10,6 +10,15 @@
 #define FONT_VSH "res/shaders/font.vert"
 #define FONT_FSH "res/shaders/font.frag"
 
+// Size of the glyph atlases shared by the fonts that rasterize glyphs on demand.
+#define FONT_ATLAS_SIZE 1024
+
+// Maximum number of text layouts cached per font size.
+#define FONT_LAYOUT_CACHE_SIZE 256
+
+// Largest font size that glyphs are rasterized at, which fits the size in the atlas key.
+#define FONT_RASTERIZED_SIZE_MAX 2047
+
 namespace gameplay
 {
 
@@ -17,8 +26,17 @@ static std::vector<Font*> __fontCache;
 
 static Effect* __fontEffect = NULL;
 
+// The shared glyph atlases of each format, which are owned by the fonts that use them.
+static GlyphAtlas* __glyphAtlases[2] = { NULL, NULL };
+
+static unsigned int __nextAtlasId = 1;
+
+// The frame number used to find the text layouts that are no longer drawn.
+static unsigned int __layoutFrame = 0;
+
 Font::Font() :
-    _format(BITMAP), _style(PLAIN), _size(0), _spacing(0.0f), _glyphs(NULL), _glyphCount(0), _texture(NULL), _batch(NULL), _cutoffParam(NULL)
+    _format(BITMAP), _style(PLAIN), _size(0), _spacing(0.0f), _glyphs(NULL), _glyphCount(0),
+    _rasterizer(NULL), _atlas(NULL), _atlasId(0), _capturedGlyphKeys(NULL), _texture(NULL), _batch(NULL), _cutoffParam(NULL)
 {
 }
 
@@ -34,6 +52,15 @@ Font::~Font()
     SAFE_DELETE(_batch);
     SAFE_DELETE_ARRAY(_glyphs);
     SAFE_RELEASE(_texture);
+    SAFE_RELEASE(_rasterizer);
+    if (_atlas)
+    {
+        if (_atlas->getRefCount() == 1)
+        {
+            __glyphAtlases[_format] = NULL;
+        }
+        SAFE_RELEASE(_atlas);
+    }
 
     // Free child fonts
     for (size_t i = 0, count = _sizes.size(); i < count; ++i)
@@ -155,10 +182,266 @@ Font* Font::create(const char* family, Style style, unsigned int size, Glyph* gl
     font->_glyphs = new Glyph[glyphCount];
     memcpy(font->_glyphs, glyphs, sizeof(Glyph) * glyphCount);
     font->_glyphCount = glyphCount;
+    for (int i = 0; i < glyphCount; ++i)
+    {
+        font->_glyphIndices[glyphs[i].code] = i;
+    }
+
+    return font;
+}
+
+Font* Font::create(Rasterizer* rasterizer, unsigned int size, Format format)
+{
+    GP_ASSERT(rasterizer);
+    GP_ASSERT(size > 0 && size <= FONT_RASTERIZED_SIZE_MAX);
+
+    // The space glyph is kept as the first glyph, like in bundled fonts, since it is used for spacing.
+    Glyph space;
+    memset(&space, 0, sizeof(Glyph));
+    space.code = ' ';
+    int bearingX = 0;
+    std::vector<unsigned char> pixels;
+    if (!rasterizer->rasterize(' ', size, &space.width, &bearingX, &space.advance, &pixels))
+    {
+        space.width = 0;
+        space.advance = size / 4;
+    }
+    space.bearingX = bearingX;
+
+    GlyphAtlas* atlas = __glyphAtlases[format];
+    if (atlas)
+    {
+        atlas->addRef();
+    }
+    else
+    {
+        atlas = GlyphAtlas::create(FONT_ATLAS_SIZE, FONT_ATLAS_SIZE);
+        __glyphAtlases[format] = atlas;
+    }
+
+    Font* font = create("", PLAIN, size, &space, 1, atlas->getTexture(), format);
+    if (font == NULL)
+    {
+        if (atlas->getRefCount() == 1)
+            __glyphAtlases[format] = NULL;
+        SAFE_RELEASE(atlas);
+        return NULL;
+    }
+
+    // The atlas has no mipmaps.
+    font->_batch->getSampler()->setFilterMode(Texture::LINEAR, Texture::LINEAR);
+
+    rasterizer->addRef();
+    font->_rasterizer = rasterizer;
+    font->_atlas = atlas;
+    font->_atlasId = __nextAtlasId++;
 
     return font;
 }
 
+unsigned int Font::decodeUTF8(const char* text, unsigned int* length)
+{
+    GP_ASSERT(text);
+
+    const unsigned char* c = reinterpret_cast<const unsigned char*>(text);
+    unsigned int codepoint;
+    unsigned int count;
+    if (c[0] < 0x80)
+    {
+        codepoint = c[0];
+        count = 1;
+    }
+    else if ((c[0] & 0xE0) == 0xC0)
+    {
+        codepoint = c[0] & 0x1F;
+        count = 2;
+    }
+    else if ((c[0] & 0xF0) == 0xE0)
+    {
+        codepoint = c[0] & 0x0F;
+        count = 3;
+    }
+    else if ((c[0] & 0xF8) == 0xF0)
+    {
+        codepoint = c[0] & 0x07;
+        count = 4;
+    }
+    else
+    {
+        if (length)
+            *length = 1;
+        return 0xFFFD;
+    }
+
+    for (unsigned int i = 1; i < count; ++i)
+    {
+        if ((c[i] & 0xC0) != 0x80)
+        {
+            if (length)
+                *length = 1;
+            return 0xFFFD;
+        }
+        codepoint = (codepoint << 6) | (c[i] & 0x3F);
+    }
+
+    // Reject overlong encodings, surrogates and code points beyond the Unicode range.
+    static const unsigned int minimums[] = { 0, 0, 0x80, 0x800, 0x10000 };
+    if (codepoint < minimums[count] || (codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF)
+    {
+        if (length)
+            *length = 1;
+        return 0xFFFD;
+    }
+
+    if (length)
+        *length = count;
+    return codepoint;
+}
+
+Font::Glyph* Font::getGlyph(const char* text, bool draw)
+{
+    GP_ASSERT(text);
+
+    // Continuation bytes are drawn with the leading byte of their character.
+    if ((*text & 0xC0) == 0x80)
+        return NULL;
+
+    return findGlyph(decodeUTF8(text), draw);
+}
+
+Font::Glyph* Font::findGlyph(unsigned int codepoint, bool draw)
+{
+    std::unordered_map<unsigned int, unsigned int>::const_iterator index = _glyphIndices.find(codepoint);
+    if (index != _glyphIndices.end())
+        return &_glyphs[index->second];
+
+    if (_rasterizer == NULL)
+        return NULL;
+
+    // Rasterize the glyph the first time it is needed, keeping its metrics even when it is evicted from the atlas.
+    std::unordered_map<unsigned int, Glyph>::iterator itr = _rasterizedGlyphs.find(codepoint);
+    bool found = itr != _rasterizedGlyphs.end();
+    if (found && itr->second.code != codepoint)
+        return NULL; // Not supported by the rasterizer.
+
+    unsigned long long key = ((unsigned long long)_atlasId << 32) | ((unsigned long long)_size << 21) | codepoint;
+    if (draw && _capturedGlyphKeys)
+        _capturedGlyphKeys->push_back(key);
+    if (found && (!draw || itr->second.width == 0 || _atlas->find(key, itr->second.uvs)))
+        return &itr->second;
+
+    Glyph glyph;
+    memset(&glyph, 0, sizeof(Glyph));
+    int bearingX = 0;
+    std::vector<unsigned char> pixels;
+    if (!_rasterizer->rasterize(codepoint, _size, &glyph.width, &bearingX, &glyph.advance, &pixels))
+    {
+        // Remember that the glyph is not supported.
+        _rasterizedGlyphs[codepoint] = glyph;
+        return NULL;
+    }
+    glyph.code = codepoint;
+    glyph.bearingX = bearingX;
+    GP_ASSERT(pixels.size() >= glyph.width * _size);
+
+    Glyph& g = _rasterizedGlyphs[codepoint];
+    g = glyph;
+    if (glyph.width == 0)
+        return &g;
+
+    if (_format == DISTANCE_FIELD)
+    {
+        std::vector<unsigned char> field(glyph.width * _size);
+        GlyphAtlas::computeDistanceField(&pixels[0], glyph.width, _size, std::max(2u, _size / 8), &field[0]);
+        pixels.swap(field);
+    }
+
+    if (!_atlas->insert(key, &pixels[0], glyph.width, _size, g.uvs))
+    {
+        GP_WARN("Failed to add glyph U+%04X to the font atlas; too many glyphs are drawn this frame.", codepoint);
+        return draw ? NULL : &g;
+    }
+    return &g;
+}
+
+static unsigned long long hashBytes(unsigned long long hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static unsigned long long hashRectangle(unsigned long long hash, const Rectangle& rect)
+{
+    hash = hashBytes(hash, &rect.x, sizeof(float));
+    hash = hashBytes(hash, &rect.y, sizeof(float));
+    hash = hashBytes(hash, &rect.width, sizeof(float));
+    return hashBytes(hash, &rect.height, sizeof(float));
+}
+
+unsigned long long Font::hashLayout(const char* text, const LayoutKey& params)
+{
+    GP_ASSERT(text);
+
+    // 64-bit FNV-1a of the text followed by the layout parameters, field by field so
+    // that the padding of the key is never hashed.
+    unsigned long long hash = 14695981039346656037ULL;
+    for (const unsigned char* c = reinterpret_cast<const unsigned char*>(text); *c; ++c)
+    {
+        hash = (hash ^ *c) * 1099511628211ULL;
+    }
+    unsigned char flags = (params.wrap ? 1 : 0) | (params.rightToLeft ? 2 : 0) | (params.ignoreClip ? 4 : 0) | (params.measure ? 8 : 0);
+    int justify = (int)params.justify;
+    hash = hashBytes(hash, &params.size, sizeof(params.size));
+    hash = hashRectangle(hash, params.area);
+    hash = hashBytes(hash, &params.color.x, sizeof(float));
+    hash = hashBytes(hash, &params.color.y, sizeof(float));
+    hash = hashBytes(hash, &params.color.z, sizeof(float));
+    hash = hashBytes(hash, &params.color.w, sizeof(float));
+    hash = hashBytes(hash, &justify, sizeof(justify));
+    hash = hashBytes(hash, &flags, sizeof(flags));
+    return hashRectangle(hash, params.clip);
+}
+
+Font::TextLayout* Font::createLayout(unsigned long long key)
+{
+    if (_layouts.size() >= FONT_LAYOUT_CACHE_SIZE)
+    {
+        // Drop the layouts that were not used during this frame or the previous one.
+        for (std::unordered_map<unsigned long long, TextLayout>::iterator itr = _layouts.begin(); itr != _layouts.end(); )
+        {
+            if (itr->second.lastUsed + 1 < __layoutFrame)
+                itr = _layouts.erase(itr);
+            else
+                ++itr;
+        }
+        if (_layouts.size() >= FONT_LAYOUT_CACHE_SIZE)
+            return NULL;
+    }
+
+    TextLayout& layout = _layouts[key];
+    layout.vertices.clear();
+    layout.indices.clear();
+    layout.glyphKeys.clear();
+    layout.evictionCount = _atlas ? _atlas->getEvictionCount() : 0;
+    layout.lastUsed = __layoutFrame;
+    return &layout;
+}
+
+void Font::frameEnded()
+{
+    ++__layoutFrame;
+
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+        if (__glyphAtlases[i])
+            __glyphAtlases[i]->nextFrame();
+    }
+}
+
 unsigned int Font::getSize(unsigned int index) const
 {
     GP_ASSERT(index <= _sizes.size());
@@ -179,9 +462,7 @@ Font::Format Font::getFormat()
 
 bool Font::isCharacterSupported(int character) const
 {
-    // TODO: Update this once we support unicode fonts
-    int glyphIndex = character - 32; // HACK for ASCII
-    return (glyphIndex >= 0 && glyphIndex < (int)_glyphCount);
+    return const_cast<Font*>(this)->findGlyph((unsigned int)character, false) != NULL;
 }
 
 void Font::start()
@@ -226,6 +507,26 @@ Font* Font::findClosestSize(int size)
     if (size == (int)_size)
         return this;
 
+    if (_rasterizer)
+    {
+        // Rasterize glyphs at the exact size, creating a font for each size drawn.
+        for (size_t i = 0, count = _sizes.size(); i < count; ++i)
+        {
+            if ((int)_sizes[i]->_size == size)
+                return _sizes[i];
+        }
+        if (size > 0 && size <= FONT_RASTERIZED_SIZE_MAX)
+        {
+            Font* font = create(_rasterizer, (unsigned int)size, _format);
+            if (font)
+            {
+                font->_spacing = _spacing;
+                _sizes.push_back(font);
+                return font;
+            }
+        }
+    }
+
     int diff = abs(size - (int)_size);
     Font* closest = this;
     for (size_t i = 0, count = _sizes.size(); i < count; ++i)
@@ -356,10 +657,10 @@ void Font::drawText(const char* text, int x, int y, const Vector4& color, unsign
                 xPos += _glyphs[0].advance * 4;
                 break;
             default:
-                int index = c - 32; // HACK for ASCII
-                if (index >= 0 && index < (int)_glyphCount)
+                Glyph* glyph = getGlyph(rightToLeft ? &cursor[i] : &text[i], true);
+                if (glyph)
                 {
-                    Glyph& g = _glyphs[index];
+                    Glyph& g = *glyph;
 
                     if (getFormat() == DISTANCE_FIELD )
                     {
@@ -397,6 +698,90 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
     GP_ASSERT(text);
     GP_ASSERT(_size);
 
+    if (size == 0)
+        size = _size;
+    Font* f = findClosestSize(size);
+    GP_ASSERT(f);
+    f->lazyStart();
+
+    LayoutKey params = LayoutKey();
+    params.size = size;
+    params.area = area;
+    params.color = color;
+    params.justify = justify;
+    params.wrap = wrap;
+    params.rightToLeft = rightToLeft;
+    params.clip = clip;
+    unsigned long long key = hashLayout(text, params);
+
+    // Replay the glyph quads of the text if it was laid out the same way before.
+    std::unordered_map<unsigned long long, TextLayout>::iterator itr = f->_layouts.find(key);
+    if (itr != f->_layouts.end() && (f->_atlas == NULL || itr->second.evictionCount == f->_atlas->getEvictionCount()))
+    {
+        TextLayout& layout = itr->second;
+        layout.lastUsed = __layoutFrame;
+        if (!layout.vertices.empty())
+        {
+            // Mark the glyphs as used during this frame so that they stay in the atlas.
+            float uvs[4];
+            for (size_t i = 0, count = layout.glyphKeys.size(); i < count; ++i)
+            {
+                f->_atlas->find(layout.glyphKeys[i], uvs);
+            }
+            if (f->_format == DISTANCE_FIELD)
+            {
+                if (f->_cutoffParam == NULL)
+                    f->_cutoffParam = f->_batch->getMaterial()->getParameter("u_cutoff");
+                f->_cutoffParam->setVector(Vector2(1.0, 1.0));
+            }
+            f->_batch->add(&layout.vertices[0], (unsigned int)layout.vertices.size(), &layout.indices[0], (unsigned int)layout.indices.size());
+        }
+        return;
+    }
+
+    TextLayout* layout = f->createLayout(key);
+    if (layout == NULL)
+    {
+        f->drawTextLayout(text, area, color, size, justify, wrap, rightToLeft, clip);
+        return;
+    }
+
+    // Lay the text out, capturing the glyph quads it draws.
+    f->_batch->_capturedVertices = &layout->vertices;
+    f->_capturedGlyphKeys = f->_atlas ? &layout->glyphKeys : NULL;
+    f->drawTextLayout(text, area, color, size, justify, wrap, rightToLeft, clip);
+    f->_batch->_capturedVertices = NULL;
+    f->_capturedGlyphKeys = NULL;
+
+    // Join the quads into a single triangle strip with degenerate triangles.
+    unsigned int quadCount = (unsigned int)layout->vertices.size() / 4;
+    GP_ASSERT(layout->vertices.size() == quadCount * 4);
+    if (layout->vertices.size() > USHRT_MAX)
+    {
+        f->_layouts.erase(key);
+        return;
+    }
+    layout->indices.reserve(quadCount * 6);
+    for (unsigned int i = 0; i < quadCount; ++i)
+    {
+        unsigned short first = (unsigned short)(i * 4);
+        if (i > 0)
+        {
+            layout->indices.push_back(first - 1);
+            layout->indices.push_back(first);
+        }
+        layout->indices.push_back(first);
+        layout->indices.push_back(first + 1);
+        layout->indices.push_back(first + 2);
+        layout->indices.push_back(first + 3);
+    }
+}
+
+void Font::drawTextLayout(const char* text, const Rectangle& area, const Vector4& color, unsigned int size, Justify justify, bool wrap, bool rightToLeft, const Rectangle& clip)
+{
+    GP_ASSERT(text);
+    GP_ASSERT(_size);
+
     if (size == 0)
     {
         size = _size;
@@ -407,7 +792,7 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
         Font* f = findClosestSize(size);
         if (f != this)
         {
-            f->drawText(text, area, color, size, justify, wrap, rightToLeft, clip);
+            f->drawTextLayout(text, area, color, size, justify, wrap, rightToLeft, clip);
             return;
         }
     }
@@ -507,12 +892,10 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
         GP_ASSERT(_batch);
         for (int i = startIndex; i < (int)tokenLength && i >= 0; i += iteration)
         {
-            char c = token[i];
-            int glyphIndex = c - 32; // HACK for ASCII
-
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            Glyph* glyph = getGlyph(&token[i], true);
+            if (glyph)
             {
-                Glyph& g = _glyphs[glyphIndex];
+                Glyph& g = *glyph;
 
                 if (xPos + (int)(g.advance*scale) > area.x + area.width)
                 {
@@ -672,6 +1055,41 @@ void Font::measureText(const char* text, const Rectangle& clip, unsigned int siz
     GP_ASSERT(text);
     GP_ASSERT(out);
 
+    if (size == 0)
+        size = _size;
+    Font* f = findClosestSize(size);
+    GP_ASSERT(f);
+
+    LayoutKey params = LayoutKey();
+    params.size = size;
+    params.area = clip;
+    params.justify = justify;
+    params.wrap = wrap;
+    params.ignoreClip = ignoreClip;
+    params.measure = true;
+    unsigned long long key = hashLayout(text, params);
+
+    std::unordered_map<unsigned long long, TextLayout>::iterator itr = f->_layouts.find(key);
+    if (itr != f->_layouts.end())
+    {
+        itr->second.lastUsed = __layoutFrame;
+        *out = itr->second.bounds;
+        return;
+    }
+
+    f->measureTextLayout(text, clip, size, out, justify, wrap, ignoreClip);
+
+    TextLayout* layout = f->createLayout(key);
+    if (layout)
+        layout->bounds = *out;
+}
+
+void Font::measureTextLayout(const char* text, const Rectangle& clip, unsigned int size, Rectangle* out, Justify justify, bool wrap, bool ignoreClip)
+{
+    GP_ASSERT(_size);
+    GP_ASSERT(text);
+    GP_ASSERT(out);
+
     if (size == 0)
     {
         size = _size;
@@ -682,7 +1100,7 @@ void Font::measureText(const char* text, const Rectangle& clip, unsigned int siz
         Font* f = findClosestSize(size);
         if (f != this)
         {
-            f->measureText(text, clip, size, out, justify, wrap, ignoreClip);
+            f->measureTextLayout(text, clip, size, out, justify, wrap, ignoreClip);
             return;
         }
     }
@@ -1206,7 +1624,18 @@ float Font::getCharacterSpacing() const
 
 void Font::setCharacterSpacing(float spacing)
 {
+    if (_spacing == spacing)
+        return;
+
+    // The cached layouts were laid out with the previous spacing, which the sizes
+    // of the font share.
     _spacing = spacing;
+    _layouts.clear();
+    for (size_t i = 0, count = _sizes.size(); i < count; ++i)
+    {
+        _sizes[i]->_spacing = spacing;
+        _sizes[i]->_layouts.clear();
+    }
 }
 
 int Font::getIndexAtLocation(const char* text, const Rectangle& area, unsigned int size, const Vector2& inLocation, Vector2* outLocation,
@@ -1356,12 +1785,10 @@ int Font::getIndexOrLocation(const char* text, const Rectangle& area, unsigned i
         GP_ASSERT(_glyphs);
         for (int i = startIndex; i < (int)tokenLength && i >= 0; i += iteration)
         {
-            char c = token[i];
-            int glyphIndex = c - 32; // HACK for ASCII
-
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            Glyph* glyph = getGlyph(&token[i], false);
+            if (glyph)
             {
-                Glyph& g = _glyphs[glyphIndex];
+                Glyph& g = *glyph;
 
                 if (xPos + (int)(g.advance*scale) > area.x + area.width)
                 {
@@ -1492,10 +1919,10 @@ unsigned int Font::getTokenWidth(const char* token, unsigned int length, unsigne
             tokenWidth += _glyphs[0].advance * 4;
             break;
         default:
-            int glyphIndex = c - 32;
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            Glyph* glyph = getGlyph(&token[i], false);
+            if (glyph)
             {
-                Glyph& g = _glyphs[glyphIndex];
+                Glyph& g = *glyph;
                 tokenWidth += floor(g.advance * scale + spacing);
             }
             break;
@@ -2,16 +2,23 @@
 #define FONT_H_
 
 #include "SpriteBatch.h"
+#include "GlyphAtlas.h"
 
 namespace gameplay
 {
 
 /**
  * Defines a font for text rendering.
+ *
+ * Text is encoded in UTF-8. Fonts loaded from a bundle draw the glyphs baked into the
+ * bundle, at each of the sizes baked into it. Fonts created from a Rasterizer instead
+ * rasterize glyphs on demand, at the exact size they are drawn at, into a glyph atlas
+ * shared by all such fonts of the same format.
  */
 class Font : public Ref
 {
     friend class Bundle;
+    friend class Game;
     friend class Text;
     friend class TextBox;
 
@@ -59,6 +66,32 @@ public:
         DISTANCE_FIELD = 1
     };
 
+    /**
+     * Defines an interface for rasterizing glyphs on demand, such as with a TrueType font engine.
+     */
+    class Rasterizer : public Ref
+    {
+    public:
+
+        /**
+         * Rasterizes the glyph of a character.
+         *
+         * The glyph image covers the full height of a line of text: it is size pixels tall,
+         * with the baseline at the same height for every glyph of a given size.
+         *
+         * @param codepoint The Unicode code point of the character.
+         * @param size The font size (line height) in pixels.
+         * @param width Populated with the width of the glyph image in pixels.
+         * @param bearingX Populated with the left side bearing of the glyph in pixels.
+         * @param advance Populated with the horizontal advance of the glyph in pixels.
+         * @param pixels Populated with width * size 8-bit coverage values, with the top row first.
+         *
+         * @return true if the glyph was rasterized, false if the character is not supported.
+         */
+        virtual bool rasterize(unsigned int codepoint, unsigned int size, unsigned int* width, int* bearingX,
+                               unsigned int* advance, std::vector<unsigned char>* pixels) = 0;
+    };
+
     /**
      * Creates a font from the given bundle.
      *
@@ -77,6 +110,35 @@ public:
      */
     static Font* create(const char* path, const char* id = NULL);
 
+    /**
+     * Creates a font that rasterizes its glyphs on demand.
+     *
+     * Glyphs are rasterized the first time they are measured or drawn at a given size,
+     * and are added to a glyph atlas shared by all of the fonts created this way with
+     * the same format. Distance field glyphs are computed from the rasterized coverage.
+     *
+     * @param rasterizer The rasterizer to rasterize glyphs with (the font holds a reference to it).
+     * @param size The default font size in pixels.
+     * @param format The format of the glyphs.
+     *
+     * @return The new Font or NULL if there was an error.
+     * @script{create}
+     */
+    static Font* create(Rasterizer* rasterizer, unsigned int size, Format format = BITMAP);
+
+    /**
+     * Decodes the UTF-8 character at the start of the given text.
+     *
+     * Invalid sequences, including continuation bytes without a leading byte, decode
+     * to U+FFFD, one byte at a time.
+     *
+     * @param text The text to decode.
+     * @param length Populated with the number of bytes of the character (optional).
+     *
+     * @return The Unicode code point of the character.
+     */
+    static unsigned int decodeUTF8(const char* text, unsigned int* length = NULL);
+
     /**
      * Gets the font size (max height of glyphs) in pixels, at the specified index.
      *
@@ -101,7 +163,7 @@ public:
     /**
      * Determines if this font supports the specified character code.
      *
-     * @param character The character code to check.
+     * @param character The Unicode code point to check.
      * @return True if this Font supports (can draw) the specified character, false otherwise.
      */
     bool isCharacterSupported(int character) const;
@@ -329,8 +391,55 @@ private:
     void addLineInfo(const Rectangle& area, int lineWidth, int lineLength, Justify hAlign,
                      std::vector<int>* xPositions, std::vector<unsigned int>* lineLengths, bool rightToLeft);
 
+    /**
+     * The parameters of a text layout, which are hashed with the text to find cached layouts.
+     */
+    struct LayoutKey
+    {
+        unsigned int size;
+        Rectangle area;
+        Vector4 color;
+        Justify justify;
+        bool wrap;
+        bool rightToLeft;
+        bool ignoreClip;
+        bool measure;
+        Rectangle clip;
+    };
+
+    /**
+     * A cached text layout: the glyph quads drawn for a text, or its measured bounds.
+     */
+    struct TextLayout
+    {
+        std::vector<SpriteBatch::SpriteVertex> vertices;
+        std::vector<unsigned short> indices;
+        std::vector<unsigned long long> glyphKeys;
+        Rectangle bounds;
+        unsigned int evictionCount;
+        unsigned int lastUsed;
+    };
+
+    void drawTextLayout(const char* text, const Rectangle& area, const Vector4& color, unsigned int size,
+                        Justify justify, bool wrap, bool rightToLeft, const Rectangle& clip);
+
+    void measureTextLayout(const char* text, const Rectangle& clip, unsigned int size, Rectangle* out,
+                           Justify justify, bool wrap, bool ignoreClip);
+
+    static unsigned long long hashLayout(const char* text, const LayoutKey& params);
+
+    TextLayout* createLayout(unsigned long long key);
+
     Font* findClosestSize(int size);
 
+    // Gets the glyph of the UTF-8 character starting at text, or NULL if text points within a
+    // character or the character is not supported. The glyph is added to the atlas if draw is true.
+    Glyph* getGlyph(const char* text, bool draw);
+
+    Glyph* findGlyph(unsigned int codepoint, bool draw);
+
+    static void frameEnded();
+
     void lazyStart();
 
     Format _format;
@@ -343,6 +452,13 @@ private:
     float _spacing;
     Glyph* _glyphs;
     unsigned int _glyphCount;
+    std::unordered_map<unsigned int, unsigned int> _glyphIndices;
+    std::unordered_map<unsigned int, Glyph> _rasterizedGlyphs;
+    Rasterizer* _rasterizer;
+    GlyphAtlas* _atlas;
+    unsigned int _atlasId;
+    std::unordered_map<unsigned long long, TextLayout> _layouts;
+    std::vector<unsigned long long>* _capturedGlyphKeys;
     Texture* _texture;
     SpriteBatch* _batch;
     Rectangle _viewport;
@@ -42,7 +42,8 @@ struct FormInit
 };
 static FormInit __init;
 
-Form::Form() : Drawable(), _batched(true)
+Form::Form() : Drawable(), _batched(true), _geometry(NULL), _hitTestColumns(1), _hitTestRows(1), _hitTestDirty(true),
+    _regeneratedControlCount(0), _reusedControlCount(0)
 {
 }
 
@@ -200,9 +201,14 @@ void Form::update(float elapsedTime)
 {
     Container::update(elapsedTime);
 
+    // Rebuild the hit test grid on the next query if any bounds or state may change.
+    if (_dirtyBits & (DIRTY_BOUNDS | DIRTY_STATE | DIRTY_CHILDREN))
+        _hitTestDirty = true;
+
     // Do a two-pass bounds update:
     //  1. First pass updates leaf controls
     //  2. Second pass updates parent controls that depend on child sizes
+    // Each pass only visits the controls on the paths to dirty controls.
     if (updateBoundsInternal(Vector2::zero()))
         updateBoundsInternal(Vector2::zero());
 }
@@ -218,6 +224,19 @@ void Form::startBatch(SpriteBatch* batch)
         if (_batched)
             _batches.push_back(batch);
     }
+
+    // Retain the sprites drawn into the batch, starting a new range whenever the batch changes.
+    if (_geometry)
+    {
+        if (_geometry->empty() || _geometry->back().batch != batch)
+        {
+            if (!_geometry->empty())
+                _geometry->back().batch->_capturedVertices = NULL;
+            _geometry->push_back(Control::GeometryRange());
+            _geometry->back().batch = batch;
+        }
+        batch->_capturedVertices = &_geometry->back().vertices;
+    }
 }
 
 void Form::finishBatch(SpriteBatch* batch)
@@ -228,6 +247,62 @@ void Form::finishBatch(SpriteBatch* batch)
     }
 }
 
+void Form::startGeometry(std::vector<Control::GeometryRange>* ranges)
+{
+    GP_ASSERT(ranges);
+    GP_ASSERT(_geometry == NULL);
+
+    ranges->clear();
+    _geometry = ranges;
+}
+
+void Form::finishGeometry()
+{
+    GP_ASSERT(_geometry);
+
+    if (!_geometry->empty())
+        _geometry->back().batch->_capturedVertices = NULL;
+
+    // Join the quads of each range into a single triangle strip with degenerate triangles.
+    for (size_t i = 0, count = _geometry->size(); i < count; ++i)
+    {
+        GeometryRange& range = (*_geometry)[i];
+        unsigned int quadCount = (unsigned int)range.vertices.size() / 4;
+        GP_ASSERT(range.vertices.size() == quadCount * 4);
+        GP_ASSERT(range.vertices.size() <= USHRT_MAX);
+        range.indices.clear();
+        range.indices.reserve(quadCount * 6);
+        for (unsigned int j = 0; j < quadCount; ++j)
+        {
+            unsigned short first = (unsigned short)(j * 4);
+            if (j > 0)
+            {
+                range.indices.push_back(first - 1);
+                range.indices.push_back(first);
+            }
+            range.indices.push_back(first);
+            range.indices.push_back(first + 1);
+            range.indices.push_back(first + 2);
+            range.indices.push_back(first + 3);
+        }
+    }
+    _geometry = NULL;
+}
+
+void Form::drawGeometry(std::vector<Control::GeometryRange>& ranges)
+{
+    for (size_t i = 0, count = ranges.size(); i < count; ++i)
+    {
+        GeometryRange& range = ranges[i];
+        if (range.vertices.empty())
+            continue;
+
+        startBatch(range.batch);
+        range.batch->add(&range.vertices[0], (unsigned int)range.vertices.size(), &range.indices[0], (unsigned int)range.indices.size());
+        finishBatch(range.batch);
+    }
+}
+
 const Matrix& Form::getProjectionMatrix() const
 {
     return  _projectionMatrix;
@@ -262,6 +337,8 @@ unsigned int Form::draw(bool wireframe)
     }
 
     // Draw the form
+    _regeneratedControlCount = 0;
+    _reusedControlCount = 0;
     unsigned int drawCalls = Container::draw(this, _absoluteClipBounds);
 
     // Flush all batches that were queued during drawing and then empty the batch list
@@ -287,6 +364,16 @@ bool Form::isBatchingEnabled() const
     return _batched;
 }
 
+unsigned int Form::getRegeneratedControlCount() const
+{
+    return _regeneratedControlCount;
+}
+
+unsigned int Form::getReusedControlCount() const
+{
+    return _reusedControlCount;
+}
+
 void Form::setBatchingEnabled(bool enabled)
 {
     _batched = enabled;
@@ -349,7 +436,7 @@ Control* Form::findInputControl(int* x, int* y, bool focus, unsigned int contact
             continue;
 
         // Search for an input control within this form
-        Control* ctrl = findInputControl(form, formX, formY, focus, contactIndex);
+        Control* ctrl = form->hitTest(formX, formY, focus);
         if (ctrl)
         {
             *x = formX;
@@ -366,35 +453,111 @@ Control* Form::findInputControl(int* x, int* y, bool focus, unsigned int contact
     return NULL;
 }
 
-Control* Form::findInputControl(Control* control, int x, int y, bool focus, unsigned int contactIndex)
+void Form::addHitTestEntries(Control* control)
 {
     if (!(control->_visible && control->isEnabled()))
-        return NULL;
-
-    Control* result = NULL;
+        return;
 
-    // Does the passed in control's bounds intersect the specified coordinates - and 
-    // does the control support the specified input state?
-    if (control->_consumeInputEvents && (!focus || control->canFocus()))
+    // Entries are added in the order the controls are searched, so later entries take precedence.
+    if (control->_consumeInputEvents && !control->_absoluteClipBounds.isEmpty())
     {
-        if (control->_absoluteClipBounds.contains(x, y))
-            result = control;
+        HitTestEntry entry;
+        entry.control = control;
+        entry.bounds = control->_absoluteClipBounds;
+        entry.canFocus = control->canFocus();
+        _hitTestEntries.push_back(entry);
     }
 
-    // If the control has children, search for an input control inside it that also
-    // supports the above conditions.
     if (control->isContainer())
     {
         Container* container = static_cast<Container*>(control);
         for (unsigned int i = 0, childCount = container->getControlCount(); i < childCount; ++i)
         {
-            Control* ctrl = findInputControl(container->getControl(i), x, y, focus, contactIndex);
-            if (ctrl)
-                result = ctrl;
+            addHitTestEntries(container->getControl(i));
+        }
+    }
+}
+
+void Form::getHitTestCells(const Rectangle& bounds, int* x1, int* y1, int* x2, int* y2) const
+{
+    float cellWidth = _hitTestBounds.width / _hitTestColumns;
+    float cellHeight = _hitTestBounds.height / _hitTestRows;
+    *x1 = MATH_CLAMP((int)((bounds.x - _hitTestBounds.x) / cellWidth), 0, (int)_hitTestColumns - 1);
+    *y1 = MATH_CLAMP((int)((bounds.y - _hitTestBounds.y) / cellHeight), 0, (int)_hitTestRows - 1);
+    *x2 = MATH_CLAMP((int)((bounds.right() - _hitTestBounds.x) / cellWidth), 0, (int)_hitTestColumns - 1);
+    *y2 = MATH_CLAMP((int)((bounds.bottom() - _hitTestBounds.y) / cellHeight), 0, (int)_hitTestRows - 1);
+}
+
+void Form::updateHitTest()
+{
+    _hitTestEntries.clear();
+    addHitTestEntries(this);
+    _hitTestBounds = _absoluteClipBounds;
+    _hitTestDirty = false;
+
+    // Use about as many cells as entries, in a grid of up to 64x64 cells.
+    unsigned int entryCount = (unsigned int)_hitTestEntries.size();
+    unsigned int size = MATH_CLAMP((unsigned int)sqrtf((float)entryCount), 1u, 64u);
+    _hitTestColumns = _hitTestRows = size;
+    if (_hitTestBounds.isEmpty())
+        _hitTestColumns = _hitTestRows = 1;
+
+    // Bucket the entries into the cells they overlap, keeping their order within each cell.
+    unsigned int cellCount = _hitTestColumns * _hitTestRows;
+    _hitTestCellOffsets.assign(cellCount + 1, 0);
+    int x1, y1, x2, y2;
+    for (unsigned int i = 0; i < entryCount; ++i)
+    {
+        getHitTestCells(_hitTestEntries[i].bounds, &x1, &y1, &x2, &y2);
+        for (int y = y1; y <= y2; ++y)
+        {
+            for (int x = x1; x <= x2; ++x)
+                ++_hitTestCellOffsets[y * _hitTestColumns + x + 1];
+        }
+    }
+    for (unsigned int i = 0; i < cellCount; ++i)
+    {
+        _hitTestCellOffsets[i + 1] += _hitTestCellOffsets[i];
+    }
+    _hitTestCells.resize(_hitTestCellOffsets[cellCount]);
+    std::vector<unsigned int> next(_hitTestCellOffsets.begin(), _hitTestCellOffsets.end() - 1);
+    for (unsigned int i = 0; i < entryCount; ++i)
+    {
+        getHitTestCells(_hitTestEntries[i].bounds, &x1, &y1, &x2, &y2);
+        for (int y = y1; y <= y2; ++y)
+        {
+            for (int x = x1; x <= x2; ++x)
+                _hitTestCells[next[y * _hitTestColumns + x]++] = i;
+        }
+    }
+}
+
+Control* Form::hitTest(int x, int y, bool focus)
+{
+    // Controls added or removed since the last update mark the form dirty, and removed
+    // controls may already be destroyed, so the grid must be rebuilt before it is searched.
+    if (_hitTestDirty || (_dirtyBits & (DIRTY_BOUNDS | DIRTY_STATE | DIRTY_CHILDREN)))
+        updateHitTest();
+
+    if (!_hitTestBounds.contains(x, y))
+        return NULL;
+
+    // Search the cell under the point from the last entry to the first.
+    Rectangle point((float)x, (float)y, 0.0f, 0.0f);
+    int x1, y1, x2, y2;
+    getHitTestCells(point, &x1, &y1, &x2, &y2);
+    unsigned int cell = y1 * _hitTestColumns + x1;
+    for (unsigned int i = _hitTestCellOffsets[cell + 1]; i > _hitTestCellOffsets[cell]; --i)
+    {
+        const HitTestEntry& entry = _hitTestEntries[_hitTestCells[i - 1]];
+        if (entry.bounds.contains(x, y) && (!focus || entry.canFocus) &&
+            entry.control->_visible && entry.control->isEnabled())
+        {
+            return entry.control;
         }
     }
 
-    return result;
+    return NULL;
 }
 
 Control* Form::handlePointerPressRelease(int* x, int* y, bool pressed, unsigned int contactIndex)
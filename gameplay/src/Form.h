@@ -140,6 +140,23 @@ public:
      */
     void setBatchingEnabled(bool enabled);
 
+    /**
+     * Gets the number of controls whose skin and image sprites were generated during the last draw.
+     *
+     * Controls retain the sprites they draw and only generate them again when their bounds,
+     * state, skin, opacity or content change.
+     *
+     * @return The number of regenerated controls.
+     */
+    unsigned int getRegeneratedControlCount() const;
+
+    /**
+     * Gets the number of controls whose retained sprites were drawn again during the last draw.
+     *
+     * @return The number of reused controls.
+     */
+    unsigned int getReusedControlCount() const;
+
 private:
     
     /**
@@ -223,6 +240,13 @@ private:
      */
     static bool gamepadJoystickEventInternal(Gamepad* gamepad, unsigned int index);
 
+    struct HitTestEntry
+    {
+        Control* control;
+        Rectangle bounds;
+        bool canFocus;
+    };
+
     /**
      * Fired by the platform when the game window resizes.
      *
@@ -241,6 +265,21 @@ private:
      */
     void finishBatch(SpriteBatch* batch);
 
+    /**
+     * Starts retaining the sprites drawn into the sprite batches of this form into the given ranges.
+     */
+    void startGeometry(std::vector<Control::GeometryRange>* ranges);
+
+    /**
+     * Stops retaining sprites, completing the ranges passed to startGeometry.
+     */
+    void finishGeometry();
+
+    /**
+     * Draws sprites retained by a previous call to startGeometry.
+     */
+    void drawGeometry(std::vector<Control::GeometryRange>& ranges);
+
     /**
      * Unproject a point (from a mouse or touch event) into the scene and then project it onto the form.
      *
@@ -258,7 +297,19 @@ private:
 
     static Control* findInputControl(int* x, int* y, bool focus, unsigned int contactIndex);
 
-    static Control* findInputControl(Control* control, int x, int y, bool focus, unsigned int contactIndex);
+    /**
+     * Finds the topmost control of this form that accepts input at a point, in form coordinates.
+     */
+    Control* hitTest(int x, int y, bool focus);
+
+    /**
+     * Rebuilds the grid of control bounds used for hit testing.
+     */
+    void updateHitTest();
+
+    void addHitTestEntries(Control* control);
+
+    void getHitTestCells(const Rectangle& bounds, int* x1, int* y1, int* x2, int* y2) const;
 
     static Control* handlePointerPressRelease(int* x, int* y, bool pressed, unsigned int contactIndex);
 
@@ -279,6 +330,16 @@ private:
     Matrix _projectionMatrix;           // Projection matrix to be set on SpriteBatch objects when rendering the form
     std::vector<SpriteBatch*> _batches;
     bool _batched;
+    std::vector<Control::GeometryRange>* _geometry;
+    std::vector<HitTestEntry> _hitTestEntries;      // Controls that accept input, in search order
+    std::vector<unsigned int> _hitTestCells;        // Entry indices of each grid cell
+    std::vector<unsigned int> _hitTestCellOffsets;  // Offset of each grid cell in _hitTestCells
+    Rectangle _hitTestBounds;
+    unsigned int _hitTestColumns;
+    unsigned int _hitTestRows;
+    bool _hitTestDirty;
+    unsigned int _regeneratedControlCount;
+    unsigned int _reusedControlCount;
 };
 
 }
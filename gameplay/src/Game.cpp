@@ -4,11 +4,17 @@
 #include "RenderState.h"
 #include "FileSystem.h"
 #include "FrameBuffer.h"
+#include "Effect.h"
+#include "MeshBatch.h"
+#include "Font.h"
 #include "SceneLoader.h"
 #include "ControlFactory.h"
 #include "Theme.h"
 #include "Form.h"
 
+// Time in milliseconds spent compiling warm-up shader variants per frame.
+#define SHADER_WARMUP_BUDGET 4.0f
+
 /** @script{ignore} */
 GLenum __gl_error_code = GL_NO_ERROR;
 /** @script{ignore} */
@@ -163,6 +169,9 @@ bool Game::startup()
     setViewport(Rectangle(0.0f, 0.0f, (float)_width, (float)_height));
     RenderState::initialize();
     FrameBuffer::initialize();
+    Effect::setProgramCachePath(_config->programCache.c_str());
+    if (!_config->shaderWarmUp.empty())
+        Effect::warmUp(_config->shaderWarmUp.c_str());
 
     _animationController = new AnimationController();
     _animationController->initialize();
@@ -279,8 +288,10 @@ void Game::shutdown()
 
         SAFE_DELETE(_audioListener);
 
+        Effect::finalizeWarmUp();
         FrameBuffer::finalize();
         RenderState::finalize();
+        Texture::finalize();
 
 		_state = UNINITIALIZED;
     }
@@ -382,6 +393,9 @@ void Game::frame()
         float elapsedTime = (frameTime - lastFrameTime);
         lastFrameTime = frameTime;
 
+        // Compile warm-up shader variants.
+        Effect::updateWarmUp(SHADER_WARMUP_BUDGET);
+
         // Update the scheduled and running animations.
         _animationController->update(elapsedTime);
 
@@ -414,6 +428,10 @@ void Game::frame()
         if (_scriptTarget)
             _scriptTarget->fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(GameScriptTarget, render), elapsedTime);
 
+        MeshBatch::frameEnded();
+        Font::frameEnded();
+        Texture::frameEnded();
+
         // Update FPS.
         ++_frameCount;
         if ((Game::getGameTime() - _frameLastFPS) >= 1000)
@@ -763,7 +781,7 @@ Game::Config* Game::getConfig()
 Game::Config::Config() :
     title(""), fullscreen(false), resizable(true),
     x(0), y(0), width(1920), height(1080), samples(4),
-    theme(""), gamepad("")
+    theme(""), gamepad(""), programCache(""), shaderWarmUp("")
 {
 }
 
@@ -794,6 +812,8 @@ void Game::Config::serialize(Serializer* serializer)
     serializer->writeInt("samples", samples, 0);
     serializer->writeString("theme", theme.c_str(), "");
     serializer->writeString("gamepad", gamepad.c_str(), "");
+    serializer->writeString("programCache", programCache.c_str(), "");
+    serializer->writeString("shaderWarmUp", shaderWarmUp.c_str(), "");
     
     // FIXME: seant
     /*
@@ -819,6 +839,11 @@ void Game::Config::deserialize(Serializer* serializer)
     samples = serializer->readInt("samples", 0);
     serializer->readString("theme", theme, "");
     serializer->readString("gamepad", gamepad, "");
+    if (serializer->hasPropertiesOfVersion(4, 1))
+    {
+        serializer->readString("programCache", programCache, "");
+        serializer->readString("shaderWarmUp", shaderWarmUp, "");
+    }
     
     // FIXME:
     // aliases read the pairs
@@ -666,6 +666,8 @@ public:
         unsigned int samples;        
         std::string theme;
         std::string gamepad;
+        std::string programCache;
+        std::string shaderWarmUp;
         std::vector<std::pair<std::string, std::string> > aliases;
     };
 
@@ -0,0 +1,236 @@
+#include "Base.h"
+#include "GlyphAtlas.h"
+
+// Number of empty pixels kept around each glyph so that filtering does not sample its neighbours.
+#define GLYPH_ATLAS_PADDING 1
+
+namespace gameplay
+{
+
+GlyphAtlas::GlyphAtlas(unsigned int width, unsigned int height)
+    : _width(width), _height(height), _shelvesHeight(0), _frame(0), _evictionCount(0), _texture(NULL)
+{
+    _pixels.resize(width * height, 0);
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    SAFE_RELEASE(_texture);
+}
+
+GlyphAtlas* GlyphAtlas::create(unsigned int width, unsigned int height)
+{
+    GP_ASSERT(width > 0 && height > 0);
+    return new GlyphAtlas(width, height);
+}
+
+unsigned int GlyphAtlas::getWidth() const
+{
+    return _width;
+}
+
+unsigned int GlyphAtlas::getHeight() const
+{
+    return _height;
+}
+
+const unsigned char* GlyphAtlas::getPixels() const
+{
+    return &_pixels[0];
+}
+
+unsigned int GlyphAtlas::getGlyphCount() const
+{
+    return (unsigned int)_entries.size();
+}
+
+unsigned int GlyphAtlas::getEvictionCount() const
+{
+    return _evictionCount;
+}
+
+void GlyphAtlas::getUVs(const Entry& entry, float* uvs) const
+{
+    GP_ASSERT(uvs);
+    uvs[0] = (float)entry.x / (float)_width;
+    uvs[1] = (float)entry.y / (float)_height;
+    uvs[2] = (float)(entry.x + entry.width) / (float)_width;
+    uvs[3] = (float)(entry.y + entry.height) / (float)_height;
+}
+
+bool GlyphAtlas::find(unsigned long long key, float* uvs)
+{
+    std::unordered_map<unsigned long long, Entry>::const_iterator itr = _entries.find(key);
+    if (itr == _entries.end())
+        return false;
+
+    _shelves[itr->second.shelf].lastUsed = _frame;
+    getUVs(itr->second, uvs);
+    return true;
+}
+
+bool GlyphAtlas::insert(unsigned long long key, const unsigned char* pixels, unsigned int width, unsigned int height, float* uvs)
+{
+    GP_ASSERT(pixels || width == 0 || height == 0);
+    GP_ASSERT(_entries.find(key) == _entries.end());
+
+    int shelfIndex = findShelf(width + GLYPH_ATLAS_PADDING, height + GLYPH_ATLAS_PADDING);
+    if (shelfIndex < 0)
+        return false;
+
+    Shelf& shelf = _shelves[shelfIndex];
+    Entry entry;
+    entry.shelf = (unsigned int)shelfIndex;
+    entry.x = shelf.x;
+    entry.y = shelf.y;
+    entry.width = width;
+    entry.height = height;
+    shelf.x += width + GLYPH_ATLAS_PADDING;
+    shelf.lastUsed = _frame;
+    shelf.keys.push_back(key);
+    _entries[key] = entry;
+
+    for (unsigned int row = 0; row < height; ++row)
+    {
+        memcpy(&_pixels[(entry.y + row) * _width + entry.x], &pixels[row * width], width);
+    }
+    if (_texture && width > 0 && height > 0)
+    {
+        _texture->setData(pixels, entry.x, entry.y, width, height);
+    }
+
+    getUVs(entry, uvs);
+    return true;
+}
+
+int GlyphAtlas::findShelf(unsigned int width, unsigned int height)
+{
+    if (width > _width || height > _height)
+        return -1;
+
+    // Prefer the lowest existing shelf that fits the glyph without wasting much height.
+    int best = -1;
+    for (size_t i = 0, count = _shelves.size(); i < count; ++i)
+    {
+        const Shelf& shelf = _shelves[i];
+        if (shelf.height >= height && shelf.height <= height + height / 4 + 2 && shelf.x + width <= _width &&
+            (best < 0 || shelf.height < _shelves[best].height))
+        {
+            best = (int)i;
+        }
+    }
+    if (best >= 0)
+        return best;
+
+    // Open a new shelf below the others.
+    if (_shelvesHeight + height <= _height)
+    {
+        Shelf shelf;
+        shelf.y = _shelvesHeight;
+        shelf.height = height;
+        shelf.x = 0;
+        shelf.lastUsed = _frame;
+        _shelves.push_back(shelf);
+        _shelvesHeight += height;
+        return (int)_shelves.size() - 1;
+    }
+
+    // Use any shelf that is tall enough and still has room.
+    for (size_t i = 0, count = _shelves.size(); i < count; ++i)
+    {
+        const Shelf& shelf = _shelves[i];
+        if (shelf.height >= height && shelf.x + width <= _width &&
+            (best < 0 || shelf.height < _shelves[best].height))
+        {
+            best = (int)i;
+        }
+    }
+    if (best >= 0)
+        return best;
+
+    // Evict the least recently used shelf that is tall enough and not used during this frame.
+    for (size_t i = 0, count = _shelves.size(); i < count; ++i)
+    {
+        const Shelf& shelf = _shelves[i];
+        if (shelf.height >= height && shelf.lastUsed != _frame &&
+            (best < 0 || shelf.lastUsed < _shelves[best].lastUsed))
+        {
+            best = (int)i;
+        }
+    }
+    if (best >= 0)
+        clearShelf(_shelves[best]);
+    return best;
+}
+
+void GlyphAtlas::clearShelf(Shelf& shelf)
+{
+    for (size_t i = 0, count = shelf.keys.size(); i < count; ++i)
+    {
+        _entries.erase(shelf.keys[i]);
+    }
+    _evictionCount += (unsigned int)shelf.keys.size();
+    shelf.keys.clear();
+    shelf.x = 0;
+
+    // Clear the pixels so that the padding around the new glyphs is empty.
+    unsigned char* pixels = &_pixels[shelf.y * _width];
+    memset(pixels, 0, shelf.height * _width);
+    if (_texture)
+    {
+        _texture->setData(pixels, 0, shelf.y, _width, shelf.height);
+    }
+}
+
+void GlyphAtlas::nextFrame()
+{
+    ++_frame;
+}
+
+Texture* GlyphAtlas::getTexture()
+{
+    if (_texture == NULL)
+    {
+        _texture = Texture::create(Texture::ALPHA, _width, _height, &_pixels[0], false);
+    }
+    return _texture;
+}
+
+void GlyphAtlas::computeDistanceField(const unsigned char* src, unsigned int width, unsigned int height, unsigned int spread, unsigned char* dst)
+{
+    GP_ASSERT(src || width == 0 || height == 0);
+    GP_ASSERT(dst != src);
+    GP_ASSERT(spread > 0);
+
+    int s = (int)spread;
+    int w = (int)width;
+    int h = (int)height;
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            // Search the neighbourhood for the nearest pixel on the other side of the edge.
+            // Pixels outside of the image are outside of the glyph.
+            bool inside = src[y * w + x] >= 128;
+            int nearest = s * s + 1;
+            for (int dy = -s; dy <= s; ++dy)
+            {
+                int sy = y + dy;
+                for (int dx = -s; dx <= s; ++dx)
+                {
+                    int sx = x + dx;
+                    bool other = (sx >= 0 && sx < w && sy >= 0 && sy < h) ? src[sy * w + sx] >= 128 : false;
+                    int d = dx * dx + dy * dy;
+                    if (other != inside && d < nearest)
+                        nearest = d;
+                }
+            }
+
+            float distance = std::min(sqrtf((float)nearest) - 0.5f, (float)s);
+            float value = 128.0f + (inside ? distance : -distance) * 127.0f / (float)s;
+            dst[y * w + x] = (unsigned char)std::max(0.0f, std::min(255.0f, value));
+        }
+    }
+}
+
+}
@@ -0,0 +1,182 @@
+#ifndef GLYPHATLAS_H_
+#define GLYPHATLAS_H_
+
+#include "Ref.h"
+#include "Texture.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a texture atlas that glyphs are packed into as they are rasterized.
+ *
+ * Glyph images are 8-bit coverage (or distance) values. They are packed into horizontal
+ * shelves, each shelf holding images of up to its height. When the atlas is full, the
+ * least recently used shelf whose glyphs have not been used during the current frame
+ * is cleared and reused, and its glyphs must be inserted again the next time they are
+ * needed.
+ *
+ * Packing and eviction work on a copy of the atlas held in memory, so they can be used
+ * without a graphics device. The texture is created from that copy the first time it
+ * is requested, and glyphs inserted after that are copied to it as they are inserted.
+ */
+class GlyphAtlas : public Ref
+{
+public:
+
+    /**
+     * Creates a new, empty glyph atlas.
+     *
+     * @param width The width of the atlas in pixels.
+     * @param height The height of the atlas in pixels.
+     *
+     * @return The new glyph atlas.
+     * @script{create}
+     */
+    static GlyphAtlas* create(unsigned int width, unsigned int height);
+
+    /**
+     * Gets the width of the atlas.
+     *
+     * @return The width in pixels.
+     */
+    unsigned int getWidth() const;
+
+    /**
+     * Gets the height of the atlas.
+     *
+     * @return The height in pixels.
+     */
+    unsigned int getHeight() const;
+
+    /**
+     * Gets the pixels of the atlas, one byte per pixel with the top row first.
+     *
+     * @return The pixels.
+     */
+    const unsigned char* getPixels() const;
+
+    /**
+     * Gets the number of glyphs currently in the atlas.
+     *
+     * @return The number of glyphs.
+     */
+    unsigned int getGlyphCount() const;
+
+    /**
+     * Gets the number of glyphs evicted from the atlas since it was created.
+     *
+     * @return The number of evicted glyphs.
+     */
+    unsigned int getEvictionCount() const;
+
+    /**
+     * Finds a glyph in the atlas and marks it as used during the current frame.
+     *
+     * @param key The key the glyph was inserted with.
+     * @param uvs Populated with the texture coordinates of the glyph (u1, v1, u2, v2).
+     *
+     * @return true if the glyph is in the atlas, false if it was never inserted or was evicted.
+     */
+    bool find(unsigned long long key, float* uvs);
+
+    /**
+     * Inserts a glyph image into the atlas and marks it as used during the current frame.
+     *
+     * @param key The key identifying the glyph.
+     * @param pixels The glyph image, one byte per pixel with the top row first (may be NULL when width or height is zero).
+     * @param width The width of the image.
+     * @param height The height of the image.
+     * @param uvs Populated with the texture coordinates of the glyph (u1, v1, u2, v2).
+     *
+     * @return true if the glyph was inserted, false if there is no room left for it.
+     */
+    bool insert(unsigned long long key, const unsigned char* pixels, unsigned int width, unsigned int height, float* uvs);
+
+    /**
+     * Starts a new frame, after which the glyphs used during the previous frames may be evicted.
+     */
+    void nextFrame();
+
+    /**
+     * Gets the texture of the atlas, creating it if needed.
+     *
+     * @return The texture.
+     */
+    Texture* getTexture();
+
+    /**
+     * Converts a coverage image into a signed distance field.
+     *
+     * Each output pixel holds the distance to the nearest edge, mapped so that 128 lies
+     * on the edge, 255 is at least spread pixels inside the glyph and 0 is at least spread
+     * pixels outside of it.
+     *
+     * @param src The coverage image, one byte per pixel.
+     * @param width The width of the image.
+     * @param height The height of the image.
+     * @param spread The distance in pixels covered by the field.
+     * @param dst Populated with the distance field (width * height bytes, may not be src).
+     */
+    static void computeDistanceField(const unsigned char* src, unsigned int width, unsigned int height, unsigned int spread, unsigned char* dst);
+
+private:
+
+    struct Shelf
+    {
+        unsigned int y;
+        unsigned int height;
+        unsigned int x;
+        unsigned int lastUsed;
+        std::vector<unsigned long long> keys;
+    };
+
+    struct Entry
+    {
+        unsigned int shelf;
+        unsigned int x;
+        unsigned int y;
+        unsigned int width;
+        unsigned int height;
+    };
+
+    /**
+     * Constructor.
+     */
+    GlyphAtlas(unsigned int width, unsigned int height);
+
+    /**
+     * Destructor.
+     */
+    ~GlyphAtlas();
+
+    /**
+     * Hidden copy constructor.
+     */
+    GlyphAtlas(const GlyphAtlas& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    GlyphAtlas& operator=(const GlyphAtlas&);
+
+    int findShelf(unsigned int width, unsigned int height);
+
+    void clearShelf(Shelf& shelf);
+
+    void getUVs(const Entry& entry, float* uvs) const;
+
+    unsigned int _width;
+    unsigned int _height;
+    std::vector<unsigned char> _pixels;
+    std::vector<Shelf> _shelves;
+    std::unordered_map<unsigned long long, Entry> _entries;
+    unsigned int _shelvesHeight;
+    unsigned int _frame;
+    unsigned int _evictionCount;
+    Texture* _texture;
+};
+
+}
+
+#endif
@@ -2,16 +2,183 @@
 #include "FileSystem.h"
 #include "Image.h"
 
+// Number of source pixels on each side of a destination pixel sampled by the Kaiser mipmap filter.
+#define IMAGE_KAISER_RADIUS 4
+
+// Largest file buffer kept by each thread for the next image; larger buffers are freed after decoding.
+#define IMAGE_DECODER_BUFFER_MAX (4 * 1024 * 1024)
+
+#if defined(GP_USE_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define IMAGE_USE_SSE
+#include <xmmintrin.h>
+#endif
+
 namespace gameplay
 {
-// Callback for reading a png image using Stream
-static void readStream(png_structp png, png_bytep data, png_size_t length)
+
+// dst[i] = src[i] * scalar
+static void scaleStream(float* dst, const float* src, float scalar, unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(GP_USE_NEON)
+    float32x4_t s = vdupq_n_f32(scalar);
+    for (; i + 4 <= count; i += 4)
+        vst1q_f32(dst + i, vmulq_f32(vld1q_f32(src + i), s));
+#elif defined(IMAGE_USE_SSE)
+    __m128 s = _mm_set1_ps(scalar);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), s));
+#endif
+    for (; i < count; ++i)
+        dst[i] = src[i] * scalar;
+}
+
+// dst[i] += src[i] * scalar
+static void addScaledStream(float* dst, const float* src, float scalar, unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(GP_USE_NEON)
+    float32x4_t s = vdupq_n_f32(scalar);
+    for (; i + 4 <= count; i += 4)
+        vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i), vld1q_f32(src + i), s));
+#elif defined(IMAGE_USE_SSE)
+    __m128 s = _mm_set1_ps(scalar);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), s)));
+#endif
+    for (; i < count; ++i)
+        dst[i] += src[i] * scalar;
+}
+
+// Tables converting between 8-bit sRGB values and linear values.
+struct SRGBTables
+{
+    float toLinear[256];
+    unsigned char fromLinear[4096];
+
+    SRGBTables()
+    {
+        for (unsigned int i = 0; i < 256; ++i)
+        {
+            float c = i / 255.0f;
+            toLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (unsigned int i = 0; i < 4096; ++i)
+        {
+            float c = i / 4095.0f;
+            c = c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+            fromLinear[i] = (unsigned char)(c * 255.0f + 0.5f);
+        }
+    }
+};
+
+static const SRGBTables& getSRGBTables()
+{
+    static const SRGBTables tables;
+    return tables;
+}
+
+// Modified Bessel function of the first kind of order zero, for the Kaiser window.
+static float besselI0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    for (int k = 1; k < 16; ++k)
+    {
+        float t = x / (2.0f * k);
+        term *= t * t;
+        sum += term;
+    }
+    return sum;
+}
+
+// The taps of the Kaiser mipmap filter: a sinc with the cutoff of a 2:1 reduction, windowed by a
+// Kaiser window, sampled at the source pixels around a destination pixel.
+struct KaiserWeights
+{
+    float weights[IMAGE_KAISER_RADIUS * 2];
+
+    KaiserWeights()
+    {
+        const float beta = 4.0f;
+        float sum = 0.0f;
+        for (int i = 0; i < IMAGE_KAISER_RADIUS * 2; ++i)
+        {
+            float d = (float)(i - IMAGE_KAISER_RADIUS) + 0.5f;
+            float x = MATH_PI * d * 0.5f;
+            float t = d / IMAGE_KAISER_RADIUS;
+            weights[i] = (sinf(x) / x) * besselI0(beta * sqrtf(1.0f - t * t)) / besselI0(beta);
+            sum += weights[i];
+        }
+        for (int i = 0; i < IMAGE_KAISER_RADIUS * 2; ++i)
+            weights[i] /= sum;
+    }
+};
+
+static const KaiserWeights& getKaiserWeights()
+{
+    static const KaiserWeights weights;
+    return weights;
+}
+
+// Computes the fraction of RGBA pixels whose scaled alpha passes an alpha test.
+static float computeAlphaCoverage(const float* pixels, unsigned int count, float cutoff, float scale)
+{
+    unsigned int passed = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (pixels[i * 4 + 3] * scale > cutoff)
+            ++passed;
+    }
+    return (float)passed / (float)count;
+}
+
+// Finds the scale to apply to the alpha of a mipmap level to give it an alpha test coverage.
+static float findAlphaScale(const float* pixels, unsigned int count, float cutoff, float coverage)
+{
+    float low = 0.0f;
+    float high = 4.0f;
+    float scale = 1.0f;
+    for (unsigned int i = 0; i < 10; ++i)
+    {
+        float c = computeAlphaCoverage(pixels, count, cutoff, scale);
+        if (c < coverage)
+            low = scale;
+        else if (c > coverage)
+            high = scale;
+        else
+            break;
+        scale = (low + high) * 0.5f;
+    }
+    return scale;
+}
+
+// The file data of the image being decoded, reused by the images decoded on the same thread.
+struct ImageDecoder
+{
+    std::vector<unsigned char> buffer;
+    size_t size;
+    size_t position;
+};
+
+static ImageDecoder& getDecoder()
+{
+    static thread_local ImageDecoder decoder;
+    return decoder;
+}
+
+// Callback for reading a png image from the decoder buffer.
+static void readBuffer(png_structp png, png_bytep data, png_size_t length)
 {
-    Stream* stream = reinterpret_cast<Stream*>(png_get_io_ptr(png));
-    if (stream == NULL || stream->read(data, 1, length) != length)
+    ImageDecoder* decoder = reinterpret_cast<ImageDecoder*>(png_get_io_ptr(png));
+    if (decoder == NULL || decoder->position + length > decoder->size)
     {
         png_error(png, "Error reading PNG.");
     }
+    memcpy(data, &decoder->buffer[decoder->position], length);
+    decoder->position += length;
 }
 
 Image* Image::create(const char* path)
@@ -26,9 +193,46 @@ Image* Image::create(const char* path)
         return NULL;
     }
 
+    // Read the whole file with a single read when its length is known.
+    ImageDecoder& decoder = getDecoder();
+    decoder.size = 0;
+    decoder.position = 0;
+    size_t length = stream->length();
+    if (length > 0)
+    {
+        if (decoder.buffer.size() < length)
+            decoder.buffer.resize(length);
+        decoder.size = stream->read(&decoder.buffer[0], 1, length);
+    }
+    else
+    {
+        size_t read;
+        do
+        {
+            if (decoder.buffer.size() < decoder.size + 65536)
+                decoder.buffer.resize(decoder.size + 65536);
+            read = stream->read(&decoder.buffer[decoder.size], 1, 65536);
+            decoder.size += read;
+        } while (read > 0);
+    }
+    stream->close();
+
+    Image* image;
+    if (decoder.size >= 4 && memcmp(&decoder.buffer[0], "qoif", 4) == 0)
+        image = createQOI(path, &decoder.buffer[0], decoder.size);
+    else
+        image = createPNG(path, decoder);
+
+    // Don't keep the memory of a large file for the lifetime of the thread.
+    if (decoder.buffer.capacity() > IMAGE_DECODER_BUFFER_MAX)
+        std::vector<unsigned char>().swap(decoder.buffer);
+    return image;
+}
+
+Image* Image::createPNG(const char* path, ImageDecoder& decoder)
+{
     // Verify PNG signature.
-    unsigned char sig[8];
-    if (stream->read(sig, 1, 8) != 8 || png_sig_cmp(sig, 0, 8) != 0)
+    if (decoder.size < 8 || png_sig_cmp(&decoder.buffer[0], 0, 8) != 0)
     {
         GP_ERROR("Failed to load file '%s'; not a valid PNG.", path);
         return NULL;
@@ -51,24 +255,31 @@ Image* Image::create(const char* path)
         return NULL;
     }
 
+    Image* image = new Image();
+
     // Set up error handling (required without using custom error handlers above).
     if (setjmp(png_jmpbuf(png)))
     {
-        GP_ERROR("Failed to set up error handling for reading PNG file '%s'.", path);
+        GP_ERROR("Failed to read PNG file '%s'.", path);
         png_destroy_read_struct(&png, &info, NULL);
+        SAFE_RELEASE(image);
         return NULL;
     }
 
-    // Initialize file io.
-    png_set_read_fn(png, stream.get(), readStream);
-
-    // Indicate that we already read the first 8 bytes (signature).
+    // Initialize io, skipping the signature.
+    decoder.position = 8;
+    png_set_read_fn(png, &decoder, readBuffer);
     png_set_sig_bytes(png, 8);
 
-    // Read the entire image into memory.
-    png_read_png(png, info, PNG_TRANSFORM_STRIP_16 | PNG_TRANSFORM_PACKING | PNG_TRANSFORM_EXPAND | PNG_TRANSFORM_GRAY_TO_RGB, NULL);
+    // Read the header and convert all formats to 8-bit RGB or RGBA.
+    png_read_info(png, info);
+    png_set_strip_16(png);
+    png_set_packing(png);
+    png_set_expand(png);
+    png_set_gray_to_rgb(png);
+    int passes = png_set_interlace_handling(png);
+    png_read_update_info(png, info);
 
-    Image* image = new Image();
     image->_width = png_get_image_width(png, info);
     image->_height = png_get_image_height(png, info);
 
@@ -86,6 +297,7 @@ Image* Image::create(const char* path)
     default:
         GP_ERROR("Unsupported PNG color type (%d) for image file '%s'.", (int)colorType, path);
         png_destroy_read_struct(&png, &info, NULL);
+        SAFE_RELEASE(image);
         return NULL;
     }
 
@@ -94,11 +306,13 @@ Image* Image::create(const char* path)
     // Allocate image data.
     image->_data = new unsigned char[stride * image->_height];
 
-    // Read rows into image data.
-    png_bytepp rows = png_get_rows(png, info);
-    for (unsigned int i = 0; i < image->_height; ++i)
+    // Decode the rows directly into the image data, bottom row first.
+    for (int pass = 0; pass < passes; ++pass)
     {
-        memcpy(image->_data+(stride * (image->_height-1-i)), rows[i], stride);
+        for (unsigned int i = 0; i < image->_height; ++i)
+        {
+            png_read_row(png, image->_data + stride * (image->_height - 1 - i), NULL);
+        }
     }
 
     // Clean up.
@@ -107,6 +321,225 @@ Image* Image::create(const char* path)
     return image;
 }
 
+// QOI image format chunk tags.
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF 0x40
+#define QOI_OP_LUMA 0x80
+#define QOI_OP_RUN 0xC0
+#define QOI_OP_RGB 0xFE
+#define QOI_OP_RGBA 0xFF
+#define QOI_MASK 0xC0
+#define QOI_HEADER_SIZE 14
+#define QOI_PIXELS_MAX 400000000ull
+#define QOI_HASH(p) (((p)[0] * 3 + (p)[1] * 5 + (p)[2] * 7 + (p)[3] * 11) & 63)
+
+Image* Image::createQOI(const char* path, const unsigned char* data, size_t size)
+{
+    if (size < QOI_HEADER_SIZE + 8)
+    {
+        GP_ERROR("Failed to load file '%s'; not a valid QOI image.", path);
+        return NULL;
+    }
+
+    unsigned int width = (data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
+    unsigned int height = (data[8] << 24) | (data[9] << 16) | (data[10] << 8) | data[11];
+    unsigned int channels = data[12];
+    if (width == 0 || height == 0 || (channels != 3 && channels != 4) || (unsigned long long)width * height > QOI_PIXELS_MAX)
+    {
+        GP_ERROR("Failed to load file '%s'; unsupported QOI image (%dx%d, %d channels).", path, width, height, channels);
+        return NULL;
+    }
+
+    Image* image = new Image();
+    image->_width = width;
+    image->_height = height;
+    image->_format = channels == 4 ? Image::RGBA : Image::RGB;
+    image->_data = new unsigned char[width * height * channels];
+
+    unsigned char index[64][4];
+    memset(index, 0, sizeof(index));
+    unsigned char pixel[4] = { 0, 0, 0, 255 };
+    size_t position = QOI_HEADER_SIZE;
+    size_t end = size - 8;
+    unsigned int run = 0;
+
+    // Decode the rows into the image data, bottom row first.
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        unsigned char* row = image->_data + (height - 1 - y) * width * channels;
+        for (unsigned int x = 0; x < width; ++x, row += channels)
+        {
+            if (run > 0)
+            {
+                --run;
+            }
+            else if (position < end)
+            {
+                unsigned char tag = data[position++];
+                if (tag == QOI_OP_RGB)
+                {
+                    pixel[0] = data[position];
+                    pixel[1] = data[position + 1];
+                    pixel[2] = data[position + 2];
+                    position += 3;
+                }
+                else if (tag == QOI_OP_RGBA)
+                {
+                    memcpy(pixel, &data[position], 4);
+                    position += 4;
+                }
+                else if ((tag & QOI_MASK) == QOI_OP_INDEX)
+                {
+                    memcpy(pixel, index[tag], 4);
+                }
+                else if ((tag & QOI_MASK) == QOI_OP_DIFF)
+                {
+                    pixel[0] += ((tag >> 4) & 3) - 2;
+                    pixel[1] += ((tag >> 2) & 3) - 2;
+                    pixel[2] += (tag & 3) - 2;
+                }
+                else if ((tag & QOI_MASK) == QOI_OP_LUMA)
+                {
+                    unsigned char next = data[position++];
+                    int dg = (tag & 63) - 32;
+                    pixel[0] += dg - 8 + ((next >> 4) & 15);
+                    pixel[1] += dg;
+                    pixel[2] += dg - 8 + (next & 15);
+                }
+                else
+                {
+                    run = tag & 63;
+                }
+                memcpy(index[QOI_HASH(pixel)], pixel, 4);
+            }
+
+            row[0] = pixel[0];
+            row[1] = pixel[1];
+            row[2] = pixel[2];
+            if (channels == 4)
+                row[3] = pixel[3];
+        }
+    }
+
+    return image;
+}
+
+bool Image::saveQOI(const char* path) const
+{
+    GP_ASSERT(path);
+    GP_ASSERT(_data);
+
+    unsigned int channels = _format == RGBA ? 4 : 3;
+    std::vector<unsigned char> data;
+    data.reserve(QOI_HEADER_SIZE + _width * _height * (channels + 1) + 8);
+
+    // Header: magic, big endian size, channels and colorspace (sRGB with linear alpha).
+    const unsigned char header[QOI_HEADER_SIZE] =
+    {
+        'q', 'o', 'i', 'f',
+        (unsigned char)(_width >> 24), (unsigned char)(_width >> 16), (unsigned char)(_width >> 8), (unsigned char)_width,
+        (unsigned char)(_height >> 24), (unsigned char)(_height >> 16), (unsigned char)(_height >> 8), (unsigned char)_height,
+        (unsigned char)channels, 0
+    };
+    data.insert(data.end(), header, header + QOI_HEADER_SIZE);
+
+    unsigned char index[64][4];
+    memset(index, 0, sizeof(index));
+    unsigned char previous[4] = { 0, 0, 0, 255 };
+    unsigned char pixel[4] = { 0, 0, 0, 255 };
+    unsigned int run = 0;
+    unsigned int count = _width * _height;
+    unsigned int written = 0;
+
+    // Encode the rows top row first, as the file stores them.
+    for (unsigned int y = 0; y < _height; ++y)
+    {
+        const unsigned char* row = _data + (_height - 1 - y) * _width * channels;
+        for (unsigned int x = 0; x < _width; ++x, row += channels)
+        {
+            pixel[0] = row[0];
+            pixel[1] = row[1];
+            pixel[2] = row[2];
+            if (channels == 4)
+                pixel[3] = row[3];
+            ++written;
+
+            if (memcmp(pixel, previous, 4) == 0)
+            {
+                ++run;
+                if (run == 62 || written == count)
+                {
+                    data.push_back((unsigned char)(QOI_OP_RUN | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0)
+            {
+                data.push_back((unsigned char)(QOI_OP_RUN | (run - 1)));
+                run = 0;
+            }
+
+            unsigned int hash = QOI_HASH(pixel);
+            if (memcmp(index[hash], pixel, 4) == 0)
+            {
+                data.push_back((unsigned char)(QOI_OP_INDEX | hash));
+            }
+            else
+            {
+                memcpy(index[hash], pixel, 4);
+                if (pixel[3] == previous[3])
+                {
+                    int dr = (signed char)(pixel[0] - previous[0]);
+                    int dg = (signed char)(pixel[1] - previous[1]);
+                    int db = (signed char)(pixel[2] - previous[2]);
+                    int dgr = dr - dg;
+                    int dgb = db - dg;
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                    {
+                        data.push_back((unsigned char)(QOI_OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2)));
+                    }
+                    else if (dgr >= -8 && dgr <= 7 && dg >= -32 && dg <= 31 && dgb >= -8 && dgb <= 7)
+                    {
+                        data.push_back((unsigned char)(QOI_OP_LUMA | (dg + 32)));
+                        data.push_back((unsigned char)(((dgr + 8) << 4) | (dgb + 8)));
+                    }
+                    else
+                    {
+                        data.push_back(QOI_OP_RGB);
+                        data.insert(data.end(), pixel, pixel + 3);
+                    }
+                }
+                else
+                {
+                    data.push_back(QOI_OP_RGBA);
+                    data.insert(data.end(), pixel, pixel + 4);
+                }
+            }
+            memcpy(previous, pixel, 4);
+        }
+    }
+
+    // End marker.
+    const unsigned char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    data.insert(data.end(), padding, padding + 8);
+
+    std::unique_ptr<Stream> stream(FileSystem::open(path, FileSystem::WRITE));
+    if (stream.get() == NULL || !stream->canWrite())
+    {
+        GP_ERROR("Failed to open image file '%s' for writing.", path);
+        return false;
+    }
+    if (stream->write(&data[0], 1, data.size()) != data.size())
+    {
+        GP_ERROR("Failed to write image file '%s'.", path);
+        return false;
+    }
+    stream->close();
+    return true;
+}
+
 Image* Image::create(unsigned int width, unsigned int height, Image::Format format, unsigned char* data)
 {
     GP_ASSERT(width > 0 && height > 0);
@@ -144,6 +577,126 @@ Image::Image() : _data(NULL), _format(RGB), _width(0), _height(0)
 Image::~Image()
 {
     SAFE_DELETE_ARRAY(_data);
+    for (size_t i = 0, count = _mipmaps.size(); i < count; ++i)
+    {
+        SAFE_DELETE_ARRAY(_mipmaps[i]);
+    }
+}
+
+void Image::generateMipmaps(MipmapFilter filter, bool sRGB, float alphaCutoff)
+{
+    GP_ASSERT(_data);
+
+    for (size_t i = 0, count = _mipmaps.size(); i < count; ++i)
+    {
+        SAFE_DELETE_ARRAY(_mipmaps[i]);
+    }
+    _mipmaps.clear();
+
+    const SRGBTables& srgb = getSRGBTables();
+    const float* weights = getKaiserWeights().weights;
+    unsigned int channels = _format == RGBA ? 4 : 3;
+    bool coverage = _format == RGBA && alphaCutoff > 0.0f;
+
+    // Convert the image to floating point values in linear space.
+    unsigned int width = _width;
+    unsigned int height = _height;
+    std::vector<float> src(width * height * channels);
+    for (size_t i = 0, count = src.size(); i < count; ++i)
+    {
+        bool alpha = channels == 4 && (i & 3) == 3;
+        src[i] = (sRGB && !alpha) ? srgb.toLinear[_data[i]] : _data[i] * (1.0f / 255.0f);
+    }
+    float imageCoverage = coverage ? computeAlphaCoverage(&src[0], width * height, alphaCutoff, 1.0f) : 0.0f;
+
+    std::vector<float> dst;
+    std::vector<float> row;
+    while (width > 1 || height > 1)
+    {
+        unsigned int dstWidth = std::max(width >> 1, 1u);
+        unsigned int dstHeight = std::max(height >> 1, 1u);
+        unsigned int rowSize = width * channels;
+        dst.resize(dstWidth * dstHeight * channels);
+        row.resize(rowSize);
+
+        for (unsigned int y = 0; y < dstHeight; ++y)
+        {
+            // Filter the source rows into a single row at the source width.
+            if (filter == MIPMAP_BOX)
+            {
+                unsigned int y0 = std::min(y * 2, height - 1);
+                unsigned int y1 = std::min(y * 2 + 1, height - 1);
+                scaleStream(&row[0], &src[y0 * rowSize], 0.5f, rowSize);
+                addScaledStream(&row[0], &src[y1 * rowSize], 0.5f, rowSize);
+            }
+            else
+            {
+                for (int t = 0; t < IMAGE_KAISER_RADIUS * 2; ++t)
+                {
+                    int sy = std::max(0, std::min((int)(y * 2) + 1 - IMAGE_KAISER_RADIUS + t, (int)height - 1));
+                    if (t == 0)
+                        scaleStream(&row[0], &src[sy * rowSize], weights[t], rowSize);
+                    else
+                        addScaledStream(&row[0], &src[sy * rowSize], weights[t], rowSize);
+                }
+            }
+
+            // Filter the row horizontally into the destination.
+            float* out = &dst[y * dstWidth * channels];
+            for (unsigned int x = 0; x < dstWidth; ++x)
+            {
+                for (unsigned int c = 0; c < channels; ++c)
+                {
+                    float value;
+                    if (filter == MIPMAP_BOX)
+                    {
+                        unsigned int x0 = std::min(x * 2, width - 1);
+                        unsigned int x1 = std::min(x * 2 + 1, width - 1);
+                        value = (row[x0 * channels + c] + row[x1 * channels + c]) * 0.5f;
+                    }
+                    else
+                    {
+                        value = 0.0f;
+                        for (int t = 0; t < IMAGE_KAISER_RADIUS * 2; ++t)
+                        {
+                            int sx = std::max(0, std::min((int)(x * 2) + 1 - IMAGE_KAISER_RADIUS + t, (int)width - 1));
+                            value += row[sx * channels + c] * weights[t];
+                        }
+                    }
+                    out[x * channels + c] = value;
+                }
+            }
+        }
+
+        // Write the level, scaling its alpha to keep the alpha test coverage of the image.
+        float alphaScale = coverage ? findAlphaScale(&dst[0], dstWidth * dstHeight, alphaCutoff, imageCoverage) : 1.0f;
+        unsigned char* data = new unsigned char[dst.size()];
+        for (size_t i = 0, count = dst.size(); i < count; ++i)
+        {
+            bool alpha = channels == 4 && (i & 3) == 3;
+            float value = std::max(0.0f, std::min(alpha ? dst[i] * alphaScale : dst[i], 1.0f));
+            if (sRGB && !alpha)
+                data[i] = srgb.fromLinear[(unsigned int)(value * 4095.0f + 0.5f)];
+            else
+                data[i] = (unsigned char)(value * 255.0f + 0.5f);
+        }
+        _mipmaps.push_back(data);
+
+        src.swap(dst);
+        width = dstWidth;
+        height = dstHeight;
+    }
+}
+
+unsigned int Image::getMipmapCount() const
+{
+    return (unsigned int)_mipmaps.size() + 1;
+}
+
+unsigned char* Image::getMipmapData(unsigned int level) const
+{
+    GP_ASSERT(level <= _mipmaps.size());
+    return level == 0 ? _data : _mipmaps[level - 1];
 }
 
 }
@@ -6,10 +6,13 @@
 namespace gameplay
 {
 
+struct ImageDecoder;
+
 /**
  * Defines an image buffer of RGB or RGBA color data.
  *
- * Currently only supports loading from .png image files.
+ * Supports loading from .png and .qoi image files. QOI is a lossless format that decodes
+ * several times faster than PNG, which images can be converted to with saveQOI.
  */
 class Image : public Ref
 {
@@ -24,9 +27,21 @@ public:
         RGBA
     };
 
+    /**
+     * Defines the filters used to generate mipmaps.
+     */
+    enum MipmapFilter
+    {
+        MIPMAP_BOX,
+        MIPMAP_KAISER
+    };
+
     /**
      * Creates an image from the image file at the given path.
      *
+     * The file is read with a single read into a buffer that is reused by the images loaded
+     * on the same thread, and its rows are decoded directly into the image.
+     *
      * @param path The path to the image file.
      * @return The newly created image.
      * @script{create}
@@ -74,6 +89,52 @@ public:
      */
     inline unsigned int getWidth() const;
 
+    /**
+     * Generates the mipmap chain of the image, down to 1x1, replacing any previous one.
+     *
+     * Unlike Texture::generateMipmaps, this does not use GL, so it can run on a worker thread
+     * while the image is loaded, leaving only the upload to the game thread. Each level is
+     * filtered from the previous one in floating point.
+     *
+     * @param filter The filter: a 2x2 box, or a wider Kaiser windowed sinc that keeps more detail.
+     * @param sRGB true if the color channels hold sRGB values, which are then filtered in linear space.
+     * @param alphaCutoff If greater than zero, the alpha test reference value (between 0 and 1) whose
+     *      coverage is preserved in each level by scaling its alpha, so that alpha tested
+     *      content does not fade out in the distance.
+     */
+    void generateMipmaps(MipmapFilter filter = MIPMAP_BOX, bool sRGB = false, float alphaCutoff = 0.0f);
+
+    /**
+     * Gets the number of mipmap levels of the image, including the image itself.
+     *
+     * @return The number of levels, which is 1 until generateMipmaps is called.
+     */
+    unsigned int getMipmapCount() const;
+
+    /**
+     * Gets the pixel data of a mipmap level.
+     *
+     * Level 0 is the image itself, and each level is half the width and height of the
+     * previous one (but at least 1).
+     *
+     * @param level The mipmap level.
+     *
+     * @return The pixel data of the level.
+     * @script{ignore}
+     */
+    unsigned char* getMipmapData(unsigned int level) const;
+
+    /**
+     * Saves the image to a file in the QOI format.
+     *
+     * Mipmaps are not saved.
+     *
+     * @param path The path of the file to write.
+     *
+     * @return true if the file was written, false otherwise.
+     */
+    bool saveQOI(const char* path) const;
+
 private:
 
     /**
@@ -91,10 +152,15 @@ private:
      */
     Image& operator=(const Image&);
 
+    static Image* createPNG(const char* path, ImageDecoder& decoder);
+
+    static Image* createQOI(const char* path, const unsigned char* data, size_t size);
+
     unsigned char* _data;
     Format _format;
     unsigned int _width;
     unsigned int _height;
+    std::vector<unsigned char*> _mipmaps;
 };
 
 }
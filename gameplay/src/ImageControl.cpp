@@ -65,6 +65,7 @@ const char* ImageControl::getScriptClassName() const
 
 void ImageControl::setImage(const char* path)
 {
+    setDirty(DIRTY_GEOMETRY);
     SAFE_DELETE(_batch);
     Texture* texture = Texture::create(path);
     _batch = SpriteBatch::create(texture);
@@ -84,6 +85,7 @@ void ImageControl::setRegionSrc(float x, float y, float width, float height)
     _uvs.u2 = (x + width) * _tw;
     _uvs.v1 = 1.0f - (y * _th);
     _uvs.v2 = 1.0f - ((y + height) * _th);
+    setDirty(DIRTY_GEOMETRY);
 }
 
 void ImageControl::setRegionSrc(const Rectangle& region)
@@ -99,6 +101,7 @@ const Rectangle& ImageControl::getRegionSrc() const
 void ImageControl::setRegionDst(float x, float y, float width, float height)
 {
     _dstRegion.set(x, y, width, height);
+    setDirty(DIRTY_GEOMETRY);
 }
 
 void ImageControl::setRegionDst(const Rectangle& region)
@@ -0,0 +1,201 @@
+#include "Base.h"
+#include "ListContainer.h"
+
+// Default number of rows bound above and below the viewport.
+#define LIST_CONTAINER_DEFAULT_OVERSCAN 2
+
+namespace gameplay
+{
+
+ListContainer::ListContainer()
+    : _provider(NULL), _itemHeight(32.0f), _overscan(LIST_CONTAINER_DEFAULT_OVERSCAN), _firstItem(0), _itemsDirty(true)
+{
+}
+
+ListContainer::~ListContainer()
+{
+}
+
+ListContainer* ListContainer::create(const char* id, Theme::Style* style)
+{
+    ListContainer* list = new ListContainer();
+    list->_id = id ? id : "";
+    list->_layout = createLayout(Layout::LAYOUT_ABSOLUTE);
+    list->setScroll(SCROLL_VERTICAL);
+    if (style)
+        list->setStyle(style);
+    return list;
+}
+
+Control* ListContainer::create(Theme::Style* style, const char* id)
+{
+    return create(id, style);
+}
+
+const char* ListContainer::getScriptClassName() const
+{
+    return "ListContainer";
+}
+
+void ListContainer::setItemProvider(ItemProvider* provider)
+{
+    if (provider != _provider)
+    {
+        // The item controls were created by the previous provider, so they are not reused.
+        for (size_t i = 0, count = _items.size(); i < count; ++i)
+        {
+            removeControl(_items[i]);
+        }
+        for (size_t i = 0, count = _freeItems.size(); i < count; ++i)
+        {
+            removeControl(_freeItems[i]);
+        }
+        _items.clear();
+        _freeItems.clear();
+        _firstItem = 0;
+
+        _provider = provider;
+        refresh();
+    }
+}
+
+ListContainer::ItemProvider* ListContainer::getItemProvider() const
+{
+    return _provider;
+}
+
+void ListContainer::setItemHeight(float height)
+{
+    GP_ASSERT(height > 0.0f);
+
+    if (height != _itemHeight)
+    {
+        _itemHeight = height;
+        refresh();
+    }
+}
+
+float ListContainer::getItemHeight() const
+{
+    return _itemHeight;
+}
+
+void ListContainer::setOverscan(unsigned int rows)
+{
+    if (rows != _overscan)
+    {
+        _overscan = rows;
+        setDirty(DIRTY_BOUNDS);
+    }
+}
+
+unsigned int ListContainer::getOverscan() const
+{
+    return _overscan;
+}
+
+void ListContainer::refresh()
+{
+    _itemsDirty = true;
+    setDirty(DIRTY_BOUNDS);
+}
+
+unsigned int ListContainer::getFirstBoundItem() const
+{
+    return _firstItem;
+}
+
+unsigned int ListContainer::getBoundItemCount() const
+{
+    return (unsigned int)_items.size();
+}
+
+Control* ListContainer::getItemControl(unsigned int index) const
+{
+    if (index < _firstItem || index >= _firstItem + _items.size())
+        return NULL;
+    return _items[index - _firstItem];
+}
+
+void ListContainer::update(float elapsedTime)
+{
+    // Bind the rows for the current scroll position before the children are updated and laid out.
+    updateItems();
+
+    Container::update(elapsedTime);
+}
+
+void ListContainer::getContentSize(float* width, float* height) const
+{
+    Container::getContentSize(width, height);
+
+    // The content spans all of the items, not only the bound ones.
+    if (_provider)
+        *height = std::max(*height, _provider->getItemCount() * _itemHeight);
+}
+
+void ListContainer::updateItems()
+{
+    // Find the rows within the viewport, plus the overscan rows on each side.
+    unsigned int itemCount = _provider ? _provider->getItemCount() : 0;
+    float top = std::max(-_scrollPosition.y, 0.0f);
+    unsigned int first = (unsigned int)(top / _itemHeight);
+    unsigned int last = (unsigned int)ceilf((top + _viewportBounds.height) / _itemHeight) + _overscan;
+    first = first > _overscan ? first - _overscan : 0;
+    last = std::min(last, itemCount);
+    first = std::min(first, last);
+
+    if (!_itemsDirty && first == _firstItem && last == _firstItem + _items.size())
+        return;
+
+    // Keep the controls of the rows that are still in range and recycle the others.
+    std::vector<Control*> items(last - first, (Control*)NULL);
+    for (size_t i = 0, count = _items.size(); i < count; ++i)
+    {
+        unsigned int index = _firstItem + (unsigned int)i;
+        if (!_itemsDirty && index >= first && index < last)
+        {
+            items[index - first] = _items[i];
+        }
+        else
+        {
+            _items[i]->setVisible(false);
+            _freeItems.push_back(_items[i]);
+        }
+    }
+
+    // Bind controls to the rows that came into range.
+    for (unsigned int i = 0, count = (unsigned int)items.size(); i < count; ++i)
+    {
+        if (items[i])
+            continue;
+
+        Control* item;
+        if (_freeItems.empty())
+        {
+            item = _provider->createItem();
+            GP_ASSERT(item);
+            addControl(item);
+            item->release();
+        }
+        else
+        {
+            item = _freeItems.back();
+            _freeItems.pop_back();
+            item->setVisible(true);
+        }
+
+        item->setX(0.0f);
+        item->setY((first + i) * _itemHeight);
+        item->setWidth(1.0f, true);
+        item->setHeight(_itemHeight);
+        _provider->bindItem(item, first + i);
+        items[i] = item;
+    }
+
+    _items.swap(items);
+    _firstItem = first;
+    _itemsDirty = false;
+}
+
+}
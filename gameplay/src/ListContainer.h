@@ -0,0 +1,209 @@
+#ifndef LISTCONTAINER_H_
+#define LISTCONTAINER_H_
+
+#include "Container.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a vertically scrolling container that shows a list of items of equal height.
+ *
+ * Rather than holding a control for every item, a list container asks its item provider for
+ * the number of items and only keeps controls for the items within its viewport, plus a few
+ * rows above and below it. As the list scrolls, the controls of the rows that leave that range
+ * are bound to the items that enter it, so a list of thousands of items costs about as much to
+ * update and draw as a screenful of controls.
+ *
+ * Item controls are positioned by the list and stretched to its width; the scroll position,
+ * scrollbars and scrolling input behave as for any other scrolling container.
+ */
+class ListContainer : public Container
+{
+    friend class Container;
+    friend class ControlFactory;
+
+public:
+
+    /**
+     * Provides the items of a list container.
+     */
+    class ItemProvider
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~ItemProvider() { }
+
+        /**
+         * Gets the number of items in the list.
+         *
+         * @return The number of items.
+         */
+        virtual unsigned int getItemCount() = 0;
+
+        /**
+         * Creates a control that can show any item of the list.
+         *
+         * The list container takes ownership of the returned control.
+         *
+         * @return A new control.
+         */
+        virtual Control* createItem() = 0;
+
+        /**
+         * Binds a control created by createItem to an item, updating it to show that item.
+         *
+         * Controls are reused for different items as the list scrolls.
+         *
+         * @param item The control to bind.
+         * @param index The index of the item to show.
+         */
+        virtual void bindItem(Control* item, unsigned int index) = 0;
+    };
+
+    /**
+     * Creates a new list container.
+     *
+     * @param id The list container ID.
+     * @param style The list container style (optional).
+     *
+     * @return The new list container.
+     * @script{create}
+     */
+    static ListContainer* create(const char* id, Theme::Style* style = NULL);
+
+    /**
+     * Extends ScriptTarget::getScriptClassName() to return the type name of this class.
+     *
+     * @return The type name of this class: "ListContainer"
+     * @see ScriptTarget::getScriptClassName()
+     */
+    const char* getScriptClassName() const;
+
+    /**
+     * Sets the item provider of the list. The provider is not owned by the list.
+     *
+     * @param provider The item provider, or NULL to show no items.
+     */
+    void setItemProvider(ItemProvider* provider);
+
+    /**
+     * Gets the item provider of the list.
+     *
+     * @return The item provider.
+     */
+    ItemProvider* getItemProvider() const;
+
+    /**
+     * Sets the height of each item, in pixels.
+     *
+     * @param height The item height.
+     */
+    void setItemHeight(float height);
+
+    /**
+     * Gets the height of each item.
+     *
+     * @return The item height in pixels.
+     */
+    float getItemHeight() const;
+
+    /**
+     * Sets the number of rows kept above and below the viewport, so that scrolling does
+     * not reveal rows that are not bound yet.
+     *
+     * @param rows The number of extra rows on each side of the viewport.
+     */
+    void setOverscan(unsigned int rows);
+
+    /**
+     * Gets the number of rows kept above and below the viewport.
+     *
+     * @return The number of extra rows on each side of the viewport.
+     */
+    unsigned int getOverscan() const;
+
+    /**
+     * Binds all rows again, which must be called when the number of items or their content changes.
+     */
+    void refresh();
+
+    /**
+     * Gets the index of the first item that has a control bound to it.
+     *
+     * @return The index of the first bound item.
+     */
+    unsigned int getFirstBoundItem() const;
+
+    /**
+     * Gets the number of items that have a control bound to them.
+     *
+     * @return The number of bound items.
+     */
+    unsigned int getBoundItemCount() const;
+
+    /**
+     * Gets the control bound to an item.
+     *
+     * @param index The index of the item.
+     *
+     * @return The control bound to the item, or NULL if the item is not within the bound rows.
+     */
+    Control* getItemControl(unsigned int index) const;
+
+protected:
+
+    /**
+     * Constructor.
+     */
+    ListContainer();
+
+    /**
+     * Destructor.
+     */
+    virtual ~ListContainer();
+
+    /**
+     * Creates a new list container for the control factory.
+     *
+     * @param style The list container style.
+     * @param id The list container ID.
+     *
+     * @return The new list container.
+     */
+    static Control* create(Theme::Style* style, const char* id);
+
+    /**
+     * @see Control::update
+     */
+    void update(float elapsedTime);
+
+    /**
+     * @see Container::getContentSize
+     */
+    void getContentSize(float* width, float* height) const;
+
+private:
+
+    /**
+     * Constructor.
+     */
+    ListContainer(const ListContainer& copy);
+
+    void updateItems();
+
+    ItemProvider* _provider;
+    float _itemHeight;
+    unsigned int _overscan;
+    unsigned int _firstItem;
+    std::vector<Control*> _items;
+    std::vector<Control*> _freeItems;
+    bool _itemsDirty;
+};
+
+}
+
+#endif
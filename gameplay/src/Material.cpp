@@ -189,6 +189,39 @@ void Material::setNodeBinding(Node* node)
     }
 }
 
+bool Material::isEquivalent(const Material* material) const
+{
+    GP_ASSERT(material);
+
+    if (material == this)
+        return true;
+
+    if (_techniques.size() != material->_techniques.size() || !hasSameState(material))
+        return false;
+
+    for (size_t i = 0, count = _techniques.size(); i < count; ++i)
+    {
+        const Technique* technique = _techniques[i];
+        const Technique* other = material->_techniques[i];
+        GP_ASSERT(technique && other);
+        if ((technique == _currentTechnique) != (other == material->_currentTechnique))
+            return false;
+        if (technique->_id != other->_id || technique->_passes.size() != other->_passes.size() || !technique->hasSameState(other))
+            return false;
+
+        for (size_t j = 0, passCount = technique->_passes.size(); j < passCount; ++j)
+        {
+            const Pass* pass = technique->_passes[j];
+            const Pass* otherPass = other->_passes[j];
+            GP_ASSERT(pass && otherPass);
+            if (pass->_effect != otherPass->_effect || !pass->hasSameState(otherPass))
+                return false;
+        }
+    }
+
+    return true;
+}
+
 Material* Material::clone(NodeCloneContext &context) const
 {
     Material* material = new Material();
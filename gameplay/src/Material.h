@@ -25,6 +25,7 @@ class Material : public RenderState
     friend class RenderState;
     friend class Node;
     friend class Model;
+    friend class ModelBatch;
 
 public:
 
@@ -146,6 +147,19 @@ public:
      */
     void setNodeBinding(Node* node);
 
+    /**
+     * Determines if this material renders identically to the given material.
+     *
+     * Two materials are equivalent when their techniques and passes use the same
+     * effects, parameter values, auto-bindings and render states. Geometry drawn
+     * with equivalent materials can be merged and drawn with either one of them.
+     *
+     * @param material The material to compare with.
+     *
+     * @return true if the materials are equivalent, false otherwise.
+     */
+    bool isEquivalent(const Material* material) const;
+
     /**
      * @see Serializeable::getSerializedClassName
      */
@@ -5,16 +5,20 @@
 namespace gameplay
 {
 
+// Source of unique parameter value versions (zero is reserved for "unknown"). Parameters
+// may be set while drawables are recorded on several threads, so the counter is atomic.
+static std::atomic<unsigned int> __parameterVersion(0);
+
 MaterialParameter::MaterialParameter() :
     _type(MaterialParameter::NONE), _count(1), _dynamic(false), _name(""),
-    _uniform(NULL), _loggerDirtyBits(0)
+    _uniform(NULL), _version(0), _autoBinding(false), _loggerDirtyBits(0)
 {
     clearValue();
 }
 
 MaterialParameter::MaterialParameter(const char* name) :
     _type(MaterialParameter::NONE), _count(1), _dynamic(false), _name(name ? name : ""),
-    _uniform(NULL), _loggerDirtyBits(0)
+    _uniform(NULL), _version(0), _autoBinding(false), _loggerDirtyBits(0)
 {
     clearValue();
 }
@@ -86,6 +90,116 @@ void MaterialParameter::clearValue()
 
     memset(&_value, 0, sizeof(_value));
     _type = MaterialParameter::NONE;
+    setDirty();
+}
+
+void MaterialParameter::setDirty()
+{
+    unsigned int version = ++__parameterVersion;
+    if (version == 0)
+        version = ++__parameterVersion;
+    _version = version;
+}
+
+bool MaterialParameter::isVersioned() const
+{
+    switch (_type)
+    {
+    case MaterialParameter::FLOAT:
+    case MaterialParameter::INT:
+        return true;
+    case MaterialParameter::FLOAT_ARRAY:
+    case MaterialParameter::INT_ARRAY:
+    case MaterialParameter::VECTOR2:
+    case MaterialParameter::VECTOR3:
+    case MaterialParameter::VECTOR4:
+    case MaterialParameter::MATRIX:
+        return _dynamic;
+    default:
+        return false;
+    }
+}
+
+void MaterialParameter::setStoredValue(Type type, const float* values, unsigned int size)
+{
+    GP_ASSERT(values);
+
+    // Reuse our own storage when it already holds a value of this type.
+    if (_dynamic && _count == 1 && _type == type && _value.floatPtrValue != NULL)
+    {
+        if (memcmp(_value.floatPtrValue, values, sizeof(float) * size) == 0)
+            return;
+    }
+    else
+    {
+        clearValue();
+        _value.floatPtrValue = new float[size];
+        _dynamic = true;
+        _count = 1;
+        _type = type;
+    }
+
+    memcpy(_value.floatPtrValue, values, sizeof(float) * size);
+    setDirty();
+}
+
+bool MaterialParameter::isSameSampler(const Texture::Sampler* a, const Texture::Sampler* b)
+{
+    if (a == b)
+        return true;
+    if (a == NULL || b == NULL)
+        return false;
+    return a->_texture == b->_texture && a->_wrapS == b->_wrapS && a->_wrapT == b->_wrapT && a->_wrapR == b->_wrapR &&
+        a->_filterMin == b->_filterMin && a->_filterMag == b->_filterMag;
+}
+
+bool MaterialParameter::hasSameValue(const MaterialParameter* parameter) const
+{
+    GP_ASSERT(parameter);
+
+    if (_type != parameter->_type || _count != parameter->_count)
+        return false;
+
+    unsigned int components = 0;
+    switch (_type)
+    {
+    case MaterialParameter::NONE:
+        return true;
+    case MaterialParameter::FLOAT:
+        return _value.floatValue == parameter->_value.floatValue;
+    case MaterialParameter::INT:
+        return _value.intValue == parameter->_value.intValue;
+    case MaterialParameter::INT_ARRAY:
+        return memcmp(_value.intPtrValue, parameter->_value.intPtrValue, sizeof(int) * _count) == 0;
+    case MaterialParameter::FLOAT_ARRAY:
+        components = 1;
+        break;
+    case MaterialParameter::VECTOR2:
+        components = 2;
+        break;
+    case MaterialParameter::VECTOR3:
+        components = 3;
+        break;
+    case MaterialParameter::VECTOR4:
+        components = 4;
+        break;
+    case MaterialParameter::MATRIX:
+        components = 16;
+        break;
+    case MaterialParameter::SAMPLER:
+        return isSameSampler(_value.samplerValue, parameter->_value.samplerValue);
+    case MaterialParameter::SAMPLER_ARRAY:
+        for (unsigned int i = 0; i < _count; ++i)
+        {
+            if (!isSameSampler(_value.samplerArrayValue[i], parameter->_value.samplerArrayValue[i]))
+                return false;
+        }
+        return true;
+    case MaterialParameter::METHOD:
+        return _value.method == parameter->_value.method;
+    }
+
+    return memcmp(_value.floatPtrValue, parameter->_value.floatPtrValue, sizeof(float) * components * _count) == 0;
 }
 
 const char* MaterialParameter::getName() const
@@ -224,6 +338,7 @@ void MaterialParameter::setValue(const Matrix& value)
     _dynamic = true;
     _count = 1;
     _type = MaterialParameter::MATRIX;
+    setDirty();
 }
 
 void MaterialParameter::setValue(const Matrix* values, unsigned int count)
@@ -459,26 +574,21 @@ void MaterialParameter::setSamplerArray(const Texture::Sampler** values, unsigne
     _type = MaterialParameter::SAMPLER_ARRAY;
 }
 
-void MaterialParameter::bind(Effect* effect)
+void MaterialParameter::bind(Effect* effect, Uniform* uniform)
 {
     GP_ASSERT(effect);
 
-    // If we had a Uniform cached that is not from the passed in effect,
-    // we need to update our uniform to point to the new effect's uniform.
-    if (!_uniform || _uniform->getEffect() != effect)
+    // The uniform is resolved once per effect by the owning RenderState.
+    _uniform = uniform;
+    if (!_uniform)
     {
-        _uniform = effect->getUniform(_name.c_str());
-
-        if (!_uniform)
+        if ((_loggerDirtyBits & UNIFORM_NOT_FOUND) == 0)
         {
-            if ((_loggerDirtyBits & UNIFORM_NOT_FOUND) == 0)
-            {
-                // This parameter was not found in the specified effect, so do nothing.
-                GP_WARN("Material parameter for uniform '%s' not found in effect: '%s'.", _name.c_str(), effect->getId());
-                _loggerDirtyBits |= UNIFORM_NOT_FOUND;
-            }
-            return;
+            // This parameter was not found in the specified effect, so do nothing.
+            GP_WARN("Material parameter for uniform '%s' not found in effect: '%s'.", _name.c_str(), effect->getId());
+            _loggerDirtyBits |= UNIFORM_NOT_FOUND;
         }
+        return;
     }
 
     switch (_type)
@@ -752,6 +862,7 @@ void MaterialParameter::setAnimationPropertyValue(int propertyId, AnimationValue
                 default:
                     break;
             }
+            setDirty();
         }
         break;
     }
@@ -868,6 +979,7 @@ void MaterialParameter::deserialize(Serializer* serializer)
             break;
             
     }
+    setDirty();
 }
 
 Serializable* MaterialParameter::createInstance()
@@ -1040,7 +1152,7 @@ void MaterialParameter::cloneInto(MaterialParameter* materialParameter) const
 }
 
 MaterialParameter::MethodBinding::MethodBinding(MaterialParameter* param) :
-    _parameter(param), _autoBinding(false)
+    _parameter(param)
 {
 }
 
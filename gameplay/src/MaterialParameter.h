@@ -429,8 +429,6 @@ private:
      */
     class MethodBinding : public Ref
     {
-        friend class RenderState;
-
     public:
 
         virtual void setValue(Effect* effect) = 0;
@@ -453,7 +451,6 @@ private:
         MethodBinding& operator=(const MethodBinding&);
 
         MaterialParameter* _parameter;
-        bool _autoBinding;
     };
 
     /**
@@ -491,7 +488,47 @@ private:
 
     void clearValue();
 
-    void bind(Effect* effect);
+    /**
+     * Marks the value of this parameter as changed by assigning it a new, globally unique version.
+     */
+    void setDirty();
+
+    /**
+     * Returns true if this parameter owns its value, so that changes are tracked by its version.
+     *
+     * Values referenced through external pointers or method bindings may change at any
+     * time and are therefore always re-applied when bound.
+     */
+    bool isVersioned() const;
+
+    /**
+     * Copies a vector or matrix value into storage owned by this parameter, reusing the
+     * storage of the previous value when it has the same type and size.
+     *
+     * The version is only changed if the value differs from the one already stored, so
+     * per-frame values that did not change are not uploaded again.
+     *
+     * @param type The type of the value (VECTOR2, VECTOR3, VECTOR4 or MATRIX).
+     * @param values The float components of the value.
+     * @param size The number of float components.
+     */
+    void setStoredValue(Type type, const float* values, unsigned int size);
+
+    /**
+     * Determines if this parameter holds the same value as another parameter.
+     *
+     * Samplers are equal when they sample the same texture with the same states, and
+     * method bindings are only equal to themselves.
+     *
+     * @param parameter The parameter to compare with.
+     *
+     * @return true if both parameters have the same value, false otherwise.
+     */
+    bool hasSameValue(const MaterialParameter* parameter) const;
+
+    static bool isSameSampler(const Texture::Sampler* a, const Texture::Sampler* b);
+
+    void bind(Effect* effect, Uniform* uniform);
 
     void applyAnimationValue(AnimationValue* value, float blendWeight, int components);
 
@@ -525,6 +562,8 @@ private:
     bool _dynamic;
     std::string _name;
     Uniform* _uniform;
+    unsigned int _version;
+    bool _autoBinding;
     char _loggerDirtyBits;
 };
 
@@ -1,15 +1,27 @@
 #include "Base.h"
 #include "MeshBatch.h"
 #include "Material.h"
+#include "RenderCommandList.h"
 
 namespace gameplay
 {
 
+// Bytes uploaded by all mesh batches during the current and the last frame.
+static unsigned int __uploadedBytes = 0;
+static unsigned int __frameUploadedBytes = 0;
+
 MeshBatch::MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize)
     : _vertexFormat(vertexFormat), _primitiveType(primitiveType), _material(material), _indexed(indexed), _capacity(0), _growSize(growSize),
-    _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _vertices(NULL), _verticesPtr(NULL), _indices(NULL), _indicesPtr(NULL), _started(false)
+    _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _vertices(NULL), _verticesPtr(NULL), _indices(NULL), _indicesPtr(NULL),
+    _vertexBuffer(0), _indexBuffer(0), _vertexBufferSize(0), _indexBufferSize(0), _uploaded(false), _started(false)
 {
+    GL_ASSERT( glGenBuffers(1, &_vertexBuffer) );
+    if (_indexed)
+    {
+        GL_ASSERT( glGenBuffers(1, &_indexBuffer) );
+    }
     resize(initialCapacity);
+    updateVertexAttributeBinding();
 }
 
 MeshBatch::~MeshBatch()
@@ -17,6 +29,16 @@ MeshBatch::~MeshBatch()
     SAFE_RELEASE(_material);
     SAFE_DELETE_ARRAY(_vertices);
     SAFE_DELETE_ARRAY(_indices);
+    if (_vertexBuffer)
+    {
+        GL_ASSERT( glDeleteBuffers(1, &_vertexBuffer) );
+        _vertexBuffer = 0;
+    }
+    if (_indexBuffer)
+    {
+        GL_ASSERT( glDeleteBuffers(1, &_indexBuffer) );
+        _indexBuffer = 0;
+    }
 }
 
 MeshBatch* MeshBatch::create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, const char* materialPath, bool indexed, unsigned int initialCapacity, unsigned int growSize)
@@ -57,7 +79,12 @@ void MeshBatch::add(const void* vertices, size_t size, unsigned int vertexCount,
     {
         if (_growSize == 0)
             return; // growing disabled, just clip batch
-        if (!resize(_capacity + _growSize))
+
+        // Grow geometrically, unless that exceeds the range of the indices.
+        unsigned int capacity = std::max(_capacity * 2, _capacity + _growSize);
+        if (_indexed && computeVertexCapacity(capacity) > USHRT_MAX)
+            capacity = _capacity + _growSize;
+        if (!resize(capacity))
             return; // failed to grow
     }
     
@@ -116,7 +143,7 @@ void MeshBatch::updateVertexAttributeBinding()
         {
             Pass* p = t->getPassByIndex(j);
             GP_ASSERT(p);
-            VertexAttributeBinding* b = VertexAttributeBinding::create(_vertexFormat, _vertices, p->getEffect());
+            VertexAttributeBinding* b = VertexAttributeBinding::create(_vertexFormat, _vertexBuffer, p->getEffect());
             p->setVertexAttributeBinding(b);
             SAFE_RELEASE(b);
         }
@@ -133,6 +160,25 @@ void MeshBatch::setCapacity(unsigned int capacity)
     resize(capacity);
 }
 
+unsigned int MeshBatch::computeVertexCapacity(unsigned int capacity) const
+{
+    switch (_primitiveType)
+    {
+    case Mesh::LINES:
+        return capacity * 2;
+    case Mesh::LINE_STRIP:
+        return capacity + 1;
+    case Mesh::POINTS:
+        return capacity;
+    case Mesh::TRIANGLES:
+        return capacity * 3;
+    case Mesh::TRIANGLE_STRIP:
+        return capacity + 2;
+    default:
+        return 0;
+    }
+}
+
 bool MeshBatch::resize(unsigned int capacity)
 {
     if (capacity == 0)
@@ -148,25 +194,9 @@ bool MeshBatch::resize(unsigned int capacity)
     unsigned char* oldVertices = _vertices;
     unsigned short* oldIndices = _indices;
 
-    unsigned int vertexCapacity = 0;
-    switch (_primitiveType)
+    unsigned int vertexCapacity = computeVertexCapacity(capacity);
+    if (vertexCapacity == 0)
     {
-    case Mesh::LINES:
-        vertexCapacity = capacity * 2;
-        break;
-    case Mesh::LINE_STRIP:
-        vertexCapacity = capacity + 1;
-        break;
-    case Mesh::POINTS:
-        vertexCapacity = capacity;
-        break;
-    case Mesh::TRIANGLES:
-        vertexCapacity = capacity * 3;
-        break;
-    case Mesh::TRIANGLE_STRIP:
-        vertexCapacity = capacity + 2;
-        break;
-    default:
         GP_ERROR("Unsupported primitive type for mesh batch (%d).", _primitiveType);
         return false;
     }
@@ -189,21 +219,22 @@ bool MeshBatch::resize(unsigned int capacity)
         voffset = vBytes - 1;
     _verticesPtr = _vertices + voffset;
 
+    unsigned int ioffset = 0;
     if (_indexed)
     {
-        unsigned int ioffset = _indicesPtr - _indices;
+        ioffset = _indicesPtr - _indices;
         _indices = new unsigned short[indexCapacity];
         if (ioffset >= indexCapacity)
             ioffset = indexCapacity - 1;
         _indicesPtr = _indices + ioffset;
     }
 
-    // Copy old data back in
+    // Copy the data added so far back in
     if (oldVertices)
-        memcpy(_vertices, oldVertices, std::min(_vertexCapacity, vertexCapacity) * _vertexFormat.getVertexSize());
+        memcpy(_vertices, oldVertices, voffset);
     SAFE_DELETE_ARRAY(oldVertices);
     if (oldIndices)
-        memcpy(_indices, oldIndices, std::min(_indexCapacity, indexCapacity) * sizeof(unsigned short));
+        memcpy(_indices, oldIndices, ioffset * sizeof(unsigned short));
     SAFE_DELETE_ARRAY(oldIndices);
 
     // Assign new capacities
@@ -211,9 +242,6 @@ bool MeshBatch::resize(unsigned int capacity)
     _vertexCapacity = vertexCapacity;
     _indexCapacity = indexCapacity;
 
-    // Update our vertex attribute bindings now that our client array pointers have changed
-    updateVertexAttributeBinding();
-
     return true;
 }
 
@@ -228,6 +256,7 @@ void MeshBatch::start()
     _indexCount = 0;
     _verticesPtr = _vertices;
     _indicesPtr = _indices;
+    _uploaded = false;
     _started = true;
 }
 
@@ -243,16 +272,24 @@ void MeshBatch::finish()
 
 void MeshBatch::draw()
 {
+    record(RenderCommandList::getImmediate());
+}
+
+void MeshBatch::record(RenderCommandList* list)
+{
+    GP_ASSERT(list);
+
     if (_vertexCount == 0 || (_indexed && _indexCount == 0))
         return; // nothing to draw
 
-    // Not using VBOs, so unbind the element array buffer.
-    // ARRAY_BUFFER will be unbound automatically during pass->bind().
-    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0 ) );
+    // Upload the batch when the list is executed, since recording must not call the graphics API.
+    if (!_uploaded)
+    {
+        list->drawCallback(&uploadCallback, this);
+        _uploaded = true;
+    }
 
     GP_ASSERT(_material);
-    if (_indexed)
-        GP_ASSERT(_indices);
 
     // Bind the material.
     Technique* technique = _material->getTechnique();
@@ -262,20 +299,63 @@ void MeshBatch::draw()
     {
         Pass* pass = technique->getPassByIndex(i);
         GP_ASSERT(pass);
-        pass->bind();
+        list->bindPass(pass);
+        list->bindIndexBuffer(_indexBuffer);
 
         if (_indexed)
         {
-            GL_ASSERT( glDrawElements(_primitiveType, _indexCount, GL_UNSIGNED_SHORT, (GLvoid*)_indices) );
+            list->drawElements(_primitiveType, _indexCount, Mesh::INDEX16);
         }
         else
         {
-            GL_ASSERT( glDrawArrays(_primitiveType, 0, _vertexCount) );
+            list->drawArrays(_primitiveType, 0, _vertexCount);
         }
 
-        pass->unbind();
+        list->unbindPass(pass);
     }
 }
+
+void MeshBatch::upload()
+{
+    // Orphan the previous contents of the buffers rather than waiting for the draw calls that use them.
+    unsigned int vBytes = _vertexCount * _vertexFormat.getVertexSize();
+    if (vBytes > _vertexBufferSize)
+        _vertexBufferSize = _vertexCapacity * _vertexFormat.getVertexSize();
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer) );
+    GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, _vertexBufferSize, NULL, GL_STREAM_DRAW) );
+    GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, 0, vBytes, _vertices) );
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+    __uploadedBytes += vBytes;
+
+    if (_indexed)
+    {
+        unsigned int iBytes = _indexCount * sizeof(unsigned short);
+        if (iBytes > _indexBufferSize)
+            _indexBufferSize = _indexCapacity * sizeof(unsigned short);
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer) );
+        GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indexBufferSize, NULL, GL_STREAM_DRAW) );
+        GL_ASSERT( glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, iBytes, _indices) );
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+        __uploadedBytes += iBytes;
+    }
+}
+
+unsigned int MeshBatch::uploadCallback(void* cookie, bool wireframe)
+{
+    static_cast<MeshBatch*>(cookie)->upload();
+    return 0;
+}
+
+unsigned int MeshBatch::getUploadedBytes()
+{
+    return __frameUploadedBytes;
+}
+
+void MeshBatch::frameEnded()
+{
+    __frameUploadedBytes = __uploadedBytes;
+    __uploadedBytes = 0;
+}
     
 
 }
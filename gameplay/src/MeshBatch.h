@@ -7,12 +7,20 @@ namespace gameplay
 {
 
 class Material;
+class RenderCommandList;
 
 /**
  * Defines a class for rendering multiple mesh into a single draw call on the graphics device.
+ *
+ * The primitives added to the batch are collected in client memory and streamed into
+ * vertex and index buffers owned by the batch when it is drawn. Each upload orphans the
+ * previous contents of the buffers, so the driver does not have to wait for pending draw
+ * calls that still read them and the batch can be refilled and drawn several times per frame.
  */
 class MeshBatch
 {
+    friend class Game;
+
 public:
 
     /**
@@ -23,7 +31,8 @@ public:
      * @param materialPath Path to a material file to be used for drawing the batch.
      * @param indexed True if the batched primitives will contain index data, false otherwise.
      * @param initialCapacity The initial capacity of the batch, in triangles.
-     * @param growSize Amount to grow the batch by when it overflows (a value of zero prevents batch growing).
+     * @param growSize Minimum amount to grow the batch by when it overflows (a value of zero prevents batch growing).
+     *      The batch grows by at least its current capacity, so that filling it takes a logarithmic number of resizes.
      *
      * @return A new mesh batch.
      * @script{create}
@@ -38,7 +47,8 @@ public:
      * @param material Material to be used for drawing the batch.
      * @param indexed True if the batched primitives will contain index data, false otherwise.
      * @param initialCapacity The initial capacity of the batch, in triangles.
-     * @param growSize Amount to grow the batch by when it overflows (a value of zero prevents batch growing).
+     * @param growSize Minimum amount to grow the batch by when it overflows (a value of zero prevents batch growing).
+     *      The batch grows by at least its current capacity, so that filling it takes a logarithmic number of resizes.
      *
      * @return A new mesh batch.
      * @script{create}
@@ -141,6 +151,23 @@ public:
      */
     void draw();
 
+    /**
+     * Records the commands that draw the primitives currently in batch into a command list.
+     *
+     * The primitives are uploaded to the batch's buffers when the list is executed, so the
+     * batch must not be changed until the list has been executed.
+     *
+     * @param list The command list to record into.
+     */
+    void record(RenderCommandList* list);
+
+    /**
+     * Gets the number of bytes of vertex and index data uploaded by all mesh batches during the last frame.
+     *
+     * @return The number of bytes uploaded.
+     */
+    static unsigned int getUploadedBytes();
+
 private:
 
     /**
@@ -162,8 +189,16 @@ private:
 
     void updateVertexAttributeBinding();
 
+    unsigned int computeVertexCapacity(unsigned int capacity) const;
+
     bool resize(unsigned int capacity);
 
+    void upload();
+
+    static unsigned int uploadCallback(void* cookie, bool wireframe);
+
+    static void frameEnded();
+
     const VertexFormat _vertexFormat;
     Mesh::PrimitiveType _primitiveType;
     Material* _material;
@@ -178,6 +213,11 @@ private:
     unsigned char* _verticesPtr;
     unsigned short* _indices;
     unsigned short* _indicesPtr;
+    VertexBufferHandle _vertexBuffer;
+    IndexBufferHandle _indexBuffer;
+    unsigned int _vertexBufferSize;
+    unsigned int _indexBufferSize;
+    bool _uploaded;
     bool _started;
 
 };
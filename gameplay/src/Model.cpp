@@ -5,6 +5,7 @@
 #include "Technique.h"
 #include "Pass.h"
 #include "Node.h"
+#include "RenderCommandList.h"
 
 namespace gameplay
 {
@@ -250,7 +251,7 @@ void Model::setNode(Node* node)
     }
 }
 
-static bool drawWireframe(Mesh* mesh)
+static bool recordWireframe(RenderCommandList* list, Mesh* mesh)
 {
     switch (mesh->getPrimitiveType())
     {
@@ -259,7 +260,7 @@ static bool drawWireframe(Mesh* mesh)
             unsigned int vertexCount = mesh->getVertexCount();
             for (unsigned int i = 0; i < vertexCount; i += 3)
             {
-                GL_ASSERT( glDrawArrays(GL_LINE_LOOP, i, 3) );
+                list->drawArrays((Mesh::PrimitiveType)GL_LINE_LOOP, i, 3);
             }
         }
         return true;
@@ -269,7 +270,7 @@ static bool drawWireframe(Mesh* mesh)
             unsigned int vertexCount = mesh->getVertexCount();
             for (unsigned int i = 2; i < vertexCount; ++i)
             {
-                GL_ASSERT( glDrawArrays(GL_LINE_LOOP, i-2, 3) );
+                list->drawArrays((Mesh::PrimitiveType)GL_LINE_LOOP, i-2, 3);
             }
         }
         return true;
@@ -280,7 +281,7 @@ static bool drawWireframe(Mesh* mesh)
     }
 }
 
-static bool drawWireframe(MeshPart* part)
+static bool recordWireframe(RenderCommandList* list, MeshPart* part)
 {
     unsigned int indexCount = part->getIndexCount();
     unsigned int indexSize = 0;
@@ -306,7 +307,7 @@ static bool drawWireframe(MeshPart* part)
         {
             for (size_t i = 0; i < indexCount; i += 3)
             {
-                GL_ASSERT( glDrawElements(GL_LINE_LOOP, 3, part->getIndexFormat(), ((const GLvoid*)(i*indexSize))) );
+                list->drawElements((Mesh::PrimitiveType)GL_LINE_LOOP, 3, part->getIndexFormat(), ((const GLvoid*)(i*indexSize)));
             }
         }
         return true;
@@ -315,7 +316,7 @@ static bool drawWireframe(MeshPart* part)
         {
             for (size_t i = 2; i < indexCount; ++i)
             {
-                GL_ASSERT( glDrawElements(GL_LINE_LOOP, 3, part->getIndexFormat(), ((const GLvoid*)((i-2)*indexSize))) );
+                list->drawElements((Mesh::PrimitiveType)GL_LINE_LOOP, 3, part->getIndexFormat(), ((const GLvoid*)((i-2)*indexSize)));
             }
         }
         return true;
@@ -327,8 +328,14 @@ static bool drawWireframe(MeshPart* part)
 }
 
 unsigned int Model::draw(bool wireframe)
+{
+    return record(RenderCommandList::getImmediate(), wireframe);
+}
+
+unsigned int Model::record(RenderCommandList* list, bool wireframe)
 {
     GP_ASSERT(_mesh);
+    GP_ASSERT(list);
 
     unsigned int partCount = _mesh->getPartCount();
     if (partCount == 0)
@@ -343,13 +350,13 @@ unsigned int Model::draw(bool wireframe)
             {
                 Pass* pass = technique->getPassByIndex(i);
                 GP_ASSERT(pass);
-                pass->bind();
-                GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
-                if (!wireframe || !drawWireframe(_mesh))
+                list->bindPass(pass);
+                list->bindIndexBuffer(0);
+                if (!wireframe || !recordWireframe(list, _mesh))
                 {
-                    GL_ASSERT( glDrawArrays(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount()) );
+                    list->drawArrays(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount());
                 }
-                pass->unbind();
+                list->unbindPass(pass);
             }
         }
     }
@@ -371,13 +378,13 @@ unsigned int Model::draw(bool wireframe)
                 {
                     Pass* pass = technique->getPassByIndex(j);
                     GP_ASSERT(pass);
-                    pass->bind();
-                    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->_indexBuffer) );
-                    if (!wireframe || !drawWireframe(part))
+                    list->bindPass(pass);
+                    list->bindIndexBuffer(part->_indexBuffer);
+                    if (!wireframe || !recordWireframe(list, part))
                     {
-                        GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0) );
+                        list->drawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat());
                     }
-                    pass->unbind();
+                    list->unbindPass(pass);
                 }
             }
         }
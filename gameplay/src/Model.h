@@ -142,6 +142,13 @@ public:
      */
     unsigned int draw(bool wireframe = false);
 
+    /**
+     * Records the commands that draw the mesh into a command list.
+     *
+     * @see Drawable::record
+     */
+    unsigned int record(RenderCommandList* list, bool wireframe = false);
+
     /**
      * @see Serializeable::getSerializedClassName
      */
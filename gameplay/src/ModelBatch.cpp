@@ -0,0 +1,323 @@
+#include "Base.h"
+#include "ModelBatch.h"
+#include "MeshPart.h"
+#include "MeshSkin.h"
+#include "Material.h"
+#include "Technique.h"
+#include "Pass.h"
+#include "Node.h"
+#include "VertexAttributeBinding.h"
+
+namespace gameplay
+{
+
+static const VertexFormat::Element __instanceElements[] =
+{
+    VertexFormat::Element(VertexFormat::INSTANCE_MATRIX, 16),
+    VertexFormat::Element(VertexFormat::INSTANCE_PARAMETER, 4)
+};
+
+ModelBatch::ModelBatch()
+    : _instanceFormat(__instanceElements, 2), _instanceBuffer(0), _instanceBufferSize(0), _instancedCount(0), _started(false)
+{
+}
+
+ModelBatch::~ModelBatch()
+{
+    for (size_t i = 0, count = _groups.size(); i < count; ++i)
+    {
+        Group* group = _groups[i];
+        for (size_t j = 0, bindingCount = group->bindings.size(); j < bindingCount; ++j)
+        {
+            SAFE_RELEASE(group->bindings[j].vaBinding);
+        }
+        SAFE_RELEASE(group->mesh);
+        SAFE_RELEASE(group->material);
+        SAFE_DELETE(group);
+    }
+    if (_instanceBuffer)
+    {
+        GL_ASSERT( glDeleteBuffers(1, &_instanceBuffer) );
+        _instanceBuffer = 0;
+    }
+}
+
+ModelBatch* ModelBatch::create()
+{
+    return new ModelBatch();
+}
+
+bool ModelBatch::isInstancingSupported()
+{
+#ifdef GP_USE_INSTANCING
+    return glVertexAttribDivisor && glDrawElementsInstanced && glDrawArraysInstanced;
+#else
+    return false;
+#endif
+}
+
+void ModelBatch::start()
+{
+    _models.clear();
+
+    // Keep the groups (and their vertex attribute bindings) used last time for reuse,
+    // and release those that were not drawn.
+    for (size_t i = 0; i < _groups.size(); )
+    {
+        Group* group = _groups[i];
+        if (group->models.empty())
+        {
+            for (size_t j = 0, bindingCount = group->bindings.size(); j < bindingCount; ++j)
+            {
+                SAFE_RELEASE(group->bindings[j].vaBinding);
+            }
+            SAFE_RELEASE(group->mesh);
+            SAFE_RELEASE(group->material);
+            SAFE_DELETE(group);
+            _groups.erase(_groups.begin() + i);
+        }
+        else
+        {
+            group->models.clear();
+            group->instanceData.clear();
+            ++i;
+        }
+    }
+
+    _started = true;
+}
+
+void ModelBatch::add(Model* model, const Vector4& parameter)
+{
+    GP_ASSERT(_started);
+    GP_ASSERT(model);
+
+    _models.push_back(model);
+
+    // Skinned models are drawn individually.
+    Node* node = model->getNode();
+    if (node == NULL || model->getSkin())
+        return;
+
+    Mesh* mesh = model->getMesh();
+    GP_ASSERT(mesh);
+    unsigned int partCount = mesh->getPartCount();
+    for (int i = partCount > 0 ? 0 : -1; i < (int)partCount; ++i)
+    {
+        Material* material = model->getMaterial(i);
+        if (material == NULL)
+            continue;
+
+        Group* group = getGroup(mesh, i, material);
+        group->models.push_back(model);
+
+        const Matrix& world = node->getWorldMatrix();
+        group->instanceData.insert(group->instanceData.end(), world.m, world.m + 16);
+        group->instanceData.push_back(parameter.x);
+        group->instanceData.push_back(parameter.y);
+        group->instanceData.push_back(parameter.z);
+        group->instanceData.push_back(parameter.w);
+    }
+}
+
+unsigned int ModelBatch::finish(bool wireframe)
+{
+    GP_ASSERT(_started);
+    _started = false;
+    _instancedCount = 0;
+
+    unsigned int drawCalls = 0;
+    if (wireframe)
+    {
+        // Wireframe drawing is done per primitive, so there is nothing to batch.
+        for (size_t i = 0, count = _models.size(); i < count; ++i)
+        {
+            drawCalls += _models[i]->draw(true);
+        }
+        return drawCalls;
+    }
+
+    bool instancing = isInstancingSupported();
+    for (size_t i = 0, count = _groups.size(); i < count; ++i)
+    {
+        Group* group = _groups[i];
+        if (group->models.empty())
+            continue;
+
+        if (instancing && group->models.size() > 1)
+            drawCalls += drawInstanced(group);
+        else
+            drawCalls += drawSequential(group);
+    }
+
+    // Draw the models that could not be batched.
+    for (size_t i = 0, count = _models.size(); i < count; ++i)
+    {
+        Model* model = _models[i];
+        if (model->getNode() == NULL || model->getSkin())
+        {
+            drawCalls += model->draw();
+        }
+    }
+
+    return drawCalls;
+}
+
+unsigned int ModelBatch::getInstancedCount() const
+{
+    return _instancedCount;
+}
+
+ModelBatch::Group* ModelBatch::getGroup(Mesh* mesh, int partIndex, Material* material)
+{
+    for (size_t i = 0, count = _groups.size(); i < count; ++i)
+    {
+        Group* group = _groups[i];
+        // Models with equivalent materials render identically, so they are drawn together
+        // even when each one has its own copy of the material.
+        if (group->mesh == mesh && group->partIndex == partIndex && group->material->isEquivalent(material))
+            return group;
+    }
+
+    Group* group = new Group();
+    group->mesh = mesh;
+    group->partIndex = partIndex;
+    mesh->addRef();
+
+    // The group draws with its own copy of the material, so the materials of the models are
+    // never rebound to the nodes of other models.
+    NodeCloneContext context;
+    group->material = material->clone(context);
+    _groups.push_back(group);
+    return group;
+}
+
+VertexAttributeBinding* ModelBatch::getBinding(Group* group, Effect* effect)
+{
+    for (size_t i = 0, count = group->bindings.size(); i < count; ++i)
+    {
+        if (group->bindings[i].effect == effect)
+            return group->bindings[i].vaBinding;
+    }
+
+    // Only effects that read the per-instance world matrix can be drawn instanced.
+    VertexAttributeBinding* vaBinding = NULL;
+    if (effect->getVertexAttribute(VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME) != -1)
+    {
+        if (_instanceBuffer == 0)
+        {
+            GL_ASSERT( glGenBuffers(1, &_instanceBuffer) );
+        }
+        vaBinding = VertexAttributeBinding::create(group->mesh, effect, _instanceFormat, _instanceBuffer);
+    }
+
+    Binding binding;
+    binding.effect = effect;
+    binding.vaBinding = vaBinding;
+    group->bindings.push_back(binding);
+    return vaBinding;
+}
+
+unsigned int ModelBatch::drawInstanced(Group* group)
+{
+    Technique* technique = group->material->getTechnique();
+    GP_ASSERT(technique);
+    unsigned int passCount = technique->getPassCount();
+
+    // Every pass must read the instance data, otherwise the group is drawn without instancing.
+    for (unsigned int i = 0; i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        GP_ASSERT(pass);
+        if (getBinding(group, pass->getEffect()) == NULL)
+            return drawSequential(group);
+    }
+
+    // Upload the instance data, orphaning the previous contents of the buffer.
+    unsigned int instanceCount = (unsigned int)group->models.size();
+    unsigned int size = (unsigned int)(group->instanceData.size() * sizeof(float));
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer) );
+    if (size > _instanceBufferSize)
+    {
+        GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, size, &group->instanceData[0], GL_DYNAMIC_DRAW) );
+        _instanceBufferSize = size;
+    }
+    else
+    {
+        GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, _instanceBufferSize, NULL, GL_DYNAMIC_DRAW) );
+        GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, 0, size, &group->instanceData[0]) );
+    }
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+
+    // The world matrices come from the instance data, so any node of the group can be bound
+    // for the auto-bindings of the material.
+    group->material->setNodeBinding(group->models[0]->getNode());
+
+    MeshPart* part = group->partIndex >= 0 ? group->mesh->getPart(group->partIndex) : NULL;
+    for (unsigned int i = 0; i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        VertexAttributeBinding* vaBinding = getBinding(group, pass->getEffect());
+        pass->bind();
+        vaBinding->bind();
+#ifdef GP_USE_INSTANCING
+        if (part)
+        {
+            GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->getIndexBuffer()) );
+            GL_ASSERT( glDrawElementsInstanced(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0, instanceCount) );
+        }
+        else
+        {
+            GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+            GL_ASSERT( glDrawArraysInstanced(group->mesh->getPrimitiveType(), 0, group->mesh->getVertexCount(), instanceCount) );
+        }
+#endif
+        vaBinding->unbind();
+        pass->unbind();
+    }
+    group->material->setNodeBinding(NULL);
+
+    _instancedCount += instanceCount;
+    return passCount;
+}
+
+unsigned int ModelBatch::drawSequential(Group* group)
+{
+    Technique* technique = group->material->getTechnique();
+    GP_ASSERT(technique);
+    unsigned int passCount = technique->getPassCount();
+
+    // The models are drawn with the material of the group, which is equivalent to their own.
+    // Rebinding it to the node of the next model only swaps the node that its resolved
+    // auto-bindings are evaluated for, so binding the pass again only uploads the uniforms
+    // that depend on the node.
+    MeshPart* part = group->partIndex >= 0 ? group->mesh->getPart(group->partIndex) : NULL;
+    unsigned int modelCount = (unsigned int)group->models.size();
+    for (unsigned int i = 0; i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        GP_ASSERT(pass);
+        for (unsigned int j = 0; j < modelCount; ++j)
+        {
+            group->material->setNodeBinding(group->models[j]->getNode());
+            pass->bind();
+            GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part ? part->getIndexBuffer() : 0) );
+            if (part)
+            {
+                GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0) );
+            }
+            else
+            {
+                GL_ASSERT( glDrawArrays(group->mesh->getPrimitiveType(), 0, group->mesh->getVertexCount()) );
+            }
+        }
+        pass->unbind();
+    }
+
+    // The nodes may be deleted before the group is drawn again.
+    group->material->setNodeBinding(NULL);
+
+    return passCount * modelCount;
+}
+
+}
@@ -0,0 +1,153 @@
+#ifndef MODELBATCH_H_
+#define MODELBATCH_H_
+
+#include "Model.h"
+#include "VertexFormat.h"
+#include "Vector4.h"
+
+namespace gameplay
+{
+
+class VertexAttributeBinding;
+
+/**
+ * Defines a class for drawing many models that share a mesh and material with
+ * as few draw calls as possible.
+ *
+ * Models added to the batch are grouped by mesh, mesh part and equivalent material
+ * (see Material::isEquivalent), so models with copies of the same material are merged. Each group
+ * is drawn with a single instanced draw call per pass, with the world matrix and an
+ * optional parameter of every model stored in a dynamic instance buffer.
+ *
+ * Instanced drawing requires hardware support and a pass effect that declares the
+ * a_instanceMatrix vertex attribute. The built-in shaders declare it (and read
+ * u_viewProjectionMatrix instead of the per-node matrices) when the INSTANCING
+ * define is set, so a material only needs to add INSTANCING to its defines and
+ * auto-bind u_viewProjectionMatrix (and u_viewMatrix when lit). Models whose pass
+ * cannot be instanced are drawn one after another with the program and vertex
+ * attributes bound once for the group, so only their per-node uniforms are uploaded.
+ *
+ * Skinned models are always drawn individually.
+ *
+ * @code
+ * _batch->start();
+ * scene->visit(this, &MyGame::batchNode); // calls _batch->add(model) for each visible model
+ * _batch->finish();
+ * @endcode
+ */
+class ModelBatch
+{
+public:
+
+    /**
+     * Creates a new model batch.
+     *
+     * @return A new model batch.
+     * @script{create}
+     */
+    static ModelBatch* create();
+
+    /**
+     * Destructor.
+     */
+    ~ModelBatch();
+
+    /**
+     * Determines if instanced drawing is supported by the graphics device.
+     *
+     * @return true if instanced drawing is supported, false otherwise.
+     */
+    static bool isInstancingSupported();
+
+    /**
+     * Starts batching.
+     *
+     * This method should be called before calling add() to add models to the batch.
+     */
+    void start();
+
+    /**
+     * Adds a model to the batch.
+     *
+     * The model must remain valid until finish() is called.
+     *
+     * @param model The model to draw.
+     * @param parameter A per-instance parameter, bound to the a_instanceParameter attribute.
+     */
+    void add(Model* model, const Vector4& parameter = Vector4::zero());
+
+    /**
+     * Draws all of the models added to the batch since the last call to start().
+     *
+     * @param wireframe true to draw the models as wireframe (which disables instancing).
+     *
+     * @return The number of draw calls issued.
+     */
+    unsigned int finish(bool wireframe = false);
+
+    /**
+     * Gets the number of models drawn with instanced draw calls by the last call to finish().
+     *
+     * @return The number of instanced models.
+     */
+    unsigned int getInstancedCount() const;
+
+private:
+
+    /**
+     * The instance binding of a group for one pass effect.
+     */
+    struct Binding
+    {
+        Effect* effect;
+        VertexAttributeBinding* vaBinding;
+    };
+
+    /**
+     * The models sharing a mesh, mesh part and equivalent material.
+     */
+    struct Group
+    {
+        Mesh* mesh;
+        int partIndex;
+        Material* material;
+        std::vector<Model*> models;
+        std::vector<float> instanceData;
+        std::vector<Binding> bindings;
+    };
+
+    /**
+     * Constructor.
+     */
+    ModelBatch();
+
+    /**
+     * Constructor.
+     */
+    ModelBatch(const ModelBatch& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    ModelBatch& operator=(const ModelBatch&);
+
+    Group* getGroup(Mesh* mesh, int partIndex, Material* material);
+
+    VertexAttributeBinding* getBinding(Group* group, Effect* effect);
+
+    unsigned int drawInstanced(Group* group);
+
+    unsigned int drawSequential(Group* group);
+
+    VertexFormat _instanceFormat;
+    VertexBufferHandle _instanceBuffer;
+    unsigned int _instanceBufferSize;
+    std::vector<Group*> _groups;
+    std::vector<Model*> _models;
+    unsigned int _instancedCount;
+    bool _started;
+};
+
+}
+
+#endif
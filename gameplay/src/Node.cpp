@@ -23,7 +23,7 @@
 namespace gameplay
 {
 
-Node::Node() : _scene(NULL), _id(""), _firstChild(NULL), _nextSibling(NULL), _prevSibling(NULL), _parent(NULL), _childCount(0), _enabled(true), _tags(NULL),
+Node::Node() : _scene(NULL), _id(""), _firstChild(NULL), _nextSibling(NULL), _prevSibling(NULL), _parent(NULL), _childCount(0), _enabled(true), _static(false), _tags(NULL),
     _drawable(NULL), _camera(NULL), _light(NULL), _collisionObject(NULL), _audioSource(NULL),
     _agent(NULL), _userObject(NULL), _dirtyBits(NODE_DIRTY_ALL)
 {
@@ -32,7 +32,7 @@ Node::Node() : _scene(NULL), _id(""), _firstChild(NULL), _nextSibling(NULL), _pr
     
 Node::Node(const char* id) :
     _scene(NULL), _id(id ? id : ""), _firstChild(NULL), _nextSibling(NULL), _prevSibling(NULL), _parent(NULL),
-    _childCount(0), _enabled(true), _tags(NULL),
+    _childCount(0), _enabled(true), _static(false), _tags(NULL),
     _drawable(NULL), _camera(NULL), _light(NULL), _collisionObject(NULL), _audioSource(NULL),
     _agent(NULL), _userObject(NULL), _dirtyBits(NODE_DIRTY_ALL)
 {
@@ -429,7 +429,12 @@ void Node::update(float elapsedTime)
 
 bool Node::isStatic() const
 {
-    return (_collisionObject && _collisionObject->isStatic());
+    return _static || (_collisionObject && _collisionObject->isStatic());
+}
+
+void Node::setStatic(bool value)
+{
+    _static = value;
 }
 
 const Matrix& Node::getWorldMatrix() const
@@ -975,6 +980,7 @@ void Node::cloneInto(Node* node, NodeCloneContext& context) const
     GP_ASSERT(node);
 
     Transform::cloneInto(node, context);
+    node->_static = _static;
 
     if (Drawable* drawable = getDrawable())
     {
@@ -1239,6 +1245,7 @@ void Node::serialize(Serializer* serializer)
     serializer->writeVector("translate", translation, Vector3::zero());
     serializer->writeVector("rotate", Vector4(rotation.x, rotation.y, rotation.z, rotation.w), Vector4::zero());
     serializer->writeVector("scale", scale, Vector3::one());
+    serializer->writeBool("static", _static, false);
     
     if (_drawable)
     {
@@ -1276,6 +1283,8 @@ void Node::deserialize(Serializer* serializer)
     setRotation(rotation);
     Vector3 scale = serializer->readVector("scale", Vector3::one());
     setScale(scale);
+    if (serializer->hasPropertiesOfVersion(4, 1))
+        _static = serializer->readBool("static", false);
     Serializable* drawable = serializer->readObject("drawable");
     Model* model = dynamic_cast<Model*>(drawable);
     if (model)
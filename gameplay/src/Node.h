@@ -247,7 +247,8 @@ public:
     /**
      * Returns whether the transformation of this node is static.
      *
-     * Nodes that have static rigid bodies attached to them are considered static.
+     * Nodes that have been flagged static with setStatic() or that have static
+     * rigid bodies attached to them are considered static.
      *
      * @return True if the transformation of this Node is static, false otherwise.
      *
@@ -255,6 +256,17 @@ public:
      */
     bool isStatic() const;
 
+    /**
+     * Flags the transformation of this node as static.
+     *
+     * The transformation of a static node can no longer be changed: its Transform
+     * setters are ignored until the node is flagged non-static again. This allows the
+     * geometry of static nodes to be merged by the StaticBatcher.
+     *
+     * @param value true to flag the node as static, false otherwise.
+     */
+    void setStatic(bool value);
+
     /**
      * Gets the world matrix corresponding to this node.
      *
@@ -741,6 +753,8 @@ protected:
     unsigned int _childCount;
     /** If this node is enabled. Maybe different if parent is enabled/disabled. */
     bool _enabled; 
+    /** If this node has been flagged static. */
+    bool _static;
     /** Tags assigned to this node. */
     std::map<std::string, std::string>* _tags;
     /** The drawble component attached to this node. */
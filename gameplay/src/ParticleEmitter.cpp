@@ -4,17 +4,96 @@
 #include "Node.h"
 #include "Scene.h"
 #include "Quaternion.h"
+#include "RenderCommandList.h"
+#include "TextureAtlas.h"
 
 #define PARTICLE_COUNT_MAX                       100
 #define PARTICLE_EMISSION_RATE                   10
 #define PARTICLE_EMISSION_RATE_TIME_INTERVAL     1000.0f / (float)PARTICLE_EMISSION_RATE
 #define PARTICLE_UPDATE_RATE_MAX                 8
+#define PARTICLE_SIMD_WIDTH                      4
+
+#if defined(GP_USE_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PARTICLE_USE_SSE
+#include <xmmintrin.h>
+#endif
 
 namespace gameplay
 {
 
+// dst[i] += scalar
+static void addStream(float* dst, float scalar, unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(GP_USE_NEON)
+    float32x4_t s = vdupq_n_f32(scalar);
+    for (; i + 4 <= count; i += 4)
+        vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), s));
+#elif defined(PARTICLE_USE_SSE)
+    __m128 s = _mm_set1_ps(scalar);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), s));
+#endif
+    for (; i < count; ++i)
+        dst[i] += scalar;
+}
+
+// dst[i] += src[i] * scalar
+static void integrateStream(float* dst, const float* src, float scalar, unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(GP_USE_NEON)
+    float32x4_t s = vdupq_n_f32(scalar);
+    for (; i + 4 <= count; i += 4)
+        vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i), vld1q_f32(src + i), s));
+#elif defined(PARTICLE_USE_SSE)
+    __m128 s = _mm_set1_ps(scalar);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), s)));
+#endif
+    for (; i < count; ++i)
+        dst[i] += src[i] * scalar;
+}
+
+// dst[i] = 1 - energy[i] / energyStart[i]
+static void percentStream(float* dst, const float* energy, const float* energyStart, unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(PARTICLE_USE_SSE)
+    __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dst + i, _mm_sub_ps(one, _mm_div_ps(_mm_loadu_ps(energy + i), _mm_loadu_ps(energyStart + i))));
+#endif
+    // ARMv7 NEON has no exact division, so this is left to the compiler.
+    for (; i < count; ++i)
+        dst[i] = 1.0f - energy[i] / energyStart[i];
+}
+
+// dst[i] = start[i] + (end[i] - start[i]) * t[i]
+static void lerpStream(float* dst, const float* start, const float* end, const float* t, unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(GP_USE_NEON)
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t a = vld1q_f32(start + i);
+        vst1q_f32(dst + i, vmlaq_f32(a, vsubq_f32(vld1q_f32(end + i), a), vld1q_f32(t + i)));
+    }
+#elif defined(PARTICLE_USE_SSE)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(start + i);
+        _mm_storeu_ps(dst + i, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(end + i), a), _mm_loadu_ps(t + i))));
+    }
+#endif
+    for (; i < count; ++i)
+        dst[i] = start[i] + (end[i] - start[i]) * t[i];
+}
+
 ParticleEmitter::ParticleEmitter(unsigned int particleCountMax) : Drawable(),
-    _particleCountMax(particleCountMax), _particleCount(0), _particles(NULL),
+    _particleCountMax(particleCountMax), _particleCount(0), _particleData(NULL), _particlePercent(NULL), _particleFrames(NULL),
     _emissionRate(PARTICLE_EMISSION_RATE), _started(false), _ellipsoid(false),
     _sizeStartMin(1.0f), _sizeStartMax(1.0f), _sizeEndMin(1.0f), _sizeEndMax(1.0f),
     _energyMin(1000L), _energyMax(1000L),
@@ -28,21 +107,45 @@ ParticleEmitter::ParticleEmitter(unsigned int particleCountMax) : Drawable(),
     _spriteBatch(NULL), _spriteBlendMode(BLEND_ALPHA),  _spriteTextureWidth(0), _spriteTextureHeight(0), _spriteTextureWidthRatio(0), _spriteTextureHeightRatio(0), _spriteTextureCoords(NULL),
     _spriteAnimated(false),  _spriteLooped(false), _spriteFrameCount(1), _spriteFrameRandomOffset(0),_spriteFrameDuration(0L), _spriteFrameDurationSecs(0.0f), _spritePercentPerFrame(0.0f),
     _orbitPosition(false), _orbitVelocity(false), _orbitAcceleration(false),
-    _timePerEmission(PARTICLE_EMISSION_RATE_TIME_INTERVAL), _emitTime(0), _lastUpdated(0)
+    _timePerEmission(PARTICLE_EMISSION_RATE_TIME_INTERVAL), _emitTime(0), _runningTime(0), _randomSeed(0), _randomState(0),
+    _depthSorted(false), _emissionScale(1.0f)
 {
     GP_ASSERT(particleCountMax);
-    _particles = new Particle[particleCountMax];
+
+    // Allocate every stream from one block, padding each to a multiple of the SIMD width.
+    unsigned int stride = (particleCountMax + PARTICLE_SIMD_WIDTH - 1) & ~(PARTICLE_SIMD_WIDTH - 1);
+    _particleData = new float[stride * (STREAM_COUNT + 1)];
+    memset(_particleData, 0, stride * (STREAM_COUNT + 1) * sizeof(float));
+    for (unsigned int i = 0; i < STREAM_COUNT; ++i)
+    {
+        _particleStreams[i] = _particleData + i * stride;
+    }
+    _particlePercent = _particleData + STREAM_COUNT * stride;
+    _particleFrames = new unsigned int[particleCountMax];
+
+    setRandomSeed((unsigned int)rand());
 }
 
 ParticleEmitter::~ParticleEmitter()
 {
     SAFE_DELETE(_spriteBatch);
-    SAFE_DELETE_ARRAY(_particles);
+    SAFE_DELETE_ARRAY(_particleData);
+    SAFE_DELETE_ARRAY(_particleFrames);
     SAFE_DELETE_ARRAY(_spriteTextureCoords);
 }
 
 ParticleEmitter* ParticleEmitter::create(const char* textureFile, BlendMode blendMode, unsigned int particleCountMax)
 {
+    // Draw the particles from an atlas page when the image was packed into a registered atlas.
+    Texture* atlasTexture = NULL;
+    Rectangle region;
+    if (TextureAtlas::lookup(textureFile, &atlasTexture, &region))
+    {
+        ParticleEmitter* emitter = new ParticleEmitter(particleCountMax);
+        emitter->setTexture(atlasTexture, blendMode, region);
+        return emitter;
+    }
+
     Texture* texture = Texture::create(textureFile, true);
 
     if (!texture)
@@ -205,6 +308,14 @@ ParticleEmitter* ParticleEmitter::create(const char* url)
 
 void ParticleEmitter::setTexture(const char* texturePath, BlendMode blendMode)
 {
+    Texture* atlasTexture = NULL;
+    Rectangle region;
+    if (TextureAtlas::lookup(texturePath, &atlasTexture, &region))
+    {
+        setTexture(atlasTexture, blendMode, region);
+        return;
+    }
+
     Texture* texture = Texture::create(texturePath, true);
     if (texture)
     {
@@ -218,6 +329,11 @@ void ParticleEmitter::setTexture(const char* texturePath, BlendMode blendMode)
 }
 
 void ParticleEmitter::setTexture(Texture* texture, BlendMode blendMode)
+{
+    setTexture(texture, blendMode, Rectangle((float)texture->getWidth(), (float)texture->getHeight()));
+}
+
+void ParticleEmitter::setTexture(Texture* texture, BlendMode blendMode, const Rectangle& region)
 {
     // Create new batch before releasing old one, in case the same texture
     // is used for both (so it's not released before passing to the new batch).
@@ -236,9 +352,10 @@ void ParticleEmitter::setTexture(Texture* texture, BlendMode blendMode)
     _spriteTextureHeight = texture->getHeight();
     _spriteTextureWidthRatio = 1.0f / (float)texture->getWidth();
     _spriteTextureHeightRatio = 1.0f / (float)texture->getHeight();
+    _spriteImageRegion = region;
 
-    // By default assume only one frame which uses the entire texture.
-    Rectangle texCoord((float)texture->getWidth(), (float)texture->getHeight());
+    // By default assume only one frame which uses the entire image.
+    Rectangle texCoord(region.width, region.height);
     setSpriteFrameCoords(1, &texCoord);
 }
 
@@ -273,7 +390,7 @@ void ParticleEmitter::setEmissionRate(unsigned int rate)
 void ParticleEmitter::start()
 {
     _started = true;
-    _lastUpdated = 0;
+    _runningTime = 0;
 }
 
 void ParticleEmitter::stop()
@@ -300,7 +417,7 @@ bool ParticleEmitter::isActive() const
 void ParticleEmitter::emitOnce(unsigned int particleCount)
 {
     GP_ASSERT(_node);
-    GP_ASSERT(_particles);
+    GP_ASSERT(_particleData);
 
     // Limit particleCount so as not to go over _particleCountMax.
     if (particleCount + _particleCount > _particleCountMax)
@@ -318,63 +435,96 @@ void ParticleEmitter::emitOnce(unsigned int particleCount)
     world.m[14] = 0.0f;
 
     // Emit the new particles.
+    float** streams = _particleStreams;
     for (unsigned int i = 0; i < particleCount; i++)
     {
-        Particle* p = &_particles[_particleCount];
+        unsigned int p = _particleCount;
 
-        generateColor(_colorStart, _colorStartVar, &p->_colorStart);
-        generateColor(_colorEnd, _colorEndVar, &p->_colorEnd);
-        p->_color.set(p->_colorStart);
+        Vector4 colorStart;
+        Vector4 colorEnd;
+        generateColor(_colorStart, _colorStartVar, &colorStart);
+        generateColor(_colorEnd, _colorEndVar, &colorEnd);
 
-        p->_energy = p->_energyStart = generateScalar(_energyMin, _energyMax);
-        p->_size = p->_sizeStart = generateScalar(_sizeStartMin, _sizeStartMax);
-        p->_sizeEnd = generateScalar(_sizeEndMin, _sizeEndMax);
-        p->_rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
-        p->_angle = generateScalar(0.0f, p->_rotationPerParticleSpeed);
-        p->_rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
+        float energy = generateScalar(_energyMin, _energyMax);
+        float sizeStart = generateScalar(_sizeStartMin, _sizeStartMax);
+        float sizeEnd = generateScalar(_sizeEndMin, _sizeEndMax);
+        float rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
+        float angle = generateScalar(0.0f, rotationPerParticleSpeed);
+        float rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
 
         // Only initial position can be generated within an ellipsoidal domain.
-        generateVector(_position, _positionVar, &p->_position, _ellipsoid);
-        generateVector(_velocity, _velocityVar, &p->_velocity, false);
-        generateVector(_acceleration, _accelerationVar, &p->_acceleration, false);
-        generateVector(_rotationAxis, _rotationAxisVar, &p->_rotationAxis, false);
+        Vector3 position;
+        Vector3 velocity;
+        Vector3 acceleration;
+        Vector3 rotationAxis;
+        generateVector(_position, _positionVar, &position, _ellipsoid);
+        generateVector(_velocity, _velocityVar, &velocity, false);
+        generateVector(_acceleration, _accelerationVar, &acceleration, false);
+        generateVector(_rotationAxis, _rotationAxisVar, &rotationAxis, false);
 
         // Initial position, velocity and acceleration can all be relative to the emitter's transform.
         // Rotate specified properties by the node's rotation.
         if (_orbitPosition)
         {
-            world.transformPoint(p->_position, &p->_position);
+            world.transformPoint(position, &position);
         }
 
         if (_orbitVelocity)
         {
-            world.transformPoint(p->_velocity, &p->_velocity);
+            world.transformPoint(velocity, &velocity);
         }
 
         if (_orbitAcceleration)
         {
-            world.transformPoint(p->_acceleration, &p->_acceleration);
+            world.transformPoint(acceleration, &acceleration);
         }
 
         // The rotation axis always orbits the node.
-        if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
+        if (rotationSpeed != 0.0f && !rotationAxis.isZero())
         {
-            world.transformPoint(p->_rotationAxis, &p->_rotationAxis);
+            world.transformPoint(rotationAxis, &rotationAxis);
         }
 
         // Translate position relative to the node's world space.
-        p->_position.add(translation);
+        position.add(translation);
+
+        streams[STREAM_POSITION_X][p] = position.x;
+        streams[STREAM_POSITION_Y][p] = position.y;
+        streams[STREAM_POSITION_Z][p] = position.z;
+        streams[STREAM_VELOCITY_X][p] = velocity.x;
+        streams[STREAM_VELOCITY_Y][p] = velocity.y;
+        streams[STREAM_VELOCITY_Z][p] = velocity.z;
+        streams[STREAM_ACCELERATION_X][p] = acceleration.x;
+        streams[STREAM_ACCELERATION_Y][p] = acceleration.y;
+        streams[STREAM_ACCELERATION_Z][p] = acceleration.z;
+        streams[STREAM_COLOR_START_R][p] = streams[STREAM_COLOR_R][p] = colorStart.x;
+        streams[STREAM_COLOR_START_G][p] = streams[STREAM_COLOR_G][p] = colorStart.y;
+        streams[STREAM_COLOR_START_B][p] = streams[STREAM_COLOR_B][p] = colorStart.z;
+        streams[STREAM_COLOR_START_A][p] = streams[STREAM_COLOR_A][p] = colorStart.w;
+        streams[STREAM_COLOR_END_R][p] = colorEnd.x;
+        streams[STREAM_COLOR_END_G][p] = colorEnd.y;
+        streams[STREAM_COLOR_END_B][p] = colorEnd.z;
+        streams[STREAM_COLOR_END_A][p] = colorEnd.w;
+        streams[STREAM_ROTATION_PER_PARTICLE_SPEED][p] = rotationPerParticleSpeed;
+        streams[STREAM_ROTATION_AXIS_X][p] = rotationAxis.x;
+        streams[STREAM_ROTATION_AXIS_Y][p] = rotationAxis.y;
+        streams[STREAM_ROTATION_AXIS_Z][p] = rotationAxis.z;
+        streams[STREAM_ROTATION_SPEED][p] = rotationSpeed;
+        streams[STREAM_ANGLE][p] = angle;
+        streams[STREAM_ENERGY_START][p] = streams[STREAM_ENERGY][p] = energy;
+        streams[STREAM_SIZE_START][p] = streams[STREAM_SIZE][p] = sizeStart;
+        streams[STREAM_SIZE_END][p] = sizeEnd;
 
         // Initial sprite frame.
         if (_spriteFrameRandomOffset > 0)
         {
-            p->_frame = rand() % _spriteFrameRandomOffset;
+            _particleFrames[p] = generateRandom() % _spriteFrameRandomOffset;
         }
         else
         {
-            p->_frame = 0;
+            _particleFrames[p] = 0;
         }
-        p->_timeOnCurrentFrame = 0.0f;
+        streams[STREAM_TIME_ON_CURRENT_FRAME][p] = 0.0f;
 
         ++_particleCount;
     }
@@ -659,7 +809,17 @@ void ParticleEmitter::setSpriteTexCoords(unsigned int frameCount, float* texCoor
 
     SAFE_DELETE_ARRAY(_spriteTextureCoords);
     _spriteTextureCoords = new float[frameCount * 4];
-    memcpy(_spriteTextureCoords, texCoords, frameCount * 4 * sizeof(float));
+
+    // Map the coordinates from the image into its region of the texture.
+    float scaleU = _spriteImageRegion.width * _spriteTextureWidthRatio;
+    float scaleV = _spriteImageRegion.height * _spriteTextureHeightRatio;
+    float offsetU = _spriteImageRegion.x * _spriteTextureWidthRatio;
+    float offsetV = 1.0f - scaleV - _spriteImageRegion.y * _spriteTextureHeightRatio;
+    for (unsigned int i = 0; i < frameCount * 4; i += 2)
+    {
+        _spriteTextureCoords[i] = offsetU + scaleU * texCoords[i];
+        _spriteTextureCoords[i + 1] = offsetV + scaleV * texCoords[i + 1];
+    }
 }
 
 void ParticleEmitter::setSpriteFrameCoords(unsigned int frameCount, Rectangle* frameCoords)
@@ -676,8 +836,8 @@ void ParticleEmitter::setSpriteFrameCoords(unsigned int frameCount, Rectangle* f
     // Pre-compute texture coordinates from rects.
     for (unsigned int i = 0; i < frameCount; i++)
     {
-        _spriteTextureCoords[i*4] = _spriteTextureWidthRatio * frameCoords[i].x;
-        _spriteTextureCoords[i*4 + 1] = 1.0f - _spriteTextureHeightRatio * frameCoords[i].y;
+        _spriteTextureCoords[i*4] = _spriteTextureWidthRatio * (_spriteImageRegion.x + frameCoords[i].x);
+        _spriteTextureCoords[i*4 + 1] = 1.0f - _spriteTextureHeightRatio * (_spriteImageRegion.y + frameCoords[i].y);
         _spriteTextureCoords[i*4 + 2] = _spriteTextureCoords[i*4] + _spriteTextureWidthRatio * frameCoords[i].width;
         _spriteTextureCoords[i*4 + 3] = _spriteTextureCoords[i*4 + 1] - _spriteTextureHeightRatio * frameCoords[i].height;
     }
@@ -689,8 +849,8 @@ void ParticleEmitter::setSpriteFrameCoords(unsigned int frameCount, int width, i
     GP_ASSERT(height);
 
     Rectangle* frameCoords = new Rectangle[frameCount];
-    unsigned int cols = _spriteTextureWidth / width;
-    unsigned int rows = _spriteTextureHeight / height;
+    unsigned int cols = (unsigned int)_spriteImageRegion.width / width;
+    unsigned int rows = (unsigned int)_spriteImageRegion.height / height;
 
     unsigned int n = 0;
     for (unsigned int i = 0; i < rows; ++i)
@@ -744,26 +904,52 @@ bool ParticleEmitter::getOrbitAcceleration() const
     return _orbitAcceleration;
 }
 
-long ParticleEmitter::generateScalar(long min, long max)
+void ParticleEmitter::setRandomSeed(unsigned int seed)
 {
-    // Note: this is not a very good RNG, but it should be suitable for our purposes.
-    long r = 0;
-    for (unsigned int i = 0; i < sizeof(long)/sizeof(int); i++)
-    {
-        r = r << 8; // sizeof(int) * CHAR_BITS
-        r |= rand();
-    }
+    _randomSeed = seed;
+    _randomState = seed ? seed : 0x9E3779B9;
+}
+
+unsigned int ParticleEmitter::getRandomSeed() const
+{
+    return _randomSeed;
+}
+
+void ParticleEmitter::setDepthSorted(bool sorted)
+{
+    _depthSorted = sorted;
+}
+
+bool ParticleEmitter::isDepthSorted() const
+{
+    return _depthSorted;
+}
+
+unsigned int ParticleEmitter::generateRandom()
+{
+    // Marsaglia's xorshift32, which is fast and only touches this emitter's state.
+    unsigned int x = _randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    _randomState = x;
+    return x;
+}
 
-    // Now we have a random long between 0 and MAX_LONG.  We need to clamp it between min and max.
-    r %= max - min;
-    r += min;
+float ParticleEmitter::generateRandom01()
+{
+    // Use the top 24 bits, which a float represents exactly.
+    return (float)(generateRandom() >> 8) * (1.0f / 16777216.0f);
+}
 
-    return r;
+float ParticleEmitter::generateRandomMinus1To1()
+{
+    return generateRandom01() * 2.0f - 1.0f;
 }
 
 float ParticleEmitter::generateScalar(float min, float max)
 {
-    return min + (max - min) * MATH_RANDOM_0_1();
+    return min + (max - min) * generateRandom01();
 }
 
 void ParticleEmitter::generateVectorInRect(const Vector3& base, const Vector3& variance, Vector3* dst)
@@ -772,9 +958,9 @@ void ParticleEmitter::generateVectorInRect(const Vector3& base, const Vector3& v
 
     // Scale each component of the variance vector by a random float
     // between -1 and 1, then add this to the corresponding base component.
-    dst->x = base.x + variance.x * MATH_RANDOM_MINUS1_1();
-    dst->y = base.y + variance.y * MATH_RANDOM_MINUS1_1();
-    dst->z = base.z + variance.z * MATH_RANDOM_MINUS1_1();
+    dst->x = base.x + variance.x * generateRandomMinus1To1();
+    dst->y = base.y + variance.y * generateRandomMinus1To1();
+    dst->z = base.z + variance.z * generateRandomMinus1To1();
 }
 
 void ParticleEmitter::generateVectorInEllipsoid(const Vector3& center, const Vector3& scale, Vector3* dst)
@@ -784,9 +970,9 @@ void ParticleEmitter::generateVectorInEllipsoid(const Vector3& center, const Vec
     // Generate a point within a unit cube, then reject if the point is not in a unit sphere.
     do
     {
-        dst->x = MATH_RANDOM_MINUS1_1();
-        dst->y = MATH_RANDOM_MINUS1_1();
-        dst->z = MATH_RANDOM_MINUS1_1();
+        dst->x = generateRandomMinus1To1();
+        dst->y = generateRandomMinus1To1();
+        dst->z = generateRandomMinus1To1();
     } while (dst->length() > 1.0f);
     
     // Scale this point by the scaling vector.
@@ -816,10 +1002,10 @@ void ParticleEmitter::generateColor(const Vector4& base, const Vector4& variance
 
     // Scale each component of the variance color by a random float
     // between -1 and 1, then add this to the corresponding base component.
-    dst->x = base.x + variance.x * MATH_RANDOM_MINUS1_1();
-    dst->y = base.y + variance.y * MATH_RANDOM_MINUS1_1();
-    dst->z = base.z + variance.z * MATH_RANDOM_MINUS1_1();
-    dst->w = base.w + variance.w * MATH_RANDOM_MINUS1_1();
+    dst->x = base.x + variance.x * generateRandomMinus1To1();
+    dst->y = base.y + variance.y * generateRandomMinus1To1();
+    dst->z = base.z + variance.z * generateRandomMinus1To1();
+    dst->w = base.w + variance.w * generateRandomMinus1To1();
 }
 
 ParticleEmitter::BlendMode ParticleEmitter::getBlendModeFromString(const char* str)
@@ -864,20 +1050,20 @@ void ParticleEmitter::update(float elapsedTime)
     // Cap particle updates at a maximum rate. This saves processing
     // and also improves precision since updating with very small
     // time increments is more lossy.
-    static double runningTime = 0;
-    runningTime += elapsedTime;
-    if (runningTime < PARTICLE_UPDATE_RATE_MAX)
-        return;    
+    _runningTime += elapsedTime;
+    if (_runningTime < PARTICLE_UPDATE_RATE_MAX)
+        return;
 
-    float elapsedMs = runningTime;
-    runningTime = 0;
+    float elapsedMs = (float)_runningTime;
+    _runningTime = 0;
 
     float elapsedSecs = elapsedMs * 0.001f;
 
     if (_started && _emissionRate)
     {
         // Calculate how much time has passed since we last emitted particles.
-        _emitTime += elapsedMs; //+= elapsedTime;
+        // The emission scale is lowered by a ParticleSystem to keep within its particle budget.
+        _emitTime += elapsedMs * _emissionScale;
 
         // How many particles should we emit this frame?
         GP_ASSERT(_timePerEmission);
@@ -893,101 +1079,151 @@ void ParticleEmitter::update(float elapsedTime)
         }
     }
 
-    // Now update all currently living particles.
-    GP_ASSERT(_particles);
-    for (unsigned int particlesIndex = 0; particlesIndex < _particleCount; ++particlesIndex)
-    {
-        Particle* p = &_particles[particlesIndex];
-        p->_energy -= elapsedMs;
+    // Now update all currently living particles, one stream at a time. Particles that die
+    // during this update are updated too and removed afterwards.
+    GP_ASSERT(_particleData);
+    unsigned int count = _particleCount;
+    float** streams = _particleStreams;
+
+    addStream(streams[STREAM_ENERGY], -elapsedMs, count);
 
-        if (p->_energy > 0L)
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        float rotationSpeed = streams[STREAM_ROTATION_SPEED][i];
+        if (rotationSpeed != 0.0f)
         {
-            if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
+            Vector3 axis(streams[STREAM_ROTATION_AXIS_X][i], streams[STREAM_ROTATION_AXIS_Y][i], streams[STREAM_ROTATION_AXIS_Z][i]);
+            if (!axis.isZero())
             {
-                Matrix::createRotation(p->_rotationAxis, p->_rotationSpeed * elapsedSecs, &_rotation);
-
-                _rotation.transformPoint(p->_velocity, &p->_velocity);
-                _rotation.transformPoint(p->_acceleration, &p->_acceleration);
+                Matrix::createRotation(axis, rotationSpeed * elapsedSecs, &_rotation);
+
+                Vector3 velocity(streams[STREAM_VELOCITY_X][i], streams[STREAM_VELOCITY_Y][i], streams[STREAM_VELOCITY_Z][i]);
+                Vector3 acceleration(streams[STREAM_ACCELERATION_X][i], streams[STREAM_ACCELERATION_Y][i], streams[STREAM_ACCELERATION_Z][i]);
+                _rotation.transformPoint(&velocity);
+                _rotation.transformPoint(&acceleration);
+                streams[STREAM_VELOCITY_X][i] = velocity.x;
+                streams[STREAM_VELOCITY_Y][i] = velocity.y;
+                streams[STREAM_VELOCITY_Z][i] = velocity.z;
+                streams[STREAM_ACCELERATION_X][i] = acceleration.x;
+                streams[STREAM_ACCELERATION_Y][i] = acceleration.y;
+                streams[STREAM_ACCELERATION_Z][i] = acceleration.z;
             }
+        }
+    }
 
-            // Particle is still alive.
-            p->_velocity.x += p->_acceleration.x * elapsedSecs;
-            p->_velocity.y += p->_acceleration.y * elapsedSecs;
-            p->_velocity.z += p->_acceleration.z * elapsedSecs;
-
-            p->_position.x += p->_velocity.x * elapsedSecs;
-            p->_position.y += p->_velocity.y * elapsedSecs;
-            p->_position.z += p->_velocity.z * elapsedSecs;
-
-            p->_angle += p->_rotationPerParticleSpeed * elapsedSecs;
+    integrateStream(streams[STREAM_VELOCITY_X], streams[STREAM_ACCELERATION_X], elapsedSecs, count);
+    integrateStream(streams[STREAM_VELOCITY_Y], streams[STREAM_ACCELERATION_Y], elapsedSecs, count);
+    integrateStream(streams[STREAM_VELOCITY_Z], streams[STREAM_ACCELERATION_Z], elapsedSecs, count);
 
-            // Simple linear interpolation of color and size.
-            float percent = 1.0f - ((float)p->_energy / (float)p->_energyStart);
+    integrateStream(streams[STREAM_POSITION_X], streams[STREAM_VELOCITY_X], elapsedSecs, count);
+    integrateStream(streams[STREAM_POSITION_Y], streams[STREAM_VELOCITY_Y], elapsedSecs, count);
+    integrateStream(streams[STREAM_POSITION_Z], streams[STREAM_VELOCITY_Z], elapsedSecs, count);
 
-            p->_color.x = p->_colorStart.x + (p->_colorEnd.x - p->_colorStart.x) * percent;
-            p->_color.y = p->_colorStart.y + (p->_colorEnd.y - p->_colorStart.y) * percent;
-            p->_color.z = p->_colorStart.z + (p->_colorEnd.z - p->_colorStart.z) * percent;
-            p->_color.w = p->_colorStart.w + (p->_colorEnd.w - p->_colorStart.w) * percent;
+    integrateStream(streams[STREAM_ANGLE], streams[STREAM_ROTATION_PER_PARTICLE_SPEED], elapsedSecs, count);
 
-            p->_size = p->_sizeStart + (p->_sizeEnd - p->_sizeStart) * percent;
+    // Simple linear interpolation of color and size.
+    float* percent = _particlePercent;
+    percentStream(percent, streams[STREAM_ENERGY], streams[STREAM_ENERGY_START], count);
+    lerpStream(streams[STREAM_COLOR_R], streams[STREAM_COLOR_START_R], streams[STREAM_COLOR_END_R], percent, count);
+    lerpStream(streams[STREAM_COLOR_G], streams[STREAM_COLOR_START_G], streams[STREAM_COLOR_END_G], percent, count);
+    lerpStream(streams[STREAM_COLOR_B], streams[STREAM_COLOR_START_B], streams[STREAM_COLOR_END_B], percent, count);
+    lerpStream(streams[STREAM_COLOR_A], streams[STREAM_COLOR_START_A], streams[STREAM_COLOR_END_A], percent, count);
+    lerpStream(streams[STREAM_SIZE], streams[STREAM_SIZE_START], streams[STREAM_SIZE_END], percent, count);
 
-            // Handle sprite animations.
-            if (_spriteAnimated)
+    // Handle sprite animations.
+    if (_spriteAnimated)
+    {
+        unsigned int* frames = _particleFrames;
+        float* timeOnCurrentFrame = streams[STREAM_TIME_ON_CURRENT_FRAME];
+        unsigned int lastFrame = _spriteFrameCount - 1;
+        if (!_spriteLooped)
+        {
+            // The last frame should finish exactly when the particle dies.
+            float percentPerFrame = _spritePercentPerFrame;
+            for (unsigned int i = 0; i < count; ++i)
             {
-                if (!_spriteLooped)
-                {
-                    // The last frame should finish exactly when the particle dies.
-                    float percentSpent = 0.0f;
-                    for (unsigned int i = 0; i < p->_frame; i++)
-                    {
-                        percentSpent += _spritePercentPerFrame;
-                    }
-                    p->_timeOnCurrentFrame = percent - percentSpent;
-                    if (p->_frame < _spriteFrameCount - 1 &&
-                        p->_timeOnCurrentFrame >= _spritePercentPerFrame)
-                    {
-                        ++p->_frame;
-                    }
-                }
-                else
-                {
-                    // _spriteFrameDurationSecs is an absolute time measured in seconds,
-                    // and the animation repeats indefinitely.
-                    p->_timeOnCurrentFrame += elapsedSecs;
-                    if (p->_timeOnCurrentFrame >= _spriteFrameDurationSecs)
-                    {
-                        p->_timeOnCurrentFrame -= _spriteFrameDurationSecs;
-                        ++p->_frame;
-                        if (p->_frame == _spriteFrameCount)
-                        {
-                            p->_frame = 0;
-                        }
-                    }
-                }
+                float time = percent[i] - (float)frames[i] * percentPerFrame;
+                timeOnCurrentFrame[i] = time;
+                frames[i] += (unsigned int)(frames[i] < lastFrame && time >= percentPerFrame);
             }
         }
         else
         {
-            // Particle is dead.  Move the particle furthest from the start of the array
-            // down to take its place, and re-use the slot at the end of the list of living particles.
-            if (particlesIndex != _particleCount - 1)
+            // _spriteFrameDurationSecs is an absolute time measured in seconds,
+            // and the animation repeats indefinitely.
+            float duration = _spriteFrameDurationSecs;
+            for (unsigned int i = 0; i < count; ++i)
             {
-                _particles[particlesIndex] = _particles[_particleCount - 1];
+                float time = timeOnCurrentFrame[i] + elapsedSecs;
+                unsigned int advance = (unsigned int)(time >= duration);
+                timeOnCurrentFrame[i] = time - duration * (float)advance;
+                unsigned int frame = frames[i] + advance;
+                frames[i] = frame * (unsigned int)(frame <= lastFrame);
             }
-            --_particleCount;
         }
     }
+
+    compactParticles();
+}
+
+void ParticleEmitter::compactParticles()
+{
+    // Skip the particles that are still alive at the start of the array.
+    const float* energy = _particleStreams[STREAM_ENERGY];
+    unsigned int first = 0;
+    while (first < _particleCount && energy[first] > 0.0f)
+        ++first;
+
+    // Copy every remaining particle down to the next free slot, and only advance past
+    // it when it is alive, so that dead particles are overwritten without branching.
+    // Each stream is compacted on its own so that the loops walk memory sequentially,
+    // and the energy stream is compacted last since the other streams read it.
+    unsigned int alive = first;
+    for (unsigned int j = 0; j < STREAM_COUNT; ++j)
+    {
+        if (j == STREAM_ENERGY)
+            continue;
+        float* stream = _particleStreams[j];
+        alive = first;
+        for (unsigned int i = first; i < _particleCount; ++i)
+        {
+            stream[alive] = stream[i];
+            alive += (unsigned int)(energy[i] > 0.0f);
+        }
+    }
+    unsigned int* frames = _particleFrames;
+    alive = first;
+    for (unsigned int i = first; i < _particleCount; ++i)
+    {
+        frames[alive] = frames[i];
+        alive += (unsigned int)(energy[i] > 0.0f);
+    }
+    float* energyStream = _particleStreams[STREAM_ENERGY];
+    alive = first;
+    for (unsigned int i = first; i < _particleCount; ++i)
+    {
+        energyStream[alive] = energyStream[i];
+        alive += (unsigned int)(energyStream[i] > 0.0f);
+    }
+    _particleCount = alive;
 }
 
 unsigned int ParticleEmitter::draw(bool wireframe)
 {
+    return record(RenderCommandList::getImmediate(), wireframe);
+}
+
+unsigned int ParticleEmitter::record(RenderCommandList* list, bool wireframe)
+{
+    GP_ASSERT(list);
+
     if (!isActive())
         return 0;
 
     if (_particleCount > 0)
     {
         GP_ASSERT(_spriteBatch);
-        GP_ASSERT(_particles);
+        GP_ASSERT(_particleData);
         GP_ASSERT(_spriteTextureCoords);
 
         // Set our node's view projection matrix to this emitter's effect.
@@ -999,9 +1235,6 @@ unsigned int ParticleEmitter::draw(bool wireframe)
         // Begin sprite batch drawing
         _spriteBatch->start();
 
-        // 2D Rotation.
-        static const Vector2 pivot(0.5f, 0.5f);
-
         // 3D Rotation so that particles always face the camera.
         GP_ASSERT(_node && _node->getScene() && _node->getScene()->getActiveCamera() && _node->getScene()->getActiveCamera()->getNode());
         const Matrix& cameraWorldMatrix = _node->getScene()->getActiveCamera()->getNode()->getWorldMatrix();
@@ -1011,21 +1244,105 @@ unsigned int ParticleEmitter::draw(bool wireframe)
         Vector3 up;
         cameraWorldMatrix.getUpVector(&up);
 
-        for (unsigned int i = 0; i < _particleCount; i++)
+        if (_depthSorted)
         {
-            Particle* p = &_particles[i];
-
-            _spriteBatch->draw(p->_position, right, up, p->_size, p->_size,
-                                _spriteTextureCoords[p->_frame * 4], _spriteTextureCoords[p->_frame * 4 + 1], _spriteTextureCoords[p->_frame * 4 + 2], _spriteTextureCoords[p->_frame * 4 + 3],
-                                p->_color, pivot, p->_angle);
+            // Draw the particles from back to front so that they blend correctly.
+            Vector3 eye;
+            cameraWorldMatrix.getTranslation(&eye);
+            Vector3 forward;
+            cameraWorldMatrix.getForwardVector(&forward);
+
+            _sortKeys.resize(_particleCount);
+            for (unsigned int i = 0; i < _particleCount; i++)
+            {
+                _sortKeys[i] = ((unsigned long long)getDepthKey(i, eye, forward) << 32) | i;
+            }
+            sortByDepth(_sortKeys, _sortScratch);
+            for (unsigned int i = 0; i < _particleCount; i++)
+            {
+                drawParticle(_spriteBatch, (unsigned int)_sortKeys[i], right, up);
+            }
+        }
+        else
+        {
+            for (unsigned int i = 0; i < _particleCount; i++)
+            {
+                drawParticle(_spriteBatch, i, right, up);
+            }
         }
 
         // Render.
-        _spriteBatch->finish();
+        _spriteBatch->finish(list);
     }
     return 1;
 }
 
+void ParticleEmitter::drawParticle(SpriteBatch* batch, unsigned int index, const Vector3& right, const Vector3& up) const
+{
+    GP_ASSERT(batch);
+    GP_ASSERT(index < _particleCount);
+
+    // 2D Rotation.
+    static const Vector2 pivot(0.5f, 0.5f);
+
+    float* const* streams = _particleStreams;
+    Vector3 position(streams[STREAM_POSITION_X][index], streams[STREAM_POSITION_Y][index], streams[STREAM_POSITION_Z][index]);
+    Vector4 color(streams[STREAM_COLOR_R][index], streams[STREAM_COLOR_G][index], streams[STREAM_COLOR_B][index], streams[STREAM_COLOR_A][index]);
+    float size = streams[STREAM_SIZE][index];
+    const float* frame = &_spriteTextureCoords[_particleFrames[index] * 4];
+
+    batch->draw(position, right, up, size, size, frame[0], frame[1], frame[2], frame[3],
+                color, pivot, streams[STREAM_ANGLE][index]);
+}
+
+unsigned int ParticleEmitter::getDepthKey(unsigned int index, const Vector3& eye, const Vector3& forward) const
+{
+    float* const* streams = _particleStreams;
+    float depth = (streams[STREAM_POSITION_X][index] - eye.x) * forward.x +
+                  (streams[STREAM_POSITION_Y][index] - eye.y) * forward.y +
+                  (streams[STREAM_POSITION_Z][index] - eye.z) * forward.z;
+
+    // Map the float to an unsigned integer with the same ordering, then invert it so that
+    // the farthest particles get the smallest keys.
+    unsigned int bits;
+    memcpy(&bits, &depth, sizeof(float));
+    bits = (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+    return ~bits;
+}
+
+void ParticleEmitter::sortByDepth(std::vector<unsigned long long>& keys, std::vector<unsigned long long>& scratch)
+{
+    // Least significant digit radix sort on the upper 32 bits, 8 bits per pass. Each pass is
+    // stable, so entries with equal keys keep their order.
+    size_t count = keys.size();
+    scratch.resize(count);
+    unsigned long long* src = keys.empty() ? NULL : &keys[0];
+    unsigned long long* dst = scratch.empty() ? NULL : &scratch[0];
+    for (unsigned int shift = 32; shift < 64; shift += 8)
+    {
+        unsigned int offsets[256];
+        memset(offsets, 0, sizeof(offsets));
+        for (size_t i = 0; i < count; ++i)
+        {
+            ++offsets[(src[i] >> shift) & 0xFF];
+        }
+        unsigned int total = 0;
+        for (unsigned int i = 0; i < 256; ++i)
+        {
+            unsigned int digitCount = offsets[i];
+            offsets[i] = total;
+            total += digitCount;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[offsets[(src[i] >> shift) & 0xFF]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    // An even number of passes leaves the sorted entries back in keys.
+}
+
 Drawable* ParticleEmitter::clone(NodeCloneContext& context)
 {
     // Create a clone of this emitter
@@ -1057,6 +1374,7 @@ Drawable* ParticleEmitter::clone(NodeCloneContext& context)
     clone->_rotationAxis = _rotationAxis;
     clone->_rotationAxisVar = _rotationAxisVar;
     clone->setSpriteTexCoords(_spriteFrameCount, _spriteTextureCoords);
+    clone->_spriteImageRegion = _spriteImageRegion;
     clone->_spriteAnimated = _spriteAnimated;
     clone->_spriteLooped = _spriteLooped;
     clone->_spriteFrameRandomOffset = _spriteFrameRandomOffset;
@@ -1064,6 +1382,7 @@ Drawable* ParticleEmitter::clone(NodeCloneContext& context)
     clone->_orbitPosition = _orbitPosition;
     clone->_orbitVelocity = _orbitVelocity;
     clone->_orbitAcceleration = _orbitAcceleration;
+    clone->_depthSorted = _depthSorted;
 
     return clone;
 }
@@ -139,6 +139,7 @@ class Node;
 class ParticleEmitter : public Ref, public Drawable
 {
     friend class Node;
+    friend class ParticleSystem;
 
 public:
 
@@ -618,6 +619,9 @@ public:
     /**
      * Sets the sprite's texture coordinates in texture space.
      *
+     * When the texture was set from the path of an image packed into a texture atlas,
+     * the coordinates are relative to that image and are mapped into the atlas page.
+     *
      * @param frameCount The number of frames to set texture coordinates for.
      * @param texCoords The texture coordinates for all frames, in texture space.
      */
@@ -697,6 +701,44 @@ public:
      */
     BlendMode getBlendMode() const;
 
+    /**
+     * Sets the seed of the random number generator used to emit particles.
+     *
+     * Each emitter owns its generator, so emitters seeded with the same value and updated
+     * with the same elapsed times emit the same particles, whichever thread updates them.
+     * New emitters are seeded from rand().
+     *
+     * @param seed The seed (zero is replaced by a fixed non-zero value).
+     */
+    void setRandomSeed(unsigned int seed);
+
+    /**
+     * Gets the seed last set on the random number generator of this emitter.
+     *
+     * @return The seed.
+     */
+    unsigned int getRandomSeed() const;
+
+    /**
+     * Sets whether particles are drawn from back to front.
+     *
+     * Sorting particles by their distance along the camera's view direction is required for
+     * alpha blended particles to overlap correctly. It is not needed for additive blending.
+     * Particles are sorted with a radix sort each time the emitter is drawn. When several
+     * sorted emitters are drawn through a ParticleSystem, the particles of the emitters that
+     * share a texture and blend mode are sorted and drawn together.
+     *
+     * @param sorted true to sort particles by depth, false to draw them in emission order (the default).
+     */
+    void setDepthSorted(bool sorted);
+
+    /**
+     * Gets whether particles are drawn from back to front.
+     *
+     * @return true if particles are sorted by depth.
+     */
+    bool isDepthSorted() const;
+
     /**
      * Updates the particles currently being emitted.
      *
@@ -711,6 +753,15 @@ public:
      */
     unsigned int draw(bool wireframe = false);
 
+    /**
+     * @see Drawable::record
+     *
+     * Builds the sprites of the particles currently being emitted and records the
+     * commands that draw them. The emitter must not be updated or drawn again until
+     * the list has been executed.
+     */
+    unsigned int record(RenderCommandList* list, bool wireframe = false);
+
 private:
 
     /**
@@ -743,11 +794,21 @@ private:
      */
     static ParticleEmitter* create(Texture* texture, BlendMode blendMode,  unsigned int particleCountMax);
 
+    // Sets the texture, drawing the sprite from a region of it (such as an image in an atlas page).
+    void setTexture(Texture* texture, BlendMode blendMode, const Rectangle& region);
+
+    // Generates a random integer with the emitter's xorshift generator.
+    unsigned int generateRandom();
+
+    // Generates a random float between 0 and 1.
+    float generateRandom01();
+
+    // Generates a random float between -1 and 1.
+    float generateRandomMinus1To1();
+
     // Generates a scalar within the range defined by min and max.
     float generateScalar(float min, float max);
 
-    long generateScalar(long min, long max);
-
     // Generates a vector within the domain defined by a base vector and its variance.
     void generateVectorInRect(const Vector3& base, const Vector3& variance, Vector3* dst);
 
@@ -763,34 +824,68 @@ private:
     static ParticleEmitter::BlendMode getBlendModeFromString(const char* src);
 
     /**
-     * Defines the data for a single particle in the system.
+     * Defines the streams of per-particle data.
+     *
+     * Particles are stored as a structure of arrays: each stream is a separate array of
+     * floats holding one value per particle, so that update can process several particles
+     * at a time with SIMD instructions.
      */
-    class Particle
+    enum ParticleStream
     {
-
-    public:
-        Vector3 _position;
-        Vector3 _velocity;
-        Vector3 _acceleration;
-        Vector4 _colorStart;
-        Vector4 _colorEnd;
-        Vector4 _color;
-        float _rotationPerParticleSpeed;
-        Vector3 _rotationAxis;
-        float _rotationSpeed;
-        float _angle;
-        long _energyStart;
-        long _energy;
-        float _sizeStart;
-        float _sizeEnd;
-        float _size;
-        unsigned int _frame;
-        float _timeOnCurrentFrame;
+        STREAM_POSITION_X,
+        STREAM_POSITION_Y,
+        STREAM_POSITION_Z,
+        STREAM_VELOCITY_X,
+        STREAM_VELOCITY_Y,
+        STREAM_VELOCITY_Z,
+        STREAM_ACCELERATION_X,
+        STREAM_ACCELERATION_Y,
+        STREAM_ACCELERATION_Z,
+        STREAM_COLOR_START_R,
+        STREAM_COLOR_START_G,
+        STREAM_COLOR_START_B,
+        STREAM_COLOR_START_A,
+        STREAM_COLOR_END_R,
+        STREAM_COLOR_END_G,
+        STREAM_COLOR_END_B,
+        STREAM_COLOR_END_A,
+        STREAM_COLOR_R,
+        STREAM_COLOR_G,
+        STREAM_COLOR_B,
+        STREAM_COLOR_A,
+        STREAM_ROTATION_PER_PARTICLE_SPEED,
+        STREAM_ROTATION_AXIS_X,
+        STREAM_ROTATION_AXIS_Y,
+        STREAM_ROTATION_AXIS_Z,
+        STREAM_ROTATION_SPEED,
+        STREAM_ANGLE,
+        STREAM_ENERGY_START,
+        STREAM_ENERGY,
+        STREAM_SIZE_START,
+        STREAM_SIZE_END,
+        STREAM_SIZE,
+        STREAM_TIME_ON_CURRENT_FRAME,
+        STREAM_COUNT
     };
 
+    // Removes the dead particles, keeping the living ones in order.
+    void compactParticles();
+
+    // Draws one particle into the given sprite batch.
+    void drawParticle(SpriteBatch* batch, unsigned int index, const Vector3& right, const Vector3& up) const;
+
+    // Gets the sort key of a particle, which is smaller for particles farther from the eye.
+    unsigned int getDepthKey(unsigned int index, const Vector3& eye, const Vector3& forward) const;
+
+    // Sorts entries by their upper 32 bits.
+    static void sortByDepth(std::vector<unsigned long long>& keys, std::vector<unsigned long long>& scratch);
+
     unsigned int _particleCountMax;
     unsigned int _particleCount;
-    Particle* _particles;
+    float* _particleData;
+    float* _particleStreams[STREAM_COUNT];
+    float* _particlePercent;
+    unsigned int* _particleFrames;
     unsigned int _emissionRate;
     bool _started;
     bool _ellipsoid;
@@ -824,6 +919,7 @@ private:
     float _spriteTextureWidthRatio;
     float _spriteTextureHeightRatio;
     float* _spriteTextureCoords;
+    Rectangle _spriteImageRegion;
     bool _spriteAnimated;
     bool _spriteLooped;
     unsigned int _spriteFrameCount;
@@ -836,7 +932,13 @@ private:
     bool _orbitAcceleration;
     float _timePerEmission;
     float _emitTime;
-    double _lastUpdated;
+    double _runningTime;
+    unsigned int _randomSeed;
+    unsigned int _randomState;
+    bool _depthSorted;
+    float _emissionScale;
+    std::vector<unsigned long long> _sortKeys;
+    std::vector<unsigned long long> _sortScratch;
 };
 
 }
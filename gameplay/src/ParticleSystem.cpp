@@ -0,0 +1,311 @@
+#include "Base.h"
+#include "ParticleSystem.h"
+#include "Node.h"
+#include "Scene.h"
+#include "Camera.h"
+#include "SpriteBatch.h"
+#include "RenderCommandList.h"
+
+// Minimum number of emitters updated per thread, below which threads cost more than they save.
+#define PARTICLE_SYSTEM_EMITTERS_PER_THREAD_MIN 2
+
+// Maximum number of particles sorted and drawn together, which keeps the 16-bit indices of the sprite batches in range.
+#define PARTICLE_SYSTEM_MAX_SORT_SIZE 8192
+
+namespace gameplay
+{
+
+ParticleSystem::ParticleSystem()
+    : _threadCount(0), _particleBudget(0)
+{
+}
+
+ParticleSystem::~ParticleSystem()
+{
+    clear();
+}
+
+ParticleSystem* ParticleSystem::create()
+{
+    return new ParticleSystem();
+}
+
+void ParticleSystem::add(ParticleEmitter* emitter)
+{
+    GP_ASSERT(emitter);
+
+    if (std::find(_emitters.begin(), _emitters.end(), emitter) != _emitters.end())
+        return;
+
+    emitter->addRef();
+    _emitters.push_back(emitter);
+}
+
+void ParticleSystem::remove(ParticleEmitter* emitter)
+{
+    std::vector<ParticleEmitter*>::iterator itr = std::find(_emitters.begin(), _emitters.end(), emitter);
+    if (itr != _emitters.end())
+    {
+        _emitters.erase(itr);
+        SAFE_RELEASE(emitter);
+    }
+}
+
+void ParticleSystem::clear()
+{
+    for (size_t i = 0, count = _emitters.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_emitters[i]);
+    }
+    _emitters.clear();
+    _active.clear();
+}
+
+unsigned int ParticleSystem::getEmitterCount() const
+{
+    return (unsigned int)_emitters.size();
+}
+
+ParticleEmitter* ParticleSystem::getEmitter(unsigned int index) const
+{
+    GP_ASSERT(index < _emitters.size());
+    return _emitters[index];
+}
+
+void ParticleSystem::setThreadCount(unsigned int threadCount)
+{
+    _threadCount = threadCount;
+}
+
+unsigned int ParticleSystem::getThreadCount() const
+{
+    return _threadCount;
+}
+
+void ParticleSystem::setParticleBudget(unsigned int particleBudget)
+{
+    _particleBudget = particleBudget;
+}
+
+unsigned int ParticleSystem::getParticleBudget() const
+{
+    return _particleBudget;
+}
+
+unsigned int ParticleSystem::getParticleCount() const
+{
+    unsigned int count = 0;
+    for (size_t i = 0, emitterCount = _emitters.size(); i < emitterCount; ++i)
+    {
+        count += _emitters[i]->getParticlesCount();
+    }
+    return count;
+}
+
+void ParticleSystem::applyParticleBudget()
+{
+    unsigned int particleCount = 0;
+    for (size_t i = 0, count = _active.size(); i < count; ++i)
+    {
+        particleCount += _active[i]->getParticlesCount();
+    }
+
+    if (_particleBudget == 0 || particleCount <= _particleBudget)
+    {
+        for (size_t i = 0, count = _active.size(); i < count; ++i)
+        {
+            _active[i]->_emissionScale = 1.0f;
+        }
+        return;
+    }
+
+    // Weight each emitter by the apparent size of its particles.
+    std::vector<float> priorities(_active.size());
+    float prioritySum = 0.0f;
+    for (size_t i = 0, count = _active.size(); i < count; ++i)
+    {
+        ParticleEmitter* emitter = _active[i];
+        float priority = (emitter->_sizeStartMin + emitter->_sizeStartMax + emitter->_sizeEndMin + emitter->_sizeEndMax) * 0.25f;
+        Node* node = emitter->getNode();
+        Scene* scene = node ? node->getScene() : NULL;
+        Camera* camera = scene ? scene->getActiveCamera() : NULL;
+        if (camera && camera->getNode())
+        {
+            float distance = node->getTranslationWorld().distance(camera->getNode()->getTranslationWorld());
+            priority /= std::max(distance, 1.0f);
+        }
+        priorities[i] = std::max(priority, MATH_FLOAT_SMALL);
+        prioritySum += priorities[i];
+    }
+
+    // Throttle the emitters that hold more than their share of the budget.
+    for (size_t i = 0, count = _active.size(); i < count; ++i)
+    {
+        ParticleEmitter* emitter = _active[i];
+        float share = (float)_particleBudget * priorities[i] / prioritySum;
+        unsigned int emitterCount = emitter->getParticlesCount();
+        emitter->_emissionScale = (float)emitterCount > share ? share / (float)emitterCount : 1.0f;
+    }
+}
+
+static void updateRange(ParticleEmitter** emitters, unsigned int count, float elapsedTime)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        emitters[i]->update(elapsedTime);
+    }
+}
+
+void ParticleSystem::update(float elapsedTime)
+{
+    // Collect the active emitters and resolve the world matrices of their nodes, which
+    // are computed lazily and shared between nodes, before updating on other threads.
+    _active.clear();
+    for (size_t i = 0, count = _emitters.size(); i < count; ++i)
+    {
+        ParticleEmitter* emitter = _emitters[i];
+        if (emitter->isActive())
+        {
+            if (emitter->getNode())
+                emitter->getNode()->getWorldMatrix();
+            _active.push_back(emitter);
+        }
+    }
+
+    unsigned int emitterCount = (unsigned int)_active.size();
+    if (emitterCount == 0)
+        return;
+
+    applyParticleBudget();
+
+    unsigned int threadCount = _threadCount ? _threadCount : std::thread::hardware_concurrency();
+    threadCount = std::max(1u, std::min(threadCount, emitterCount / PARTICLE_SYSTEM_EMITTERS_PER_THREAD_MIN));
+
+    // Update the first range on the calling thread and the others on worker threads.
+    std::vector<std::thread> threads;
+    unsigned int rangeSize = (emitterCount + threadCount - 1) / threadCount;
+    for (unsigned int i = 1; i < threadCount; ++i)
+    {
+        unsigned int first = std::min(i * rangeSize, emitterCount);
+        unsigned int count = std::min(rangeSize, emitterCount - first);
+        if (count > 0)
+            threads.push_back(std::thread(&updateRange, &_active[first], count, elapsedTime));
+    }
+    updateRange(&_active[0], std::min(rangeSize, emitterCount), elapsedTime);
+
+    for (size_t i = 0, count = threads.size(); i < count; ++i)
+    {
+        threads[i].join();
+    }
+}
+
+unsigned int ParticleSystem::draw(bool wireframe)
+{
+    return record(RenderCommandList::getImmediate(), wireframe);
+}
+
+unsigned int ParticleSystem::record(RenderCommandList* list, bool wireframe)
+{
+    GP_ASSERT(list);
+
+    unsigned int batchCount = 0;
+    for (size_t i = 0, count = _emitters.size(); i < count; )
+    {
+        ParticleEmitter* emitter = _emitters[i];
+        if (!emitter->isActive() || emitter->getParticlesCount() == 0)
+        {
+            ++i;
+            continue;
+        }
+        if (!emitter->isDepthSorted() || !emitter->getNode())
+        {
+            batchCount += emitter->record(list, wireframe);
+            ++i;
+            continue;
+        }
+
+        // Gather the consecutive sorted emitters that can be drawn with the same sprite batch.
+        Texture* texture = emitter->_spriteBatch->getSampler()->getTexture();
+        Scene* scene = emitter->getNode() ? emitter->getNode()->getScene() : NULL;
+        _sorted.clear();
+        unsigned int particleCount = 0;
+        for (; i < count; ++i)
+        {
+            ParticleEmitter* other = _emitters[i];
+            if (!other->isActive() || other->getParticlesCount() == 0)
+                continue;
+            if (!other->isDepthSorted() || other->_spriteBlendMode != emitter->_spriteBlendMode ||
+                other->_spriteBatch->getSampler()->getTexture() != texture ||
+                !other->getNode() || other->getNode()->getScene() != scene)
+                break;
+            if (!_sorted.empty() && particleCount + other->getParticlesCount() > PARTICLE_SYSTEM_MAX_SORT_SIZE)
+                break;
+            _sorted.push_back(other);
+            particleCount += other->getParticlesCount();
+        }
+        batchCount += recordSorted(&_sorted[0], (unsigned int)_sorted.size(), list, wireframe);
+    }
+    return batchCount;
+}
+
+unsigned int ParticleSystem::recordSorted(ParticleEmitter** emitters, unsigned int count, RenderCommandList* list, bool wireframe)
+{
+    GP_ASSERT(emitters && count > 0);
+
+    if (wireframe)
+    {
+        // Wireframe drawing is done per emitter, as for unsorted emitters, since the
+        // particles do not need to blend in order.
+        unsigned int batchCount = 0;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            batchCount += emitters[i]->record(list, wireframe);
+        }
+        return batchCount;
+    }
+
+    ParticleEmitter* first = emitters[0];
+    Node* node = first->getNode();
+    GP_ASSERT(node && node->getScene() && node->getScene()->getActiveCamera() && node->getScene()->getActiveCamera()->getNode());
+    const Matrix& cameraWorldMatrix = node->getScene()->getActiveCamera()->getNode()->getWorldMatrix();
+
+    Vector3 right;
+    cameraWorldMatrix.getRightVector(&right);
+    Vector3 up;
+    cameraWorldMatrix.getUpVector(&up);
+    Vector3 eye;
+    cameraWorldMatrix.getTranslation(&eye);
+    Vector3 forward;
+    cameraWorldMatrix.getForwardVector(&forward);
+
+    // Key the particles of all of the emitters by depth, with their index across the emitters.
+    _sortOffsets.clear();
+    _sortKeys.clear();
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        ParticleEmitter* emitter = emitters[i];
+        unsigned int offset = (unsigned int)_sortKeys.size();
+        _sortOffsets.push_back(offset);
+        for (unsigned int j = 0, particleCount = emitter->getParticlesCount(); j < particleCount; ++j)
+        {
+            _sortKeys.push_back(((unsigned long long)emitter->getDepthKey(j, eye, forward) << 32) | (offset + j));
+        }
+    }
+    ParticleEmitter::sortByDepth(_sortKeys, _sortScratch);
+
+    // Draw every particle through the sprite batch of the first emitter.
+    SpriteBatch* batch = first->_spriteBatch;
+    batch->setProjectionMatrix(node->getViewProjectionMatrix());
+    batch->start();
+    for (size_t i = 0, particleCount = _sortKeys.size(); i < particleCount; ++i)
+    {
+        unsigned int index = (unsigned int)_sortKeys[i];
+        unsigned int emitter = (unsigned int)(std::upper_bound(_sortOffsets.begin(), _sortOffsets.end(), index) - _sortOffsets.begin()) - 1;
+        emitters[emitter]->drawParticle(batch, index - _sortOffsets[emitter], right, up);
+    }
+    batch->finish(list);
+
+    return 1;
+}
+
+}
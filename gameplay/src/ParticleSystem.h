@@ -0,0 +1,197 @@
+#ifndef PARTICLESYSTEM_H_
+#define PARTICLESYSTEM_H_
+
+#include "ParticleEmitter.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a class that updates a set of particle emitters in parallel.
+ *
+ * Emitters only touch their own particles and random number generator while updating,
+ * so the emitters of a particle system are split into consecutive ranges that are
+ * updated on separate threads. The result is the same as updating the emitters one
+ * after the other, and since each emitter is seeded independently (see
+ * ParticleEmitter::setRandomSeed) it does not depend on the number of threads.
+ *
+ * The world matrices of the emitter nodes are resolved on the calling thread before
+ * the worker threads start. Emitters must not be drawn or modified while they update.
+ *
+ * A particle system can also bound the total number of live particles of its emitters.
+ * When the emitters hold more particles than the budget, the budget is shared between
+ * them in proportion to their apparent size on screen (the average size of their
+ * particles divided by their distance to the camera), and the emission rate of each
+ * emitter holding more than its share is lowered until it is back within its share.
+ *
+ * Drawing the emitters through the particle system sorts the particles of the depth
+ * sorted emitters (see ParticleEmitter::setDepthSorted) that share a texture and blend
+ * mode together, so that they also blend correctly with each other.
+ *
+ * @code
+ * _particles->add(emitter);
+ * ...
+ * void MyGame::update(float elapsedTime)
+ * {
+ *     _particles->update(elapsedTime);
+ * }
+ *
+ * void MyGame::render(float elapsedTime)
+ * {
+ *     ...
+ *     _particles->draw();
+ * }
+ * @endcode
+ */
+class ParticleSystem
+{
+public:
+
+    /**
+     * Creates a new, empty particle system.
+     *
+     * @return A new particle system.
+     * @script{create}
+     */
+    static ParticleSystem* create();
+
+    /**
+     * Destructor.
+     */
+    ~ParticleSystem();
+
+    /**
+     * Adds an emitter to the particle system, which holds a reference to it.
+     *
+     * @param emitter The emitter to add.
+     */
+    void add(ParticleEmitter* emitter);
+
+    /**
+     * Removes an emitter from the particle system.
+     *
+     * @param emitter The emitter to remove.
+     */
+    void remove(ParticleEmitter* emitter);
+
+    /**
+     * Removes all of the emitters from the particle system.
+     */
+    void clear();
+
+    /**
+     * Gets the number of emitters in the particle system.
+     *
+     * @return The number of emitters.
+     */
+    unsigned int getEmitterCount() const;
+
+    /**
+     * Gets an emitter of the particle system.
+     *
+     * @param index The index of the emitter.
+     *
+     * @return The emitter.
+     */
+    ParticleEmitter* getEmitter(unsigned int index) const;
+
+    /**
+     * Sets the maximum number of threads used to update the emitters.
+     *
+     * @param threadCount The number of threads, including the calling thread, or zero
+     *      to use the number of hardware threads (the default).
+     */
+    void setThreadCount(unsigned int threadCount);
+
+    /**
+     * Gets the maximum number of threads used to update the emitters.
+     *
+     * @return The number of threads, or zero for the number of hardware threads.
+     */
+    unsigned int getThreadCount() const;
+
+    /**
+     * Sets the maximum number of live particles across all of the emitters.
+     *
+     * @param particleBudget The maximum number of particles, or zero for no limit (the default).
+     */
+    void setParticleBudget(unsigned int particleBudget);
+
+    /**
+     * Gets the maximum number of live particles across all of the emitters.
+     *
+     * @return The maximum number of particles, or zero for no limit.
+     */
+    unsigned int getParticleBudget() const;
+
+    /**
+     * Gets the number of live particles across all of the emitters.
+     *
+     * @return The number of particles.
+     */
+    unsigned int getParticleCount() const;
+
+    /**
+     * Updates the active emitters of the particle system.
+     *
+     * @param elapsedTime The amount of time that has passed since the last call to update(), in milliseconds.
+     */
+    void update(float elapsedTime);
+
+    /**
+     * Draws the active emitters of the particle system.
+     *
+     * @param wireframe true to draw the wireframe of the particles.
+     *
+     * @return The number of sprite batches drawn.
+     */
+    unsigned int draw(bool wireframe = false);
+
+    /**
+     * Records the commands that draw the active emitters of the particle system.
+     *
+     * The emitters must not be updated or drawn again until the list has been executed.
+     *
+     * @param list The command list to record into.
+     * @param wireframe true to draw the wireframe of the particles.
+     *
+     * @return The number of sprite batches recorded.
+     */
+    unsigned int record(RenderCommandList* list, bool wireframe = false);
+
+private:
+
+    /**
+     * Constructor.
+     */
+    ParticleSystem();
+
+    /**
+     * Hidden copy constructor.
+     */
+    ParticleSystem(const ParticleSystem& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    ParticleSystem& operator=(const ParticleSystem&);
+
+    // Sets the emission scale of each active emitter to keep within the particle budget.
+    void applyParticleBudget();
+
+    // Sorts and records the particles of consecutive sorted emitters with the same texture and blend mode.
+    unsigned int recordSorted(ParticleEmitter** emitters, unsigned int count, RenderCommandList* list, bool wireframe);
+
+    std::vector<ParticleEmitter*> _emitters;
+    std::vector<ParticleEmitter*> _active;
+    std::vector<ParticleEmitter*> _sorted;
+    std::vector<unsigned int> _sortOffsets;
+    std::vector<unsigned long long> _sortKeys;
+    std::vector<unsigned long long> _sortScratch;
+    unsigned int _threadCount;
+    unsigned int _particleBudget;
+};
+
+}
+
+#endif
@@ -113,6 +113,7 @@ bool RadioButton::keyEvent(Keyboard::KeyEvent evt, int key)
     {
         RadioButton::clearSelected(_groupId);
         _selected = true;
+        setDirty(DIRTY_GEOMETRY);
         notifyListeners(Control::Listener::VALUE_CHANGED);
     }
 
@@ -130,6 +131,7 @@ void RadioButton::controlEvent(Control::Listener::EventType evt)
         {
             RadioButton::clearSelected(_groupId);
             _selected = true;
+            setDirty(DIRTY_GEOMETRY);
             notifyListeners(Control::Listener::VALUE_CHANGED);
         }
         break;
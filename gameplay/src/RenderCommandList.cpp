@@ -0,0 +1,315 @@
+#include "Base.h"
+#include "RenderCommandList.h"
+#include "Drawable.h"
+#include "Effect.h"
+#include "Pass.h"
+#include "Scene.h"
+
+namespace gameplay
+{
+
+RenderCommandList::RenderCommandList(bool immediate)
+    : _immediate(immediate)
+{
+    memset(&_command, 0, sizeof(Command));
+}
+
+RenderCommandList::~RenderCommandList()
+{
+}
+
+RenderCommandList* RenderCommandList::create()
+{
+    return new RenderCommandList(false);
+}
+
+RenderCommandList* RenderCommandList::getImmediate()
+{
+    static RenderCommandList immediate(true);
+    return &immediate;
+}
+
+static void recordRange(Drawable** drawables, unsigned int count, RenderCommandList* list, bool wireframe)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        GP_ASSERT(drawables[i]);
+        drawables[i]->record(list, wireframe);
+    }
+}
+
+void RenderCommandList::recordParallel(Drawable** drawables, unsigned int drawableCount, RenderCommandList** lists, unsigned int listCount, bool wireframe)
+{
+    GP_ASSERT(drawables || drawableCount == 0);
+    GP_ASSERT(lists && listCount > 0);
+
+    // Node and camera matrices are computed lazily and shared between drawables, so resolve
+    // them on the calling thread before recording on other threads.
+    for (unsigned int i = 0; i < drawableCount; ++i)
+    {
+        Node* node = drawables[i]->getNode();
+        if (!node)
+            continue;
+
+        node->getWorldMatrix();
+        Scene* scene = node->getScene();
+        Camera* camera = scene ? scene->getActiveCamera() : NULL;
+        if (camera)
+        {
+            if (camera->getNode())
+                camera->getNode()->getWorldMatrix();
+            camera->getViewProjectionMatrix();
+            camera->getFrustum();
+        }
+    }
+
+    // Record the first range on the calling thread and the others on worker threads.
+    std::vector<std::thread> threads;
+    unsigned int rangeSize = (drawableCount + listCount - 1) / listCount;
+    for (unsigned int i = 1; i < listCount; ++i)
+    {
+        GP_ASSERT(lists[i] && !lists[i]->isImmediate());
+        unsigned int first = std::min(i * rangeSize, drawableCount);
+        unsigned int count = std::min(rangeSize, drawableCount - first);
+        if (count > 0)
+            threads.push_back(std::thread(&recordRange, drawables + first, count, lists[i], wireframe));
+    }
+    GP_ASSERT(lists[0] && !lists[0]->isImmediate());
+    recordRange(drawables, std::min(rangeSize, drawableCount), lists[0], wireframe);
+
+    for (size_t i = 0, count = threads.size(); i < count; ++i)
+    {
+        threads[i].join();
+    }
+}
+
+bool RenderCommandList::isImmediate() const
+{
+    return _immediate;
+}
+
+void RenderCommandList::clear()
+{
+    _commands.clear();
+    _values.clear();
+}
+
+RenderCommandList::Command& RenderCommandList::addCommand(CommandType type)
+{
+    if (_immediate)
+    {
+        _command.type = type;
+        return _command;
+    }
+
+    _commands.push_back(_command);
+    Command& command = _commands.back();
+    command.type = type;
+    return command;
+}
+
+void RenderCommandList::commit(const Command& command)
+{
+    if (_immediate)
+    {
+        execute(command);
+        _values.clear();
+    }
+}
+
+void RenderCommandList::bindPass(Pass* pass)
+{
+    GP_ASSERT(pass);
+
+    Command& command = addCommand(BIND_PASS);
+    command.pass = pass;
+    commit(command);
+}
+
+void RenderCommandList::unbindPass(Pass* pass)
+{
+    GP_ASSERT(pass);
+
+    Command& command = addCommand(UNBIND_PASS);
+    command.pass = pass;
+    commit(command);
+}
+
+void RenderCommandList::setUniform(Uniform* uniform, MaterialParameter::Type type, const float* values, unsigned int count)
+{
+    GP_ASSERT(uniform);
+    GP_ASSERT(values);
+
+    Command& command = addCommand(SET_UNIFORM);
+    command.uniform = uniform;
+    command.valueType = type;
+    command.valueOffset = (unsigned int)_values.size();
+    _values.insert(_values.end(), values, values + count);
+    commit(command);
+}
+
+void RenderCommandList::setUniform(Uniform* uniform, float value)
+{
+    setUniform(uniform, MaterialParameter::FLOAT, &value, 1);
+}
+
+void RenderCommandList::setUniform(Uniform* uniform, int value)
+{
+    float bits;
+    memcpy(&bits, &value, sizeof(float));
+    setUniform(uniform, MaterialParameter::INT, &bits, 1);
+}
+
+void RenderCommandList::setUniform(Uniform* uniform, const Vector2& value)
+{
+    setUniform(uniform, MaterialParameter::VECTOR2, &value.x, 2);
+}
+
+void RenderCommandList::setUniform(Uniform* uniform, const Vector3& value)
+{
+    setUniform(uniform, MaterialParameter::VECTOR3, &value.x, 3);
+}
+
+void RenderCommandList::setUniform(Uniform* uniform, const Vector4& value)
+{
+    setUniform(uniform, MaterialParameter::VECTOR4, &value.x, 4);
+}
+
+void RenderCommandList::setUniform(Uniform* uniform, const Matrix& value)
+{
+    setUniform(uniform, MaterialParameter::MATRIX, value.m, 16);
+}
+
+void RenderCommandList::bindIndexBuffer(IndexBufferHandle buffer)
+{
+    Command& command = addCommand(BIND_INDEX_BUFFER);
+    command.indexBuffer = buffer;
+    commit(command);
+}
+
+void RenderCommandList::drawArrays(Mesh::PrimitiveType primitiveType, unsigned int first, unsigned int count)
+{
+    Command& command = addCommand(DRAW_ARRAYS);
+    command.primitiveType = primitiveType;
+    command.first = first;
+    command.count = count;
+    commit(command);
+}
+
+void RenderCommandList::drawElements(Mesh::PrimitiveType primitiveType, unsigned int count, Mesh::IndexFormat indexFormat, const void* indices)
+{
+    Command& command = addCommand(DRAW_ELEMENTS);
+    command.primitiveType = primitiveType;
+    command.count = count;
+    command.indexFormat = indexFormat;
+    command.indices = indices;
+    commit(command);
+}
+
+void RenderCommandList::drawCallback(DrawCallback callback, void* cookie, bool wireframe)
+{
+    GP_ASSERT(callback);
+
+    Command& command = addCommand(DRAW_CALLBACK);
+    command.callback = callback;
+    command.cookie = cookie;
+    command.wireframe = wireframe;
+    commit(command);
+}
+
+unsigned int RenderCommandList::getCommandCount() const
+{
+    return (unsigned int)_commands.size();
+}
+
+const RenderCommandList::Command& RenderCommandList::getCommand(unsigned int index) const
+{
+    GP_ASSERT(index < _commands.size());
+    return _commands[index];
+}
+
+const float* RenderCommandList::getUniformValue(const Command& command) const
+{
+    GP_ASSERT(command.type == SET_UNIFORM);
+    GP_ASSERT(command.valueOffset < _values.size());
+    return &_values[command.valueOffset];
+}
+
+unsigned int RenderCommandList::execute() const
+{
+    unsigned int drawCalls = 0;
+    for (size_t i = 0, count = _commands.size(); i < count; ++i)
+    {
+        drawCalls += execute(_commands[i]);
+    }
+    return drawCalls;
+}
+
+unsigned int RenderCommandList::execute(const Command& command) const
+{
+    switch (command.type)
+    {
+    case BIND_PASS:
+        command.pass->bind();
+        break;
+
+    case UNBIND_PASS:
+        command.pass->unbind();
+        break;
+
+    case SET_UNIFORM:
+        {
+            Effect* effect = command.uniform->getEffect();
+            GP_ASSERT(effect);
+            const float* values = &_values[command.valueOffset];
+            switch (command.valueType)
+            {
+            case MaterialParameter::FLOAT:
+                effect->setValue(command.uniform, values[0]);
+                break;
+            case MaterialParameter::INT:
+                {
+                    int value;
+                    memcpy(&value, values, sizeof(int));
+                    effect->setValue(command.uniform, value);
+                }
+                break;
+            case MaterialParameter::VECTOR2:
+                effect->setValue(command.uniform, reinterpret_cast<const Vector2*>(values), 1);
+                break;
+            case MaterialParameter::VECTOR3:
+                effect->setValue(command.uniform, reinterpret_cast<const Vector3*>(values), 1);
+                break;
+            case MaterialParameter::VECTOR4:
+                effect->setValue(command.uniform, reinterpret_cast<const Vector4*>(values), 1);
+                break;
+            case MaterialParameter::MATRIX:
+                effect->setValue(command.uniform, reinterpret_cast<const Matrix*>(values), 1);
+                break;
+            default:
+                GP_ERROR("Unsupported uniform value type (%d).", command.valueType);
+                break;
+            }
+        }
+        break;
+
+    case BIND_INDEX_BUFFER:
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, command.indexBuffer) );
+        break;
+
+    case DRAW_ARRAYS:
+        GL_ASSERT( glDrawArrays(command.primitiveType, command.first, command.count) );
+        return 1;
+
+    case DRAW_ELEMENTS:
+        GL_ASSERT( glDrawElements(command.primitiveType, command.count, command.indexFormat, command.indices) );
+        return 1;
+
+    case DRAW_CALLBACK:
+        return command.callback(command.cookie, command.wireframe);
+    }
+
+    return 0;
+}
+
+}
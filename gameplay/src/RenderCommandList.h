@@ -0,0 +1,327 @@
+#ifndef RENDERCOMMANDLIST_H_
+#define RENDERCOMMANDLIST_H_
+
+#include "Ref.h"
+#include "Mesh.h"
+#include "MaterialParameter.h"
+
+namespace gameplay
+{
+
+class Pass;
+class Uniform;
+class Drawable;
+
+/**
+ * Defines a list of rendering commands that are recorded and executed later.
+ *
+ * Drawables record the commands needed to draw them (binding a pass, setting uniforms,
+ * binding an index buffer and issuing draw calls) into a command list with
+ * Drawable::record. Recording does not call the graphics API, so lists can be recorded
+ * concurrently on worker threads (one thread per list) and executed afterwards on the
+ * thread that owns the graphics context. Recording without executing also allows the
+ * generated commands to be inspected or counted without a graphics device.
+ *
+ * Commands reference the passes, uniforms, buffers and client vertex arrays they use
+ * without holding references to them, so these must remain valid and unchanged until
+ * the list has been executed or cleared. Uniform values set with setUniform are copied
+ * into the list. Each drawable must only be recorded by one thread at a time, and since
+ * node and camera matrices are computed lazily, transforms should be up to date before
+ * recording in parallel.
+ *
+ * Drawables that do not support recording are recorded as a single command that draws
+ * them when the list is executed.
+ *
+ * @code
+ * // On worker threads
+ * list->clear();
+ * model->record(list);
+ *
+ * // On the rendering thread
+ * list->execute();
+ * @endcode
+ */
+class RenderCommandList : public Ref
+{
+public:
+
+    /**
+     * Defines the types of commands.
+     */
+    enum CommandType
+    {
+        BIND_PASS,
+        UNBIND_PASS,
+        SET_UNIFORM,
+        BIND_INDEX_BUFFER,
+        DRAW_ARRAYS,
+        DRAW_ELEMENTS,
+        DRAW_CALLBACK
+    };
+
+    /**
+     * Defines a callback that draws immediately when a list is executed.
+     *
+     * @param cookie The cookie passed when the callback was recorded.
+     * @param wireframe true if the wireframe was requested when the callback was recorded.
+     *
+     * @return The number of graphics draw calls issued.
+     */
+    typedef unsigned int (*DrawCallback)(void* cookie, bool wireframe);
+
+    /**
+     * A recorded command.
+     */
+    struct Command
+    {
+        /** The type of command. */
+        CommandType type;
+        /** The pass to bind or unbind. */
+        Pass* pass;
+        /** The uniform to set. */
+        Uniform* uniform;
+        /** The type of the uniform value (FLOAT, INT, VECTOR2, VECTOR3, VECTOR4 or MATRIX). */
+        MaterialParameter::Type valueType;
+        /** The offset of the uniform value in the value storage of the list. */
+        unsigned int valueOffset;
+        /** The index buffer to bind. */
+        IndexBufferHandle indexBuffer;
+        /** The primitive type to draw. */
+        Mesh::PrimitiveType primitiveType;
+        /** The first vertex to draw. */
+        unsigned int first;
+        /** The number of vertices or indices to draw. */
+        unsigned int count;
+        /** The format of the indices to draw. */
+        Mesh::IndexFormat indexFormat;
+        /** The offset into the bound index buffer, or the client array of indices to draw. */
+        const void* indices;
+        /** The function to call. */
+        DrawCallback callback;
+        /** The cookie to pass to the callback. */
+        void* cookie;
+        /** The wireframe flag to pass to the callback. */
+        bool wireframe;
+    };
+
+    /**
+     * Creates a new, empty command list.
+     *
+     * @return A new command list.
+     * @script{create}
+     */
+    static RenderCommandList* create();
+
+    /**
+     * Gets the command list that executes each command as soon as it is recorded.
+     *
+     * Drawables draw immediately by recording into this list, so it must only be used
+     * on the thread that owns the graphics context.
+     *
+     * @return The immediate command list.
+     */
+    static RenderCommandList* getImmediate();
+
+    /**
+     * Records the given drawables into the given lists concurrently.
+     *
+     * The drawables are split into consecutive ranges, one per list, and each range is
+     * recorded into its list on a separate thread. Executing the lists in order draws
+     * the drawables in their original order.
+     *
+     * The world matrices of the drawables' nodes and the matrices and frustum of their
+     * scenes' active cameras are resolved on the calling thread first, since they are
+     * computed lazily and shared. Transforms must not change while recording.
+     *
+     * @param drawables The drawables to record.
+     * @param drawableCount The number of drawables.
+     * @param lists The lists to record into (they are not cleared first).
+     * @param listCount The number of lists, which is the number of threads used.
+     * @param wireframe true to record the wireframe of the drawables.
+     */
+    static void recordParallel(Drawable** drawables, unsigned int drawableCount, RenderCommandList** lists, unsigned int listCount, bool wireframe = false);
+
+    /**
+     * Determines if this list executes commands as soon as they are recorded.
+     *
+     * @return true for the immediate list, false otherwise.
+     */
+    bool isImmediate() const;
+
+    /**
+     * Removes all of the commands from this list.
+     */
+    void clear();
+
+    /**
+     * Records binding a pass, with all of its parameters and render states.
+     *
+     * @param pass The pass to bind.
+     */
+    void bindPass(Pass* pass);
+
+    /**
+     * Records unbinding a pass.
+     *
+     * @param pass The pass to unbind.
+     */
+    void unbindPass(Pass* pass);
+
+    /**
+     * Records setting a uniform of the currently bound pass.
+     *
+     * @param uniform The uniform to set.
+     * @param value The value to set.
+     */
+    void setUniform(Uniform* uniform, float value);
+
+    /**
+     * Records setting a uniform of the currently bound pass.
+     *
+     * @param uniform The uniform to set.
+     * @param value The value to set.
+     */
+    void setUniform(Uniform* uniform, int value);
+
+    /**
+     * Records setting a uniform of the currently bound pass.
+     *
+     * @param uniform The uniform to set.
+     * @param value The value to set.
+     */
+    void setUniform(Uniform* uniform, const Vector2& value);
+
+    /**
+     * Records setting a uniform of the currently bound pass.
+     *
+     * @param uniform The uniform to set.
+     * @param value The value to set.
+     */
+    void setUniform(Uniform* uniform, const Vector3& value);
+
+    /**
+     * Records setting a uniform of the currently bound pass.
+     *
+     * @param uniform The uniform to set.
+     * @param value The value to set.
+     */
+    void setUniform(Uniform* uniform, const Vector4& value);
+
+    /**
+     * Records setting a uniform of the currently bound pass.
+     *
+     * @param uniform The uniform to set.
+     * @param value The value to set.
+     */
+    void setUniform(Uniform* uniform, const Matrix& value);
+
+    /**
+     * Records binding an index buffer (0 to draw from client arrays).
+     *
+     * @param buffer The index buffer to bind.
+     */
+    void bindIndexBuffer(IndexBufferHandle buffer);
+
+    /**
+     * Records drawing non-indexed primitives.
+     *
+     * @param primitiveType The type of primitives to draw.
+     * @param first The first vertex to draw.
+     * @param count The number of vertices to draw.
+     */
+    void drawArrays(Mesh::PrimitiveType primitiveType, unsigned int first, unsigned int count);
+
+    /**
+     * Records drawing indexed primitives.
+     *
+     * @param primitiveType The type of primitives to draw.
+     * @param count The number of indices to draw.
+     * @param indexFormat The format of the indices.
+     * @param indices The byte offset into the bound index buffer, or the client array of
+     *      indices when no index buffer is bound.
+     */
+    void drawElements(Mesh::PrimitiveType primitiveType, unsigned int count, Mesh::IndexFormat indexFormat, const void* indices = NULL);
+
+    /**
+     * Records a callback that draws directly when the list is executed.
+     *
+     * @param callback The function to call.
+     * @param cookie The cookie to pass to the function.
+     * @param wireframe The wireframe flag to pass to the function.
+     */
+    void drawCallback(DrawCallback callback, void* cookie, bool wireframe = false);
+
+    /**
+     * Gets the number of recorded commands.
+     *
+     * @return The number of commands.
+     */
+    unsigned int getCommandCount() const;
+
+    /**
+     * Gets a recorded command.
+     *
+     * @param index The index of the command.
+     *
+     * @return The command.
+     */
+    const Command& getCommand(unsigned int index) const;
+
+    /**
+     * Gets a recorded uniform value.
+     *
+     * @param command The SET_UNIFORM command.
+     *
+     * @return The float components of the value (an int value is stored bitwise).
+     */
+    const float* getUniformValue(const Command& command) const;
+
+    /**
+     * Executes the recorded commands in order.
+     *
+     * This must be called on the thread that owns the graphics context. The commands
+     * are kept, so a list can be executed more than once.
+     *
+     * @return The number of graphics draw calls issued.
+     */
+    unsigned int execute() const;
+
+private:
+
+    /**
+     * Constructor.
+     */
+    RenderCommandList(bool immediate);
+
+    /**
+     * Destructor.
+     */
+    ~RenderCommandList();
+
+    /**
+     * Hidden copy constructor.
+     */
+    RenderCommandList(const RenderCommandList& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    RenderCommandList& operator=(const RenderCommandList&);
+
+    Command& addCommand(CommandType type);
+
+    void commit(const Command& command);
+
+    void setUniform(Uniform* uniform, MaterialParameter::Type type, const float* values, unsigned int count);
+
+    unsigned int execute(const Command& command) const;
+
+    std::vector<Command> _commands;
+    std::vector<float> _values;
+    Command _command;
+    bool _immediate;
+};
+
+}
+
+#endif
@@ -42,6 +42,20 @@ RenderState::~RenderState()
     {
         SAFE_RELEASE(_parameters[i]);
     }
+
+    // Destroy the resolved uniform tables
+    for (size_t i = 0, count = _uniformTables.size(); i < count; ++i)
+    {
+        UniformTable* table = _uniformTables[i];
+#ifdef GP_USE_UNIFORM_BUFFER
+        if (table->blockBuffer)
+        {
+            GL_ASSERT( glDeleteBuffers(1, &table->blockBuffer) );
+        }
+#endif
+        SAFE_RELEASE(table->effect);
+        SAFE_DELETE(table);
+    }
 }
 
 void RenderState::initialize()
@@ -76,6 +90,7 @@ MaterialParameter* RenderState::getParameter(const char* name) const
     // Create a new parameter and store it in our list.
     param = new MaterialParameter(name);
     _parameters.push_back(param);
+    resetUniformTables();
 
     return param;
 }
@@ -94,6 +109,7 @@ void RenderState::addParameter(MaterialParameter* param)
 {
     _parameters.push_back(param);
     param->addRef();
+    resetUniformTables();
 }
 
 void RenderState::removeParameter(const char* name)
@@ -103,77 +119,66 @@ void RenderState::removeParameter(const char* name)
         MaterialParameter* p = _parameters[i];
         if (p->_name == name)
         {
+            for (size_t j = 0, slotCount = _autoBindings.size(); j < slotCount; ++j)
+            {
+                if (_autoBindings[j].parameter == p)
+                    _autoBindings[j].parameter = NULL;
+            }
             _parameters.erase(_parameters.begin() + i);
             SAFE_RELEASE(p);
+            resetUniformTables();
             break;
         }
     }
 }
 
-/**
- * @script{ignore}
- */
-const char* autoBindingToString(RenderState::AutoBinding autoBinding)
-{
-    // NOTE: As new AutoBinding values are added, this switch statement must be updatd.
-    switch (autoBinding)
-    {
-    case RenderState::NONE:
-        return NULL;
-    case RenderState::VIEW_MATRIX:
-        return "VIEW_MATRIX";
-    case RenderState::PROJECTION_MATRIX:
-        return "PROJECTION_MATRIX";
-    case RenderState::WORLD_VIEW_MATRIX:
-        return "WORLD_VIEW_MATRIX";
-    case RenderState::VIEW_PROJECTION_MATRIX:
-        return "VIEW_PROJECTION_MATRIX";
-    case RenderState::WORLD_VIEW_PROJECTION_MATRIX:
-        return "WORLD_VIEW_PROJECTION_MATRIX";
-    case RenderState::INVERSE_TRANSPOSE_WORLD_MATRIX:
-        return "INVERSE_TRANSPOSE_WORLD_MATRIX";
-    case RenderState::INVERSE_TRANSPOSE_WORLD_VIEW_MATRIX:
-        return "INVERSE_TRANSPOSE_WORLD_VIEW_MATRIX";
-    case RenderState::CAMERA_WORLD_POSITION:
-        return "CAMERA_WORLD_POSITION";
-    case RenderState::CAMERA_VIEW_POSITION:
-        return "CAMERA_VIEW_POSITION";
-    case RenderState::MATRIX_PALETTE:
-        return "MATRIX_PALETTE";
-    case RenderState::SCENE_AMBIENT_COLOR:
-        return "SCENE_AMBIENT_COLOR";
-    default:
-        return "";
-    }
-}
-
 void RenderState::setParameterAutoBinding(const char* name, AutoBinding autoBinding)
 {
-    setParameterAutoBinding(name, autoBindingToString(autoBinding));
+    setParameterAutoBinding(name, autoBinding == NONE ? NULL : enumToString("gameplay::RenderState::AutoBinding", autoBinding));
 }
 
 void RenderState::setParameterAutoBinding(const char* name, const char* autoBinding)
 {
     GP_ASSERT(name);
-    GP_ASSERT(autoBinding);
 
-    if (autoBinding == NULL)
+    AutoBindingSlot* slot = NULL;
+    for (size_t i = 0, count = _autoBindings.size(); i < count; ++i)
     {
-        // Remove an existing auto-binding
-        std::map<std::string, std::string>::iterator itr = _autoBindings.find(name);
-        if (itr != _autoBindings.end())
-            _autoBindings.erase(itr);
+        if (_autoBindings[i].name == name)
+        {
+            slot = &_autoBindings[i];
+            if (autoBinding == NULL)
+            {
+                // Remove an existing auto-binding
+                if (slot->parameter)
+                    slot->parameter->_autoBinding = false;
+                _autoBindings.erase(_autoBindings.begin() + i);
+                return;
+            }
+            break;
+        }
     }
-    else
+    if (autoBinding == NULL)
+        return;
+
+    if (slot == NULL)
     {
-        // Add/update an auto-binding
-        _autoBindings[name] = autoBinding;
+        // Add a new auto-binding
+        _autoBindings.push_back(AutoBindingSlot());
+        slot = &_autoBindings.back();
+        slot->name = name;
     }
 
+    // Parse the binding once, so it is never compared by name when rendering.
+    int type = enumParse("gameplay::RenderState::AutoBinding", autoBinding);
+    slot->autoBinding = autoBinding;
+    slot->type = type > NONE ? static_cast<AutoBinding>(type) : NONE;
+    slot->parameter = NULL;
+
     // If we already have a node binding set, pass it to our handler now
     if (_nodeBinding)
     {
-        applyAutoBinding(name, autoBinding);
+        applyAutoBinding(*slot);
     }
 }
 
@@ -210,181 +215,144 @@ void RenderState::setNodeBinding(Node* node)
 
         if (_nodeBinding)
         {
-            // Apply all existing auto-bindings using this node.
-            std::map<std::string, std::string>::const_iterator itr = _autoBindings.begin();
-            while (itr != _autoBindings.end())
+            // Built-in bindings that are already resolved read the new node when the render
+            // state is bound, so only the bindings given to custom resolvers (which resolve
+            // their values from the node) and those not yet resolved are applied again.
+            for (size_t i = 0, count = _autoBindings.size(); i < count; ++i)
             {
-                applyAutoBinding(itr->first.c_str(), itr->second.c_str());
-                ++itr;
+                if (_autoBindings[i].parameter == NULL)
+                    applyAutoBinding(_autoBindings[i]);
             }
         }
     }
 }
 
-void RenderState::applyAutoBinding(const char* uniformName, const char* autoBinding)
+void RenderState::applyAutoBinding(AutoBindingSlot& slot)
 {
     GP_ASSERT(_nodeBinding);
 
-    MaterialParameter* param = getParameter(uniformName);
+    MaterialParameter* param = getParameter(slot.name.c_str());
     GP_ASSERT(param);
 
+    slot.parameter = NULL;
     bool bound = false;
 
     // First attempt to resolve the binding using custom registered resolvers.
     for (size_t i = 0, count = _customAutoBindingResolvers.size(); i < count; ++i)
     {
-        if (_customAutoBindingResolvers[i]->resolveAutoBinding(autoBinding, _nodeBinding, param))
+        if (_customAutoBindingResolvers[i]->resolveAutoBinding(slot.autoBinding.c_str(), _nodeBinding, param))
         {
             // Handled by custom auto binding resolver
             bound = true;
             break;
         }
     }
-    // Perform built-in resolution
+    // Built-in bindings are evaluated from the slot table when the render state is bound.
     if (!bound)
     {
-        bound = true;
-
-        if (strcmp(autoBinding, "WORLD_MATRIX") == 0)
-        {
-            param->bindValue(this, &RenderState::autoBindingGetWorldMatrix);
-        }
-        else if (strcmp(autoBinding, "VIEW_MATRIX") == 0)
-        {
-            param->bindValue(this, &RenderState::autoBindingGetViewMatrix);
-        }
-        else if (strcmp(autoBinding, "PROJECTION_MATRIX") == 0)
-        {
-            param->bindValue(this, &RenderState::autoBindingGetProjectionMatrix);
-        }
-        else if (strcmp(autoBinding, "WORLD_VIEW_MATRIX") == 0)
-        {
-            param->bindValue(this, &RenderState::autoBindingGetWorldViewMatrix);
-        }
-        else if (strcmp(autoBinding, "VIEW_PROJECTION_MATRIX") == 0)
-        {
-            param->bindValue(this, &RenderState::autoBindingGetViewProjectionMatrix);
-        }
-        else if (strcmp(autoBinding, "WORLD_VIEW_PROJECTION_MATRIX") == 0)
-        {
-            param->bindValue(this, &RenderState::autoBindingGetWorldViewProjectionMatrix);
-        }
-        else if (strcmp(autoBinding, "INVERSE_TRANSPOSE_WORLD_MATRIX") == 0)
-        {
-            param->bindValue(this, &RenderState::autoBindingGetInverseTransposeWorldMatrix);
-        }
-        else if (strcmp(autoBinding, "INVERSE_TRANSPOSE_WORLD_VIEW_MATRIX") == 0)
-        {
-            param->bindValue(this, &RenderState::autoBindingGetInverseTransposeWorldViewMatrix);
-        }
-        else if (strcmp(autoBinding, "CAMERA_WORLD_POSITION") == 0)
-        {
-            param->bindValue(this, &RenderState::autoBindingGetCameraWorldPosition);
-        }
-        else if (strcmp(autoBinding, "CAMERA_VIEW_POSITION") == 0)
-        {
-            param->bindValue(this, &RenderState::autoBindingGetCameraViewPosition);
-        }
-        else if (strcmp(autoBinding, "MATRIX_PALETTE") == 0)
+        if (slot.type != NONE)
         {
-            param->bindValue(this, &RenderState::autoBindingGetMatrixPalette, &RenderState::autoBindingGetMatrixPaletteSize);
-        }
-        else if (strcmp(autoBinding, "SCENE_AMBIENT_COLOR") == 0)
-        {
-            param->bindValue(this, &RenderState::autoBindingGetAmbientColor);
+            slot.parameter = param;
+            bound = true;
         }
         else
         {
-            bound = false;
-            GP_WARN("Unsupported auto binding type (%s).", autoBinding);
+            GP_WARN("Unsupported auto binding type (%s).", slot.autoBinding.c_str());
         }
     }
     if (bound)
     {
         // Mark parameter as an auto binding
-        if (param->_type == MaterialParameter::METHOD && param->_value.method)
-            param->_value.method->_autoBinding = true;
+        param->_autoBinding = true;
     }
 }
 
-const Matrix& RenderState::autoBindingGetWorldMatrix() const
-{
-    return _nodeBinding ? _nodeBinding->getWorldMatrix() : Matrix::identity();
-}
-
-const Matrix& RenderState::autoBindingGetViewMatrix() const
+void RenderState::applyAutoBindingValues()
 {
-    return _nodeBinding ? _nodeBinding->getViewMatrix() : Matrix::identity();
-}
-
-const Matrix& RenderState::autoBindingGetProjectionMatrix() const
-{
-    return _nodeBinding ? _nodeBinding->getProjectionMatrix() : Matrix::identity();
-}
+    // The scene and its active camera are looked up once for all of the bindings.
+    Scene* scene = NULL;
+    Camera* camera = NULL;
+    bool sceneResolved = false;
+    Matrix matrix;
 
-const Matrix& RenderState::autoBindingGetWorldViewMatrix() const
-{
-    return _nodeBinding ? _nodeBinding->getWorldViewMatrix() : Matrix::identity();
-}
-
-const Matrix& RenderState::autoBindingGetViewProjectionMatrix() const
-{
-    return _nodeBinding ? _nodeBinding->getViewProjectionMatrix() : Matrix::identity();
-}
-
-const Matrix& RenderState::autoBindingGetWorldViewProjectionMatrix() const
-{
-    return _nodeBinding ? _nodeBinding->getWorldViewProjectionMatrix() : Matrix::identity();
-}
-
-const Matrix& RenderState::autoBindingGetInverseTransposeWorldMatrix() const
-{
-    return _nodeBinding ? _nodeBinding->getInverseTransposeWorldMatrix() : Matrix::identity();
-}
-
-const Matrix& RenderState::autoBindingGetInverseTransposeWorldViewMatrix() const
-{
-    return _nodeBinding ? _nodeBinding->getInverseTransposeWorldViewMatrix() : Matrix::identity();
-}
-
-Vector3 RenderState::autoBindingGetCameraWorldPosition() const
-{
-    return _nodeBinding ? _nodeBinding->getActiveCameraTranslationWorld() : Vector3::zero();
-}
-
-Vector3 RenderState::autoBindingGetCameraViewPosition() const
-{
-    return _nodeBinding ? _nodeBinding->getActiveCameraTranslationView() : Vector3::zero();
-}
-
-const Vector4* RenderState::autoBindingGetMatrixPalette() const
-{
-    Model* model = dynamic_cast<Model*>(_nodeBinding->getDrawable());
-    if (model)
+    for (size_t i = 0, count = _autoBindings.size(); i < count; ++i)
     {
-        MeshSkin* skin = model->getSkin();
-        if (skin)
-            return skin->getMatrixPalette();
-    }
-    return NULL;
-}
+        const AutoBindingSlot& slot = _autoBindings[i];
+        MaterialParameter* param = slot.parameter;
+        if (param == NULL)
+            continue;
 
-unsigned int RenderState::autoBindingGetMatrixPaletteSize() const
-{
-    Model* model = dynamic_cast<Model*>(_nodeBinding->getDrawable());
-    if (model)
-    {
-        MeshSkin* skin = model->getSkin();
-        if (skin)
-            return skin->getMatrixPaletteSize();
-    }
-    return 0;
-}
+        if (!sceneResolved && slot.type != WORLD_MATRIX && slot.type != MATRIX_PALETTE)
+        {
+            scene = _nodeBinding ? _nodeBinding->getScene() : NULL;
+            camera = scene ? scene->getActiveCamera() : NULL;
+            sceneResolved = true;
+        }
 
-const Vector3& RenderState::autoBindingGetAmbientColor() const
-{
-    Scene* scene = _nodeBinding ? _nodeBinding->getScene() : NULL;
-    return scene ? scene->getAmbientColor() : Vector3::zero();
+        switch (slot.type)
+        {
+        case WORLD_MATRIX:
+            param->setStoredValue(MaterialParameter::MATRIX, (_nodeBinding ? _nodeBinding->getWorldMatrix() : Matrix::identity()).m, 16);
+            break;
+        case VIEW_MATRIX:
+            param->setStoredValue(MaterialParameter::MATRIX, (camera ? camera->getViewMatrix() : Matrix::identity()).m, 16);
+            break;
+        case PROJECTION_MATRIX:
+            param->setStoredValue(MaterialParameter::MATRIX, (camera ? camera->getProjectionMatrix() : Matrix::identity()).m, 16);
+            break;
+        case WORLD_VIEW_MATRIX:
+            if (camera && _nodeBinding)
+                Matrix::multiply(camera->getViewMatrix(), _nodeBinding->getWorldMatrix(), &matrix);
+            else
+                matrix = _nodeBinding ? _nodeBinding->getWorldMatrix() : Matrix::identity();
+            param->setStoredValue(MaterialParameter::MATRIX, matrix.m, 16);
+            break;
+        case VIEW_PROJECTION_MATRIX:
+            param->setStoredValue(MaterialParameter::MATRIX, (camera ? camera->getViewProjectionMatrix() : Matrix::identity()).m, 16);
+            break;
+        case WORLD_VIEW_PROJECTION_MATRIX:
+            if (camera && _nodeBinding)
+                Matrix::multiply(camera->getViewProjectionMatrix(), _nodeBinding->getWorldMatrix(), &matrix);
+            else
+                matrix = _nodeBinding ? _nodeBinding->getWorldMatrix() : Matrix::identity();
+            param->setStoredValue(MaterialParameter::MATRIX, matrix.m, 16);
+            break;
+        case INVERSE_TRANSPOSE_WORLD_MATRIX:
+            matrix = _nodeBinding ? _nodeBinding->getWorldMatrix() : Matrix::identity();
+            matrix.invert();
+            matrix.transpose();
+            param->setStoredValue(MaterialParameter::MATRIX, matrix.m, 16);
+            break;
+        case INVERSE_TRANSPOSE_WORLD_VIEW_MATRIX:
+            if (camera && _nodeBinding)
+                Matrix::multiply(camera->getViewMatrix(), _nodeBinding->getWorldMatrix(), &matrix);
+            else
+                matrix = _nodeBinding ? _nodeBinding->getWorldMatrix() : Matrix::identity();
+            matrix.invert();
+            matrix.transpose();
+            param->setStoredValue(MaterialParameter::MATRIX, matrix.m, 16);
+            break;
+        case CAMERA_WORLD_POSITION:
+            param->setStoredValue(MaterialParameter::VECTOR3, &(camera && camera->getNode() ? camera->getTranslationWorld() : Vector3::zero()).x, 3);
+            break;
+        case CAMERA_VIEW_POSITION:
+            param->setStoredValue(MaterialParameter::VECTOR3, &(camera && camera->getNode() ? camera->getTranslationView() : Vector3::zero()).x, 3);
+            break;
+        case MATRIX_PALETTE:
+            {
+                Model* model = _nodeBinding ? dynamic_cast<Model*>(_nodeBinding->getDrawable()) : NULL;
+                MeshSkin* skin = model ? model->getSkin() : NULL;
+                if (skin && skin->getMatrixPalette())
+                    param->setValue(skin->getMatrixPalette(), skin->getMatrixPaletteSize());
+            }
+            break;
+        case SCENE_AMBIENT_COLOR:
+            param->setStoredValue(MaterialParameter::VECTOR3, &(scene ? scene->getAmbientColor() : Vector3::zero()).x, 3);
+            break;
+        default:
+            break;
+        }
+    }
 }
 
 void RenderState::bind(Pass* pass)
@@ -409,12 +377,52 @@ void RenderState::bind(Pass* pass)
     // Apply parameter bindings and renderer state for the entire hierarchy, top-down.
     rs = NULL;
     Effect* effect = pass->getEffect();
+    GP_ASSERT(effect);
+
+    // Members of the material uniform block from all levels of the hierarchy are packed
+    // into the block data of this (bottom-most) render state.
+    UniformTable* blockTable = effect->_blockSize > 0 ? getUniformTable(effect) : NULL;
+    if (blockTable)
+    {
+        if (blockTable->blockData.empty())
+        {
+            blockTable->blockData.resize(effect->_blockSize, 0);
+            blockTable->blockVersions.resize(effect->_blockMemberCount, 0);
+        }
+        effect->_blockData = &blockTable->blockData[0];
+    }
+
     while ((rs = getTopmost(rs)))
     {
+        // Evaluate the built-in auto-bindings resolved for this level.
+        if (!rs->_autoBindings.empty())
+        {
+            rs->applyAutoBindingValues();
+        }
+
+        UniformTable* table = rs->getUniformTable(effect);
         for (size_t i = 0, count = rs->_parameters.size(); i < count; ++i)
         {
-            GP_ASSERT(rs->_parameters[i]);
-            rs->_parameters[i]->bind(effect);
+            MaterialParameter* param = rs->_parameters[i];
+            GP_ASSERT(param);
+            Uniform* uniform = table->uniforms[i];
+            if (!uniform)
+            {
+                param->bind(effect, NULL);
+                continue;
+            }
+
+            // Skip parameters whose value has not changed since it was last applied to this uniform.
+            bool blockMember = blockTable && uniform->_blockMember >= 0;
+            unsigned int& version = blockMember ? blockTable->blockVersions[uniform->_blockMember] : uniform->_version;
+            bool versioned = param->isVersioned();
+            if (versioned && version == param->_version)
+                continue;
+
+            param->bind(effect, uniform);
+            version = versioned ? param->_version : 0;
+            if (blockMember)
+                blockTable->blockDirty = true;
         }
 
         if (rs->_state)
@@ -422,6 +430,80 @@ void RenderState::bind(Pass* pass)
             rs->_state->bindNoRestore();
         }
     }
+
+    if (blockTable)
+    {
+        effect->_blockData = NULL;
+        bindUniformBlock(blockTable);
+    }
+}
+
+RenderState::UniformTable* RenderState::getUniformTable(Effect* effect) const
+{
+    GP_ASSERT(effect);
+
+    UniformTable* table = NULL;
+    for (size_t i = 0, count = _uniformTables.size(); i < count; ++i)
+    {
+        if (_uniformTables[i]->effect == effect)
+        {
+            table = _uniformTables[i];
+            break;
+        }
+    }
+    if (table == NULL)
+    {
+        table = new UniformTable();
+        table->effect = effect;
+        table->blockBuffer = 0;
+        table->blockDirty = true;
+        effect->addRef();
+        _uniformTables.push_back(table);
+    }
+
+    // Resolve the uniform of each parameter once, rather than looking it up by name on every bind.
+    if (table->uniforms.size() != _parameters.size())
+    {
+        table->uniforms.resize(_parameters.size());
+        for (size_t i = 0, count = _parameters.size(); i < count; ++i)
+        {
+            table->uniforms[i] = effect->getUniform(_parameters[i]->getName());
+        }
+    }
+
+    return table;
+}
+
+void RenderState::resetUniformTables() const
+{
+    for (size_t i = 0, count = _uniformTables.size(); i < count; ++i)
+    {
+        _uniformTables[i]->uniforms.clear();
+    }
+}
+
+void RenderState::bindUniformBlock(UniformTable* table)
+{
+    GP_ASSERT(table);
+    GP_ASSERT(!table->blockData.empty());
+
+#ifdef GP_USE_UNIFORM_BUFFER
+    if (table->blockBuffer == 0)
+    {
+        GL_ASSERT( glGenBuffers(1, &table->blockBuffer) );
+        GL_ASSERT( glBindBuffer(GL_UNIFORM_BUFFER, table->blockBuffer) );
+        GL_ASSERT( glBufferData(GL_UNIFORM_BUFFER, table->blockData.size(), &table->blockData[0], GL_DYNAMIC_DRAW) );
+        table->blockDirty = false;
+    }
+    else if (table->blockDirty)
+    {
+        // Upload all changed material constants at once.
+        GL_ASSERT( glBindBuffer(GL_UNIFORM_BUFFER, table->blockBuffer) );
+        GL_ASSERT( glBufferSubData(GL_UNIFORM_BUFFER, 0, table->blockData.size(), &table->blockData[0]) );
+        table->blockDirty = false;
+    }
+    GL_ASSERT( glBindBufferBase(GL_UNIFORM_BUFFER, UNIFORM_BLOCK_MATERIAL_BINDING, table->blockBuffer) );
+#endif
 }
 
 RenderState* RenderState::getTopmost(RenderState* below)
@@ -451,18 +533,18 @@ void RenderState::cloneInto(RenderState* renderState, NodeCloneContext& context)
     GP_ASSERT(renderState);
 
     // Clone parameters
-    for (std::map<std::string, std::string>::const_iterator it = _autoBindings.begin(); it != _autoBindings.end(); ++it)
+    for (size_t i = 0, count = _autoBindings.size(); i < count; ++i)
     {
-        renderState->setParameterAutoBinding(it->first.c_str(), it->second.c_str());
+        renderState->setParameterAutoBinding(_autoBindings[i].name.c_str(), _autoBindings[i].autoBinding.c_str());
     }
     for (std::vector<MaterialParameter*>::const_iterator it = _parameters.begin(); it != _parameters.end(); ++it)
     {
         const MaterialParameter* param = *it;
         GP_ASSERT(param);
 
-        // If this parameter is a method binding auto binding, don't clone it - it will get setup automatically
+        // If this parameter is an auto binding, don't clone it - it will get setup automatically
         // via the cloned auto bindings instead.
-        if (param->_type == MaterialParameter::METHOD && param->_value.method && param->_value.method->_autoBinding)
+        if (param->_autoBinding)
             continue;
 
         MaterialParameter* paramCopy = new MaterialParameter(param->getName());
@@ -470,6 +552,7 @@ void RenderState::cloneInto(RenderState* renderState, NodeCloneContext& context)
 
         renderState->_parameters.push_back(paramCopy);
     }
+    renderState->resetUniformTables();
 
     // Clone our state block
     if (_state)
@@ -482,6 +565,53 @@ void RenderState::cloneInto(RenderState* renderState, NodeCloneContext& context)
     // 2. _parent should not be set here, since it's set in the constructor of Technique and Pass.
 }
 
+bool RenderState::hasSameState(const RenderState* renderState) const
+{
+    GP_ASSERT(renderState);
+
+    if (_parameters.size() != renderState->_parameters.size() || _autoBindings.size() != renderState->_autoBindings.size())
+        return false;
+
+    for (size_t i = 0, count = _autoBindings.size(); i < count; ++i)
+    {
+        const AutoBindingSlot& slot = _autoBindings[i];
+        bool found = false;
+        for (size_t j = 0; j < count && !found; ++j)
+        {
+            const AutoBindingSlot& other = renderState->_autoBindings[j];
+            found = slot.name == other.name && slot.autoBinding == other.autoBinding;
+        }
+        if (!found)
+            return false;
+    }
+
+    for (size_t i = 0, count = _parameters.size(); i < count; ++i)
+    {
+        const MaterialParameter* param = _parameters[i];
+        GP_ASSERT(param);
+
+        // Auto-bound values are resolved per node, so matching auto-bindings are enough.
+        if (param->_autoBinding)
+            continue;
+
+        const MaterialParameter* other = NULL;
+        for (size_t j = 0; j < count && other == NULL; ++j)
+        {
+            if (renderState->_parameters[j]->_name == param->_name)
+                other = renderState->_parameters[j];
+        }
+        if (other == NULL || other->_autoBinding || !param->hasSameValue(other))
+            return false;
+    }
+
+    if (_state == NULL || renderState->_state == NULL)
+    {
+        const StateBlock* state = _state ? _state : renderState->_state;
+        return state == NULL || state->_bits == 0;
+    }
+    return _state->isEqual(renderState->_state);
+}
+
 RenderState::StateBlock::StateBlock() :
     _blendEnabled(false), _blendSrc(RenderState::BLEND_ONE), _blendDst(RenderState::BLEND_ZERO),
     _cullFaceEnabled(false), _cullFaceSide(CULL_FACE_SIDE_BACK), _frontFace(FRONT_FACE_CCW),
@@ -736,6 +866,30 @@ void RenderState::StateBlock::cloneInto(StateBlock* state)
     state->_bits = _bits;
 }
 
+bool RenderState::StateBlock::isEqual(const StateBlock* state) const
+{
+    GP_ASSERT(state);
+
+    return _bits == state->_bits &&
+        _blendEnabled == state->_blendEnabled &&
+        _blendSrc == state->_blendSrc &&
+        _blendDst == state->_blendDst &&
+        _cullFaceEnabled == state->_cullFaceEnabled &&
+        _cullFaceSide == state->_cullFaceSide &&
+        _frontFace == state->_frontFace &&
+        _depthTestEnabled == state->_depthTestEnabled &&
+        _depthWriteEnabled == state->_depthWriteEnabled &&
+        _depthFunc == state->_depthFunc &&
+        _stencilTestEnabled == state->_stencilTestEnabled &&
+        _stencilWrite == state->_stencilWrite &&
+        _stencilFunc == state->_stencilFunc &&
+        _stencilFuncRef == state->_stencilFuncRef &&
+        _stencilFuncMask == state->_stencilFuncMask &&
+        _stencilOpSfail == state->_stencilOpSfail &&
+        _stencilOpDpfail == state->_stencilOpDpfail &&
+        _stencilOpDppass == state->_stencilOpDppass;
+}
+
 static bool parseBool(const char* value)
 {
     GP_ASSERT(value);
@@ -13,6 +13,8 @@ class MaterialParameter;
 class Node;
 class NodeCloneContext;
 class Pass;
+class Effect;
+class Uniform;
 
 /**
  * Defines the rendering state of the graphics device.
@@ -464,6 +466,8 @@ public:
 
         void cloneInto(StateBlock* state);
 
+        bool isEqual(const StateBlock* state) const;
+
         // States
         bool _blendEnabled;
         BlendMode _blendSrc;
@@ -589,6 +593,10 @@ public:
      * This is typically set to the node of the model that a material is 
      * applied to.
      *
+     * Built-in auto-bindings are resolved once and evaluated for the bound node
+     * when the render state is bound, so changing the node only applies the
+     * auto-bindings handled by custom resolvers again.
+     *
      * @param node The node to use for applying auto-bindings.
      */
     virtual void setNodeBinding(Node* node);
@@ -610,6 +618,21 @@ public:
 
 protected:
 
+    /**
+     * A material parameter auto-binding.
+     *
+     * The binding string is parsed once when it is set and the parameter is resolved
+     * once when a node is bound, so built-in bindings are evaluated from this table
+     * without any lookups by name.
+     */
+    struct AutoBindingSlot
+    {
+        std::string name;
+        std::string autoBinding;
+        AutoBinding type;
+        MaterialParameter* parameter;
+    };
+
     /**
      * Constructor.
      */
@@ -631,12 +654,14 @@ protected:
     static void finalize();
 
     /**
-     * Applies the specified custom auto-binding.
+     * Resolves the specified auto-binding for the bound node.
+     *
+     * Custom resolvers are given the first chance to handle the binding. Otherwise
+     * built-in bindings store their parameter in the slot to be evaluated when bound.
      *
-     * @param uniformName Name of the shader uniform.
-     * @param autoBinding Name of the auto binding.s
+     * @param slot The auto-binding to resolve.
      */
-    void applyAutoBinding(const char* uniformName, const char* autoBinding);
+    void applyAutoBinding(AutoBindingSlot& slot);
 
     /**
      * Binds the render state for this RenderState and any of its parents, top-down, 
@@ -657,8 +682,35 @@ protected:
      */
     void cloneInto(RenderState* renderState, NodeCloneContext& context) const;
 
+    /**
+     * Determines if this RenderState has the same parameters, auto-bindings and
+     * render states as the given RenderState, so that geometry drawn with either
+     * one is rendered identically.
+     *
+     * @param renderState The RenderState to compare with.
+     *
+     * @return true if both RenderStates are equivalent, false otherwise.
+     */
+    bool hasSameState(const RenderState* renderState) const;
+
 private:
 
+    /**
+     * The uniforms of an effect resolved for each of the MaterialParameters of this RenderState.
+     *
+     * When the effect declares a material uniform block, the table also holds the packed
+     * block data and the buffer it is uploaded into.
+     */
+    struct UniformTable
+    {
+        Effect* effect;
+        std::vector<Uniform*> uniforms;
+        GLuint blockBuffer;
+        std::vector<unsigned char> blockData;
+        std::vector<unsigned int> blockVersions;
+        bool blockDirty;
+    };
+
     /**
      * Constructor.
      */
@@ -679,22 +731,27 @@ private:
      */
     static int enumParse(const char* enumName, const char* str);
 
-    // Internal auto binding handler methods.
-    const Matrix& autoBindingGetWorldMatrix() const;
-    const Matrix& autoBindingGetViewMatrix() const;
-    const Matrix& autoBindingGetProjectionMatrix() const;
-    const Matrix& autoBindingGetWorldViewMatrix() const;
-    const Matrix& autoBindingGetViewProjectionMatrix() const;
-    const Matrix& autoBindingGetWorldViewProjectionMatrix() const;
-    const Matrix& autoBindingGetInverseTransposeWorldMatrix() const;
-    const Matrix& autoBindingGetInverseTransposeWorldViewMatrix() const;
-    Vector3 autoBindingGetCameraWorldPosition() const;
-    Vector3 autoBindingGetCameraViewPosition() const;
-    const Vector4* autoBindingGetMatrixPalette() const;
-    unsigned int autoBindingGetMatrixPaletteSize() const;
-    const Vector3& autoBindingGetAmbientColor() const;
-    const Vector3& autoBindingGetLightColor() const;
-    const Vector3& autoBindingGetLightDirection() const;
+    /**
+     * Gets the uniform table for the given effect, resolving the uniforms of all
+     * parameters if the table does not exist or the parameters have changed.
+     */
+    UniformTable* getUniformTable(Effect* effect) const;
+
+    /**
+     * Invalidates the resolved uniforms of all tables after the parameters have changed.
+     */
+    void resetUniformTables() const;
+
+    /**
+     * Binds (and uploads if changed) the material uniform block data of the given table.
+     */
+    static void bindUniformBlock(UniformTable* table);
+
+    /**
+     * Evaluates the resolved built-in auto-bindings of this render state, looking up
+     * the scene and active camera of the bound node only once.
+     */
+    void applyAutoBindingValues();
 
 protected:
 
@@ -704,9 +761,9 @@ protected:
     mutable std::vector<MaterialParameter*> _parameters;
 
     /**
-     * Map of parameter names to auto binding strings.
+     * The auto-bindings of this render state's parameters.
      */
-    std::map<std::string, std::string> _autoBindings;
+    std::vector<AutoBindingSlot> _autoBindings;
 
     /**
      * The Node bound to the RenderState.
@@ -727,6 +784,10 @@ protected:
      * Map of custom auto binding resolvers.
      */
     static std::vector<AutoBindingResolver*> _customAutoBindingResolvers;
+
+private:
+
+    mutable std::vector<UniformTable*> _uniformTables;
 };
 
 }
@@ -7,6 +7,7 @@
 #include "Terrain.h"
 #include "Bundle.h"
 #include "SerializerJson.h"
+#include "StaticBatcher.h"
 
 namespace gameplay
 {
@@ -61,7 +62,7 @@ static bool endsWith(const char* str, const char* suffix, bool ignoreCase)
 
 
 Scene::Scene() :
-    _id(""), _ambientColor(Vector3::zero()), _activeCamera(NULL), _bindAudioListenerToCamera(true),
+    _id(""), _ambientColor(Vector3::zero()), _staticBatchCellSize(0.0f), _activeCamera(NULL), _bindAudioListenerToCamera(true),
     _firstNode(NULL), _lastNode(NULL), _nodeCount(0), _nextItr(NULL), _nextReset(true)
 {
     __sceneList.push_back(this);
@@ -392,6 +393,16 @@ void Scene::setAmbientColor(const Vector3& color)
     _ambientColor = color;
 }
 
+float Scene::getStaticBatchCellSize() const
+{
+    return _staticBatchCellSize;
+}
+
+void Scene::setStaticBatchCellSize(float cellSize)
+{
+    _staticBatchCellSize = cellSize;
+}
+
 void Scene::update(float elapsedTime)
 {
     for (Node* node = _firstNode; node != NULL; node = node->_nextSibling)
@@ -478,6 +489,7 @@ void Scene::serialize(Serializer* serializer)
 {
     serializer->writeString("id", _id.c_str(), "");
     serializer->writeColor("ambientColor", _ambientColor, Vector3::zero());
+    serializer->writeFloat("staticBatchCellSize", _staticBatchCellSize, 0.0f);
     serializer->writeObjectList("nodes", _nodeCount);
     for (Node* node = getFirstNode(); node != NULL; node = node->getNextSibling())
     {
@@ -490,6 +502,8 @@ void Scene::deserialize(Serializer* serializer)
 {
     serializer->readString("id", _id, "");
     _ambientColor = serializer->readColor("ambientColor", Vector3::zero());
+    if (serializer->hasPropertiesOfVersion(4, 1))
+        _staticBatchCellSize = serializer->readFloat("staticBatchCellSize", 0.0f);
     unsigned int count = serializer->readObjectList("nodes");
     for (unsigned int i = 0; i < count; i++)
     {
@@ -498,6 +512,18 @@ void Scene::deserialize(Serializer* serializer)
             addNode(node);
     }
     _activeCamera = static_cast<Camera*>(serializer->readObject("activeCamera"));
+
+    if (_staticBatchCellSize > 0.0f)
+    {
+        StaticBatcher::Report report;
+        StaticBatcher::batch(this, _staticBatchCellSize, &report);
+        if (report.batchCount > 0)
+        {
+            Logger::log(Logger::LEVEL_INFO, "Scene '%s': merged %u static nodes into %u batches (%u draw calls to %u), %u vertices, %u indices, %u bytes of batched geometry from %u bytes of source geometry.\n",
+                _id.c_str(), report.nodeCount, report.batchCount, report.drawCallsBefore, report.drawCallsAfter,
+                report.vertexCount, report.indexCount, report.batchMemory, report.sourceMemory);
+        }
+    }
 }
 
 }
@@ -182,6 +182,26 @@ public:
      */
     void setAmbientColor(const Vector3& color);
 
+    /**
+     * Returns the size of the cells that the geometry of static nodes is batched into
+     * when the scene is loaded.
+     *
+     * The default cell size is zero, which disables static batching.
+     *
+     * @return The static batching cell size.
+     * @see StaticBatcher
+     */
+    float getStaticBatchCellSize() const;
+
+    /**
+     * Sets the size of the cells that the geometry of static nodes is batched into
+     * when the scene is loaded.
+     *
+     * @param cellSize The static batching cell size, or zero to disable static batching.
+     * @see getStaticBatchCellSize()
+     */
+    void setStaticBatchCellSize(float cellSize);
+
     /**
      * Updates all active nodes in the scene.
      *
@@ -326,6 +346,7 @@ private:
 
     std::string _id;
     Vector3 _ambientColor;
+    float _staticBatchCellSize;
     Camera* _activeCamera;
     bool _bindAudioListenerToCamera;
     Node* _firstNode;
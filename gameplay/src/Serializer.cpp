@@ -7,6 +7,7 @@
 #include "MeshPart.h"
 #include "Joint.h"
 #include "Animation.h"
+#include "TextureAtlas.h"
 
 namespace gameplay
 {
@@ -41,6 +42,7 @@ void Serializer::Activator::initializeClasses()
     Serializer::getActivator()->registerClass("gameplay::Texture", &Texture::createInstance);
     Serializer::getActivator()->registerClass("gameplay::Texture::Sampler", &Texture::Sampler::createInstance);
     Serializer::getActivator()->registerClass("gameplay::Animation", &Animation::createInstance);
+    Serializer::getActivator()->registerClass("gameplay::TextureAtlas", &TextureAtlas::createInstance);
     // TODO: All the other classes...
 }
 
@@ -207,4 +209,14 @@ unsigned int Serializer::getVersionMinor() const
     return (unsigned int)_version[1];
 }
 
+bool Serializer::isVersionAtLeast(unsigned int major, unsigned int minor) const
+{
+    return getVersionMajor() > major || (getVersionMajor() == major && getVersionMinor() >= minor);
+}
+
+bool Serializer::hasPropertiesOfVersion(unsigned int major, unsigned int minor) const
+{
+    return getFormat() == JSON || isVersionAtLeast(major, minor);
+}
+
 }
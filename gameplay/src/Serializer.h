@@ -11,7 +11,9 @@ class Vector4;
 class Matrix;
 class Stream;
 
-const unsigned char SERIALIZER_VERSION[2] = {4, 0};
+// Version 4.1 adds Node "static", Scene "staticBatchCellSize" and the Game::Config
+// "programCache" and "shaderWarmUp" properties.
+const unsigned char SERIALIZER_VERSION[2] = {4, 1};
 
 /**
  * Defines an abstract class for reading/writing an objects data to a stream.
@@ -89,6 +91,34 @@ public:
      */
     virtual unsigned int getVersionMinor() const;
 
+    /**
+     * Determines if the loaded bundle is at least the given version.
+     *
+     * Binary bundles store properties by position, so properties added in later
+     * versions must only be read from bundles that have them.
+     *
+     * @param major The major version.
+     * @param minor The minor version.
+     *
+     * @return true if the bundle version is the given version or later, false otherwise.
+     */
+    bool isVersionAtLeast(unsigned int major, unsigned int minor) const;
+
+    /**
+     * Determines if properties added in the given version can be read from the loaded bundle.
+     *
+     * JSON bundles are read by property name, so a missing property simply reads as its
+     * default value and files declaring an older version still have their newer properties
+     * read. Binary bundles are read by position, so the properties are only read from
+     * bundles of at least the given version.
+     *
+     * @param major The major version that added the properties.
+     * @param minor The minor version that added the properties.
+     *
+     * @return true if the properties can be read, false otherwise.
+     */
+    bool hasPropertiesOfVersion(unsigned int major, unsigned int minor) const;
+
     /**
      * Writes a enumerated value.
      *
@@ -67,6 +67,7 @@ const char* Slider::getScriptClassName() const
 void Slider::setMin(float min)
 {
     _min = min;
+    setDirty(DIRTY_GEOMETRY);
 }
 
 float Slider::getMin() const
@@ -77,6 +78,7 @@ float Slider::getMin() const
 void Slider::setMax(float max)
 {
     _max = max;
+    setDirty(DIRTY_GEOMETRY);
 }
 
 float Slider::getMax() const
@@ -106,6 +108,7 @@ void Slider::setValue(float value)
     if (value != _value)
     {
         _value = value;
+        setDirty(DIRTY_GEOMETRY);
         notifyListeners(Control::Listener::VALUE_CHANGED);
     }
 
@@ -1,6 +1,7 @@
 #include "Base.h"
 #include "Sprite.h"
 #include "Scene.h"
+#include "TextureAtlas.h"
 
 namespace gameplay
 {
@@ -36,14 +37,24 @@ Sprite* Sprite::create(const char* imagePath, float width, float height,
     GP_ASSERT(source.width >= -1 && source.height >= -1);
     GP_ASSERT(frameCount > 0);
     
-    SpriteBatch* batch = SpriteBatch::create(imagePath, effect);
+    // Draw the image from an atlas page when it was packed into a registered atlas.
+    Texture* atlasTexture = NULL;
+    Rectangle region;
+    SpriteBatch* batch;
+    if (TextureAtlas::lookup(imagePath, &atlasTexture, &region))
+        batch = SpriteBatch::create(atlasTexture, effect);
+    else
+        batch = SpriteBatch::create(imagePath, effect);
     batch->getSampler()->setWrapMode(Texture::CLAMP, Texture::CLAMP);
     batch->getSampler()->setFilterMode(Texture::Filter::LINEAR, Texture::Filter::LINEAR);
     batch->getStateBlock()->setDepthWrite(false);
     batch->getStateBlock()->setDepthTest(true);
     
-    unsigned int imageWidth = batch->getSampler()->getTexture()->getWidth();
-    unsigned int imageHeight = batch->getSampler()->getTexture()->getHeight();
+    Texture* texture = batch->getSampler()->getTexture();
+    if (region.isEmpty())
+        region.set(0, 0, texture->getWidth(), texture->getHeight());
+    unsigned int imageWidth = (unsigned int)region.width;
+    unsigned int imageHeight = (unsigned int)region.height;
     if (width == -1)
         width = imageWidth;
     if (height == -1)
@@ -53,6 +64,7 @@ Sprite* Sprite::create(const char* imagePath, float width, float height,
     sprite->_width = width;
     sprite->_height = height;
     sprite->_batch = batch;
+    sprite->_imageRegion = region;
     sprite->_frameCount = frameCount;
     sprite->_frames = new Rectangle[frameCount];
     sprite->_frames[0] = source;
@@ -429,8 +441,8 @@ void Sprite::computeFrames(unsigned int frameStride, unsigned int framePadding)
     
     if (_frameCount < 2)
         return;
-    unsigned int imageWidth = _batch->getSampler()->getTexture()->getWidth();
-    unsigned int imageHeight = _batch->getSampler()->getTexture()->getHeight();
+    unsigned int imageWidth = (unsigned int)_imageRegion.width;
+    unsigned int imageHeight = (unsigned int)_imageRegion.height;
     float textureWidthRatio = 1.0f / imageWidth;
     float textureHeightRatio = 1.0f / imageHeight;
     
@@ -636,9 +648,14 @@ unsigned int Sprite::draw(bool wireframe)
         scale.y = -scale.y;
     }
     
+    // Frames are relative to the image, which may be a region of an atlas page.
+    Rectangle source = _frames[_frameIndex];
+    source.x += _imageRegion.x;
+    source.y += _imageRegion.y;
+
     // TODO: Proper batching from cache based on batching rules (image, layers, etc)
     _batch->start();
-    _batch->draw(position, _frames[_frameIndex], scale, Vector4(_color.x, _color.y, _color.z, _color.w * _opacity),
+    _batch->draw(position, source, scale, Vector4(_color.x, _color.y, _color.z, _color.w * _opacity),
                  _anchor, rotationAngle);
     _batch->finish();
     
@@ -678,6 +695,7 @@ Drawable* Sprite::clone(NodeCloneContext& context)
     spriteClone->_framePadding = _framePadding;
     spriteClone->_frameIndex = _frameIndex;
     spriteClone->_batch = _batch;
+    spriteClone->_imageRegion = _imageRegion;
 
     return spriteClone;
 }
@@ -390,6 +390,7 @@ private:
     unsigned int _framePadding;
     unsigned int _frameIndex;
     SpriteBatch* _batch;
+    Rectangle _imageRegion;
     float _opacity;
     Vector4 _color;
     BlendMode _blendMode;
@@ -2,6 +2,8 @@
 #include "SpriteBatch.h"
 #include "Game.h"
 #include "Material.h"
+#include "RenderCommandList.h"
+#include "SpriteBatcher.h"
 
 // Default size of a newly created sprite batch
 #define SPRITE_BATCH_DEFAULT_SIZE 128
@@ -23,9 +25,10 @@ namespace gameplay
 {
 
 static Effect* __spriteEffect = NULL;
+static SpriteBatcher* __spriteBatcher = NULL;
 
 SpriteBatch::SpriteBatch()
-    : _batch(NULL), _sampler(NULL), _textureWidthRatio(0.0f), _textureHeightRatio(0.0f)
+    : _batch(NULL), _sampler(NULL), _capturedVertices(NULL), _textureWidthRatio(0.0f), _textureHeightRatio(0.0f)
 {
 }
 
@@ -142,6 +145,10 @@ SpriteBatch* SpriteBatch::create(Texture* texture,  Effect* effect, unsigned int
 
 void SpriteBatch::start()
 {
+    // Sprites collected by a sprite batcher are drawn by the batcher.
+    if (__spriteBatcher)
+        return;
+
     _batch->start();
 }
 
@@ -232,7 +239,7 @@ void SpriteBatch::draw(float x, float y, float z, float width, float height, flo
     
     static unsigned short indices[4] = { 0, 1, 2, 3 };
 
-    _batch->add(v, 4, indices, 4);
+    add(v, 4, indices, 4);
 }
 
 void SpriteBatch::draw(const Vector3& position, const Vector3& right, const Vector3& forward, float width, float height,
@@ -297,7 +304,7 @@ void SpriteBatch::draw(const Vector3& position, const Vector3& right, const Vect
     SPRITE_ADD_VERTEX(v[3], p3.x, p3.y, p3.z, u2, v2, color.x, color.y, color.z, color.w);
     
     static const unsigned short indices[4] = { 0, 1, 2, 3 };
-    _batch->add(v, 4, const_cast<unsigned short*>(indices), 4);
+    add(v, 4, indices, 4);
 }
 
 void SpriteBatch::draw(float x, float y, float width, float height, float u1, float v1, float u2, float v2, const Vector4& color)
@@ -352,7 +359,7 @@ void SpriteBatch::draw(SpriteBatch::SpriteVertex* vertices, unsigned int vertexC
     GP_ASSERT(vertices);
     GP_ASSERT(indices);
 
-    _batch->add(vertices, vertexCount, indices, indexCount);
+    add(vertices, vertexCount, indices, indexCount);
 }
 
 void SpriteBatch::draw(float x, float y, float z, float width, float height, float u1, float v1, float u2, float v2, const Vector4& color, bool positionIsCenter)
@@ -375,14 +382,38 @@ void SpriteBatch::draw(float x, float y, float z, float width, float height, flo
 
     static unsigned short indices[4] = { 0, 1, 2, 3 };
 
-    _batch->add(v, 4, indices, 4);
+    add(v, 4, indices, 4);
 }
 
 void SpriteBatch::finish()
 {
-    // Finish and draw the batch
+    finish(RenderCommandList::getImmediate());
+}
+
+void SpriteBatch::finish(RenderCommandList* list)
+{
+    if (__spriteBatcher)
+        return;
+
+    // Finish and record the batch
     _batch->finish();
-    _batch->draw();
+    _batch->record(list);
+}
+
+void SpriteBatch::add(const SpriteBatch::SpriteVertex* vertices, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount)
+{
+    if (_capturedVertices)
+        _capturedVertices->insert(_capturedVertices->end(), vertices, vertices + vertexCount);
+
+    if (__spriteBatcher)
+        __spriteBatcher->add(this, vertices, vertexCount, indices, indexCount);
+    else
+        _batch->add(vertices, vertexCount, indices, indexCount);
+}
+
+void SpriteBatch::setBatcher(SpriteBatcher* batcher)
+{
+    __spriteBatcher = batcher;
 }
 
 RenderState::StateBlock* SpriteBatch::getStateBlock() const
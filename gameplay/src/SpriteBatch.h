@@ -12,6 +12,8 @@
 namespace gameplay
 {
 
+class SpriteBatcher;
+
 /**
  * Defines a class for drawing groups of sprites.
  *
@@ -26,7 +28,9 @@ class SpriteBatch
 {
     friend class Bundle;
     friend class Font;
+    friend class Form;
     friend class Text;
+    friend class SpriteBatcher;
 
 public:
 
@@ -307,6 +311,17 @@ public:
      */
     void finish();
 
+    /**
+     * Finishes sprite drawing and records the commands that draw the sprites into a
+     * command list instead of drawing them.
+     *
+     * The sprites are drawn from the batch's memory, so the batch must not be started
+     * again until the list has been executed.
+     *
+     * @param list The command list to record into.
+     */
+    void finish(RenderCommandList* list);
+
     /**
      * Gets the texture sampler. 
      *
@@ -402,8 +417,29 @@ private:
 
     bool clipSprite(const Rectangle& clip, float& x, float& y, float& width, float& height, float& u1, float& v1, float& u2, float& v2);
 
+    /**
+     * Adds vertices to the batch, or to the sprite batcher that is collecting sprites.
+     *
+     * The vertices are also appended to the captured vertices when set, which fonts use
+     * to cache the glyph quads of their text layouts.
+     *
+     * @param vertices The vertices to add.
+     * @param vertexCount The number of vertices.
+     * @param indices The indices of the triangle strip.
+     * @param indexCount The number of indices.
+     */
+    void add(const SpriteBatch::SpriteVertex* vertices, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount);
+
+    /**
+     * Sets the sprite batcher that collects the sprites of all sprite batches instead of drawing them.
+     *
+     * @param batcher The sprite batcher, or NULL to draw sprites normally.
+     */
+    static void setBatcher(SpriteBatcher* batcher);
+
     MeshBatch* _batch;
     Texture::Sampler* _sampler;
+    std::vector<SpriteVertex>* _capturedVertices;
     bool _customEffect;
     float _textureWidthRatio;
     float _textureHeightRatio;
@@ -0,0 +1,168 @@
+#include "Base.h"
+#include "SpriteBatcher.h"
+#include "Drawable.h"
+#include "Material.h"
+#include "Technique.h"
+
+// Maximum number of vertices or indices drawn per flush, which keeps the 16-bit indices of the sprite batches in range.
+#define SPRITE_BATCHER_MAX_FLUSH_SIZE 32768
+
+namespace gameplay
+{
+
+SpriteBatcher::SpriteBatcher()
+    : _drawableCount(0), _flushCount(0), _drawCallCount(0), _started(false)
+{
+}
+
+SpriteBatcher::~SpriteBatcher()
+{
+}
+
+SpriteBatcher* SpriteBatcher::create()
+{
+    return new SpriteBatcher();
+}
+
+bool SpriteBatcher::Entry::operator<(const Entry& entry) const
+{
+    if (z != entry.z)
+        return z < entry.z;
+    if (group != entry.group)
+        return group < entry.group;
+    return order < entry.order;
+}
+
+void SpriteBatcher::start()
+{
+    _groups.clear();
+    _batchGroups.clear();
+    _entries.clear();
+    _vertices.clear();
+    _indices.clear();
+    _drawableCount = 0;
+    _started = true;
+}
+
+void SpriteBatcher::add(Drawable* drawable)
+{
+    GP_ASSERT(_started);
+    GP_ASSERT(drawable);
+
+    // Capture the sprites the drawable sends to its sprite batches.
+    SpriteBatch::setBatcher(this);
+    drawable->draw();
+    SpriteBatch::setBatcher(NULL);
+    ++_drawableCount;
+}
+
+void SpriteBatcher::add(SpriteBatch* batch, const SpriteBatch::SpriteVertex* vertices, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount)
+{
+    GP_ASSERT(batch);
+    GP_ASSERT(vertices && vertexCount > 0);
+    GP_ASSERT(indices);
+
+    Entry entry;
+    entry.z = vertices[0].z;
+    entry.group = getGroup(batch);
+    entry.order = (unsigned int)_entries.size();
+    entry.vertexOffset = (unsigned int)_vertices.size();
+    entry.vertexCount = vertexCount;
+    entry.indexOffset = (unsigned int)_indices.size();
+    entry.indexCount = indexCount;
+    _entries.push_back(entry);
+
+    _vertices.insert(_vertices.end(), vertices, vertices + vertexCount);
+    _indices.insert(_indices.end(), indices, indices + indexCount);
+}
+
+unsigned int SpriteBatcher::getGroup(SpriteBatch* batch)
+{
+    std::map<SpriteBatch*, unsigned int>::const_iterator itr = _batchGroups.find(batch);
+    if (itr != _batchGroups.end())
+        return itr->second;
+
+    // Sprite batches with equivalent materials (which covers the texture, effect and
+    // blend mode) and the same projection can be drawn together.
+    const Matrix& projection = batch->getProjectionMatrix();
+    Material* material = batch->getMaterial();
+    GP_ASSERT(material);
+    unsigned int group = (unsigned int)_groups.size();
+    for (unsigned int i = 0, count = (unsigned int)_groups.size(); i < count; ++i)
+    {
+        const Group& other = _groups[i];
+        if (memcmp(projection.m, other.projection.m, sizeof(projection.m)) == 0 && material->isEquivalent(other.batch->getMaterial()))
+        {
+            group = i;
+            break;
+        }
+    }
+    if (group == _groups.size())
+    {
+        Group newGroup;
+        newGroup.batch = batch;
+        newGroup.projection = projection;
+        _groups.push_back(newGroup);
+    }
+
+    _batchGroups[batch] = group;
+    return group;
+}
+
+unsigned int SpriteBatcher::finish()
+{
+    GP_ASSERT(_started);
+    _started = false;
+    _flushCount = 0;
+    _drawCallCount = 0;
+
+    std::stable_sort(_entries.begin(), _entries.end());
+
+    // Draw each run of entries in the same group through the first sprite batch of the group.
+    for (size_t i = 0, count = _entries.size(); i < count; )
+    {
+        const Group& group = _groups[_entries[i].group];
+        SpriteBatch* batch = group.batch;
+        Matrix projection = batch->getProjectionMatrix();
+        batch->setProjectionMatrix(group.projection);
+        batch->start();
+        size_t end = i;
+        unsigned int flushSize = 0;
+        for (; end < count && _entries[end].group == _entries[i].group; ++end)
+        {
+            const Entry& entry = _entries[end];
+            unsigned int entrySize = std::max(entry.vertexCount, entry.indexCount + 2);
+            if (flushSize > 0 && flushSize + entrySize > SPRITE_BATCHER_MAX_FLUSH_SIZE)
+                break;
+            flushSize += entrySize;
+            batch->_batch->add(&_vertices[entry.vertexOffset], entry.vertexCount, &_indices[entry.indexOffset], entry.indexCount);
+        }
+        batch->finish();
+        batch->setProjectionMatrix(projection);
+
+        Technique* technique = batch->getMaterial()->getTechnique();
+        GP_ASSERT(technique);
+        ++_flushCount;
+        _drawCallCount += technique->getPassCount();
+        i = end;
+    }
+
+    return _drawCallCount;
+}
+
+unsigned int SpriteBatcher::getDrawableCount() const
+{
+    return _drawableCount;
+}
+
+unsigned int SpriteBatcher::getFlushCount() const
+{
+    return _flushCount;
+}
+
+unsigned int SpriteBatcher::getDrawCallCount() const
+{
+    return _drawCallCount;
+}
+
+}
@@ -0,0 +1,146 @@
+#ifndef SPRITEBATCHER_H_
+#define SPRITEBATCHER_H_
+
+#include "SpriteBatch.h"
+
+namespace gameplay
+{
+
+class Drawable;
+
+/**
+ * Defines a class for drawing the sprites of many 2D drawables with as few draw calls as possible.
+ *
+ * Sprite, TileSet, Text and ParticleEmitter drawables each draw through their own SpriteBatch,
+ * which costs at least one draw call per drawable. Drawables added to a sprite batcher do not
+ * draw; instead the quads they emit are collected and, when the batcher is finished, sorted by
+ * increasing z and then by sprite batch, and the quads of consecutive sprite batches that use
+ * the same texture, effect, render state and projection are drawn together.
+ *
+ * Since quads with the same z are sorted by texture, overlapping sprites that are blended
+ * should be given different z values to keep their drawing order.
+ *
+ * Drawables that do not draw through a SpriteBatch, such as models, are drawn immediately
+ * when they are added.
+ *
+ * @code
+ * _batcher->start();
+ * scene->visit(this, &MyGame::batchNode); // calls _batcher->add(node->getDrawable()) for each 2D node
+ * _batcher->finish();
+ * @endcode
+ */
+class SpriteBatcher
+{
+    friend class SpriteBatch;
+
+public:
+
+    /**
+     * Creates a new sprite batcher.
+     *
+     * @return A new sprite batcher.
+     * @script{create}
+     */
+    static SpriteBatcher* create();
+
+    /**
+     * Destructor.
+     */
+    ~SpriteBatcher();
+
+    /**
+     * Starts collecting sprites, discarding the sprites collected previously.
+     */
+    void start();
+
+    /**
+     * Adds the sprites of a drawable to the batcher.
+     *
+     * @param drawable The drawable to add.
+     */
+    void add(Drawable* drawable);
+
+    /**
+     * Sorts and draws the collected sprites.
+     *
+     * @return The number of draw calls issued.
+     */
+    unsigned int finish();
+
+    /**
+     * Gets the number of drawables added since the batcher was started.
+     *
+     * @return The number of drawables.
+     */
+    unsigned int getDrawableCount() const;
+
+    /**
+     * Gets the number of batch flushes performed by the last call to finish.
+     *
+     * Each flush draws a run of sprites that share their texture and render state.
+     *
+     * @return The number of flushes.
+     */
+    unsigned int getFlushCount() const;
+
+    /**
+     * Gets the number of draw calls issued by the last call to finish.
+     *
+     * @return The number of draw calls.
+     */
+    unsigned int getDrawCallCount() const;
+
+private:
+
+    struct Group
+    {
+        SpriteBatch* batch;
+        Matrix projection;
+    };
+
+    struct Entry
+    {
+        float z;
+        unsigned int group;
+        unsigned int order;
+        unsigned int vertexOffset;
+        unsigned int vertexCount;
+        unsigned int indexOffset;
+        unsigned int indexCount;
+
+        bool operator<(const Entry& entry) const;
+    };
+
+    /**
+     * Constructor.
+     */
+    SpriteBatcher();
+
+    /**
+     * Hidden copy constructor.
+     */
+    SpriteBatcher(const SpriteBatcher& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    SpriteBatcher& operator=(const SpriteBatcher&);
+
+    void add(SpriteBatch* batch, const SpriteBatch::SpriteVertex* vertices, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount);
+
+    unsigned int getGroup(SpriteBatch* batch);
+
+    std::vector<Group> _groups;
+    std::map<SpriteBatch*, unsigned int> _batchGroups;
+    std::vector<Entry> _entries;
+    std::vector<SpriteBatch::SpriteVertex> _vertices;
+    std::vector<unsigned short> _indices;
+    unsigned int _drawableCount;
+    unsigned int _flushCount;
+    unsigned int _drawCallCount;
+    bool _started;
+};
+
+}
+
+#endif
@@ -0,0 +1,499 @@
+#include "Base.h"
+#include "StaticBatcher.h"
+#include "Scene.h"
+#include "Model.h"
+#include "MeshPart.h"
+#include "Material.h"
+
+// Batches are indexed with 16-bit indices.
+#define STATICBATCHER_MAX_VERTICES 65535
+
+namespace gameplay
+{
+
+/**
+ * A mesh part of a static node that is merged into a batch.
+ */
+struct BatchSource
+{
+    Node* node;
+    Model* model;
+    int partIndex;
+    std::vector<unsigned int> indices;
+};
+
+/**
+ * The mesh parts sharing an equivalent material and vertex format in one cell.
+ */
+struct BatchGroup
+{
+    Material* material;
+    const VertexFormat* format;
+    int cell[3];
+    std::vector<BatchSource> sources;
+};
+
+/**
+ * The merged geometry of a group (or of one chunk of a group that exceeds the index range).
+ */
+struct BatchChunk
+{
+    std::vector<unsigned char> vertices;
+    std::vector<unsigned short> indices;
+    unsigned int vertexCount;
+};
+
+StaticBatcher::Report::Report()
+    : nodeCount(0), batchCount(0), drawCallsBefore(0), drawCallsAfter(0), vertexCount(0), indexCount(0),
+      sourceMemory(0), batchMemory(0)
+{
+}
+
+StaticBatcher::StaticBatcher()
+{
+}
+
+static void collectNodes(Node* node, std::vector<Node*>& nodes)
+{
+    for (; node != NULL; node = node->getNextSibling())
+    {
+        if (!node->isEnabled())
+            continue;
+        nodes.push_back(node);
+        collectNodes(node->getFirstChild(), nodes);
+    }
+}
+
+static Model* getBatchableModel(Node* node)
+{
+    if (!node->isStatic())
+        return NULL;
+
+    Model* model = dynamic_cast<Model*>(node->getDrawable());
+    if (model == NULL || model->getSkin())
+        return NULL;
+
+    Mesh* mesh = model->getMesh();
+    GP_ASSERT(mesh);
+    if (mesh->getVertexCount() == 0 || mesh->getVertexCount() > STATICBATCHER_MAX_VERTICES)
+        return NULL;
+
+    // The positions must be transformable into world space.
+    const VertexFormat& format = mesh->getVertexFormat();
+    bool hasPosition = false;
+    for (unsigned int i = 0, count = format.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& e = format.getElement(i);
+        if (e.usage == VertexFormat::POSITION && e.size >= 3)
+            hasPosition = true;
+    }
+    if (!hasPosition)
+        return NULL;
+
+    // Only triangle lists can be merged.
+    unsigned int partCount = mesh->getPartCount();
+    if (partCount == 0)
+        return (mesh->getPrimitiveType() == Mesh::TRIANGLES && model->getMaterial()) ? model : NULL;
+    for (unsigned int i = 0; i < partCount; ++i)
+    {
+        MeshPart* part = mesh->getPart(i);
+        GP_ASSERT(part);
+        if (part->getPrimitiveType() != Mesh::TRIANGLES || model->getMaterial(i) == NULL)
+            return NULL;
+    }
+    return model;
+}
+
+static BatchGroup* getGroup(std::vector<BatchGroup*>& groups, Material* material, const VertexFormat& format, const int* cell)
+{
+    for (size_t i = 0, count = groups.size(); i < count; ++i)
+    {
+        BatchGroup* group = groups[i];
+        if (group->cell[0] == cell[0] && group->cell[1] == cell[1] && group->cell[2] == cell[2] &&
+            *group->format == format && group->material->isEquivalent(material))
+        {
+            return group;
+        }
+    }
+
+    BatchGroup* group = new BatchGroup();
+    group->material = material;
+    group->format = &format;
+    group->cell[0] = cell[0];
+    group->cell[1] = cell[1];
+    group->cell[2] = cell[2];
+    groups.push_back(group);
+    return group;
+}
+
+static const unsigned char* getVertexData(Mesh* mesh, std::map<Mesh*, std::vector<unsigned char> >& cache)
+{
+    std::map<Mesh*, std::vector<unsigned char> >::iterator itr = cache.find(mesh);
+    if (itr != cache.end())
+        return &itr->second[0];
+
+    std::vector<unsigned char>& data = cache[mesh];
+    data.resize(mesh->getVertexSize() * mesh->getVertexCount());
+    do
+    {
+        const void* vertices = mesh->mapVertexBuffer();
+        if (vertices == NULL)
+        {
+            GP_WARN("Failed to read back the vertex data of mesh '%s'.", mesh->getUrl());
+            cache.erase(mesh);
+            return NULL;
+        }
+        memcpy(&data[0], vertices, data.size());
+    } while (!mesh->unmapVertexBuffer());
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+
+    return &data[0];
+}
+
+static bool getIndexData(Mesh* mesh, int partIndex, std::vector<unsigned int>& indices)
+{
+    if (partIndex < 0)
+    {
+        indices.resize(mesh->getVertexCount());
+        for (unsigned int i = 0, count = mesh->getVertexCount(); i < count; ++i)
+            indices[i] = i;
+        return true;
+    }
+
+    MeshPart* part = mesh->getPart(partIndex);
+    GP_ASSERT(part);
+    unsigned int count = part->getIndexCount();
+    indices.resize(count);
+    do
+    {
+        const void* data = part->mapIndexBuffer();
+        if (data == NULL)
+        {
+            GP_WARN("Failed to read back the index data of mesh '%s'.", mesh->getUrl());
+            GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+            return false;
+        }
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            switch (part->getIndexFormat())
+            {
+            case Mesh::INDEX8:
+                indices[i] = ((const unsigned char*)data)[i];
+                break;
+            case Mesh::INDEX16:
+                indices[i] = ((const unsigned short*)data)[i];
+                break;
+            case Mesh::INDEX32:
+                indices[i] = ((const unsigned int*)data)[i];
+                break;
+            }
+        }
+    } while (!part->unmapIndexBuffer());
+    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+
+    return true;
+}
+
+static void transformVertices(float* vertices, unsigned int vertexCount, const VertexFormat& format, const Matrix& world, const Matrix& normalMatrix)
+{
+    unsigned int stride = format.getVertexSize() / sizeof(float);
+    unsigned int offset = 0;
+    for (unsigned int i = 0, count = format.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& e = format.getElement(i);
+        if (e.size >= 3)
+        {
+            for (unsigned int j = 0; j < vertexCount; ++j)
+            {
+                float* v = vertices + j * stride + offset;
+                Vector3 value(v);
+                switch (e.usage)
+                {
+                case VertexFormat::POSITION:
+                    world.transformPoint(&value);
+                    break;
+                case VertexFormat::NORMAL:
+                    normalMatrix.transformVector(&value);
+                    value.normalize();
+                    break;
+                case VertexFormat::TANGENT:
+                case VertexFormat::BINORMAL:
+                    world.transformVector(&value);
+                    value.normalize();
+                    break;
+                default:
+                    continue;
+                }
+                v[0] = value.x;
+                v[1] = value.y;
+                v[2] = value.z;
+            }
+        }
+        offset += e.size;
+    }
+}
+
+static Mesh* createBatchMesh(const VertexFormat& format, const BatchChunk& chunk)
+{
+    Mesh* mesh = Mesh::createMesh(format, chunk.vertexCount, false);
+    if (mesh == NULL)
+        return NULL;
+    mesh->setVertexData(&chunk.vertices[0], 0, chunk.vertexCount);
+
+    MeshPart* part = mesh->addPart(Mesh::TRIANGLES, Mesh::INDEX16, (unsigned int)chunk.indices.size(), false);
+    if (part == NULL)
+    {
+        SAFE_RELEASE(mesh);
+        return NULL;
+    }
+    part->setIndexData(&chunk.indices[0], 0, (unsigned int)chunk.indices.size());
+
+    // The position is the first element with three or more components.
+    unsigned int stride = format.getVertexSize() / sizeof(float);
+    unsigned int offset = 0;
+    for (unsigned int i = 0, count = format.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& e = format.getElement(i);
+        if (e.usage == VertexFormat::POSITION && e.size >= 3)
+            break;
+        offset += e.size;
+    }
+    const float* vertices = (const float*)&chunk.vertices[0];
+    Vector3 min(vertices + offset);
+    Vector3 max(min);
+    for (unsigned int i = 1; i < chunk.vertexCount; ++i)
+    {
+        const float* p = vertices + i * stride + offset;
+        min.set(std::min(min.x, p[0]), std::min(min.y, p[1]), std::min(min.z, p[2]));
+        max.set(std::max(max.x, p[0]), std::max(max.y, p[1]), std::max(max.z, p[2]));
+    }
+    BoundingBox box(min, max);
+    mesh->setBoundingBox(box);
+    BoundingSphere sphere;
+    sphere.set(box);
+    mesh->setBoundingSphere(sphere);
+
+    return mesh;
+}
+
+unsigned int StaticBatcher::batch(Scene* scene, float cellSize, Report* report)
+{
+    GP_ASSERT(scene);
+
+    Report result;
+
+    // Group the mesh parts of the static nodes by material, vertex format and cell.
+    // The geometry is read back first so that a node is either merged entirely or not at all.
+    std::vector<Node*> nodes;
+    collectNodes(scene->getFirstNode(), nodes);
+    std::map<Mesh*, std::vector<unsigned char> > vertexCache;
+    std::vector<BatchGroup*> groups;
+    std::vector<BatchSource> sources;
+    for (size_t i = 0, count = nodes.size(); i < count; ++i)
+    {
+        Node* node = nodes[i];
+        Model* model = getBatchableModel(node);
+        if (model == NULL)
+            continue;
+
+        Mesh* mesh = model->getMesh();
+        if (getVertexData(mesh, vertexCache) == NULL)
+            continue;
+        unsigned int partCount = mesh->getPartCount();
+        sources.resize(partCount > 0 ? partCount : 1);
+        bool valid = true;
+        for (int j = partCount > 0 ? 0 : -1; j < (int)partCount && valid; ++j)
+        {
+            BatchSource& source = sources[j < 0 ? 0 : j];
+            source.node = node;
+            source.model = model;
+            source.partIndex = j;
+            valid = getIndexData(mesh, j, source.indices);
+        }
+        if (!valid)
+            continue;
+
+        int cell[3] = { 0, 0, 0 };
+        if (cellSize > 0.0f)
+        {
+            const Vector3& center = node->getBoundingSphere().center;
+            cell[0] = (int)floorf(center.x / cellSize);
+            cell[1] = (int)floorf(center.y / cellSize);
+            cell[2] = (int)floorf(center.z / cellSize);
+        }
+
+        for (size_t j = 0, sourceCount = sources.size(); j < sourceCount; ++j)
+        {
+            BatchGroup* group = getGroup(groups, model->getMaterial(sources[j].partIndex), mesh->getVertexFormat(), cell);
+            group->sources.push_back(sources[j]);
+        }
+    }
+
+    // Merging a single mesh part saves no draw calls. A node is only merged when all of its
+    // mesh parts are, so leaving out a node may leave other groups with a single part.
+    std::set<Node*> rejected;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 0, count = groups.size(); i < count; ++i)
+        {
+            std::vector<BatchSource>& sources = groups[i]->sources;
+            Node* remaining = NULL;
+            unsigned int remainingCount = 0;
+            for (size_t j = 0, sourceCount = sources.size(); j < sourceCount; ++j)
+            {
+                if (rejected.find(sources[j].node) == rejected.end())
+                {
+                    remaining = sources[j].node;
+                    ++remainingCount;
+                }
+            }
+            if (remainingCount == 1)
+            {
+                rejected.insert(remaining);
+                changed = true;
+            }
+        }
+    }
+
+    // Merge the groups into chunks of pre-transformed geometry.
+    std::set<Node*> merged;
+    std::set<Mesh*> mergedMeshes;
+    std::vector<Mesh*> batchMeshes;
+    std::vector<Material*> batchMaterials;
+    std::vector<int> remap;
+    for (size_t i = 0, count = groups.size(); i < count; ++i)
+    {
+        BatchGroup* group = groups[i];
+        const VertexFormat& format = *group->format;
+        unsigned int vertexSize = format.getVertexSize();
+
+        BatchChunk chunk;
+        chunk.vertexCount = 0;
+        for (size_t j = 0, sourceCount = group->sources.size(); j <= sourceCount; ++j)
+        {
+            const BatchSource* source = j < sourceCount ? &group->sources[j] : NULL;
+            if (source && rejected.find(source->node) != rejected.end())
+                continue;
+
+            Mesh* mesh = source ? source->model->getMesh() : NULL;
+            const unsigned char* vertexData = NULL;
+            unsigned int usedCount = 0;
+            if (source)
+            {
+                vertexData = getVertexData(mesh, vertexCache);
+                GP_ASSERT(vertexData);
+                remap.assign(mesh->getVertexCount(), -1);
+                const std::vector<unsigned int>& indices = source->indices;
+                for (size_t k = 0, indexCount = indices.size(); k < indexCount; ++k)
+                {
+                    if (remap[indices[k]] < 0)
+                    {
+                        remap[indices[k]] = 0;
+                        ++usedCount;
+                    }
+                }
+                remap.assign(mesh->getVertexCount(), -1);
+            }
+
+            // Start a new chunk when the part does not fit, or emit the last one.
+            if (chunk.vertexCount > 0 && (source == NULL || chunk.vertexCount + usedCount > STATICBATCHER_MAX_VERTICES))
+            {
+                Mesh* batchMesh = createBatchMesh(format, chunk);
+                if (batchMesh)
+                {
+                    batchMeshes.push_back(batchMesh);
+                    batchMaterials.push_back(group->material);
+                    group->material->addRef();
+                    result.vertexCount += chunk.vertexCount;
+                    result.indexCount += (unsigned int)chunk.indices.size();
+                    result.batchMemory += chunk.vertexCount * vertexSize + (unsigned int)chunk.indices.size() * sizeof(unsigned short);
+                }
+                chunk.vertices.clear();
+                chunk.indices.clear();
+                chunk.vertexCount = 0;
+            }
+            if (source == NULL)
+                break;
+
+            // Copy the vertices used by the part and transform them into world space.
+            const std::vector<unsigned int>& indices = source->indices;
+            unsigned int firstVertex = chunk.vertexCount;
+            chunk.vertices.resize((firstVertex + usedCount) * vertexSize);
+            for (size_t k = 0, indexCount = indices.size(); k < indexCount; ++k)
+            {
+                unsigned int index = indices[k];
+                if (remap[index] < 0)
+                {
+                    remap[index] = (int)chunk.vertexCount;
+                    memcpy(&chunk.vertices[chunk.vertexCount * vertexSize], vertexData + index * vertexSize, vertexSize);
+                    ++chunk.vertexCount;
+                }
+            }
+            const Matrix& world = source->node->getWorldMatrix();
+            Matrix normalMatrix;
+            world.invert(&normalMatrix);
+            normalMatrix.transpose();
+            transformVertices((float*)&chunk.vertices[firstVertex * vertexSize], usedCount, format, world, normalMatrix);
+
+            // A mirroring transform flips the winding order of the triangles.
+            bool flip = world.determinant() < 0.0f;
+            for (size_t k = 0, indexCount = indices.size(); k + 2 < indexCount; k += 3)
+            {
+                chunk.indices.push_back((unsigned short)remap[indices[k]]);
+                chunk.indices.push_back((unsigned short)remap[indices[k + (flip ? 2 : 1)]]);
+                chunk.indices.push_back((unsigned short)remap[indices[k + (flip ? 1 : 2)]]);
+            }
+
+            merged.insert(source->node);
+            mergedMeshes.insert(mesh);
+            ++result.drawCallsBefore;
+        }
+    }
+
+    // Account for the meshes that were merged, counting shared meshes once.
+    for (std::set<Mesh*>::iterator itr = mergedMeshes.begin(); itr != mergedMeshes.end(); ++itr)
+    {
+        Mesh* mesh = *itr;
+        result.sourceMemory += mesh->getVertexSize() * mesh->getVertexCount();
+        for (unsigned int i = 0, partCount = mesh->getPartCount(); i < partCount; ++i)
+        {
+            MeshPart* part = mesh->getPart(i);
+            result.sourceMemory += part->getIndexCount() * part->getIndexSize();
+        }
+    }
+
+    // Remove the geometry of the merged nodes before binding their materials to the batches.
+    for (std::set<Node*>::iterator itr = merged.begin(); itr != merged.end(); ++itr)
+    {
+        (*itr)->setDrawable(NULL);
+    }
+    result.nodeCount = (unsigned int)merged.size();
+
+    for (size_t i = 0, count = batchMeshes.size(); i < count; ++i)
+    {
+        Model* model = Model::create(batchMeshes[i]);
+        model->setMaterial(batchMaterials[i]);
+        char id[32];
+        sprintf(id, "staticBatch%u", (unsigned int)i);
+        Node* node = scene->addNode(id);
+        node->setDrawable(model);
+        SAFE_RELEASE(model);
+        SAFE_RELEASE(batchMeshes[i]);
+        SAFE_RELEASE(batchMaterials[i]);
+    }
+    result.batchCount = (unsigned int)batchMeshes.size();
+    result.drawCallsAfter = result.batchCount;
+
+    for (size_t i = 0, count = groups.size(); i < count; ++i)
+    {
+        SAFE_DELETE(groups[i]);
+    }
+
+    if (report)
+        *report = result;
+    return result.batchCount;
+}
+
+}
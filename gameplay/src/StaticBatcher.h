@@ -0,0 +1,86 @@
+#ifndef STATICBATCHER_H_
+#define STATICBATCHER_H_
+
+namespace gameplay
+{
+
+class Scene;
+
+/**
+ * Defines a class that merges the geometry of static nodes into fewer, larger meshes.
+ *
+ * Each static node (see Node::isStatic) that draws an unskinned model made of triangle
+ * lists is pre-transformed into world space and merged with the other static nodes that
+ * share an equivalent material (see Material::isEquivalent) and vertex format. To keep
+ * view frustum culling effective, the merged geometry is split into a grid of cubic
+ * cells and a node is only merged with the nodes whose bounding sphere center lies in
+ * the same cell.
+ *
+ * Each batch becomes a new node at the root of the scene, holding a model with a single
+ * 16-bit indexed mesh part. The drawables of the merged nodes are removed, but the nodes
+ * themselves are kept so that their physics, audio and scripts still work.
+ *
+ * Batching is performed by Scene when a scene file sets a staticBatchCellSize greater
+ * than zero, or it can be performed on any scene after it has been set up.
+ */
+class StaticBatcher
+{
+public:
+
+    /**
+     * Describes the result of batching a scene.
+     */
+    struct Report
+    {
+        /**
+         * Constructor.
+         */
+        Report();
+
+        /** The number of nodes whose geometry was merged. */
+        unsigned int nodeCount;
+        /** The number of batches created. */
+        unsigned int batchCount;
+        /** The number of draw calls per pass of the merged nodes before batching. */
+        unsigned int drawCallsBefore;
+        /** The number of draw calls per pass of the batches. */
+        unsigned int drawCallsAfter;
+        /** The number of vertices in the batches. */
+        unsigned int vertexCount;
+        /** The number of indices in the batches. */
+        unsigned int indexCount;
+        /** The size in bytes of the vertex and index data of the merged meshes. */
+        unsigned int sourceMemory;
+        /**
+         * The size in bytes of the vertex and index data of the batches.
+         *
+         * Meshes shared by several nodes are duplicated for each of them, so this is the memory overhead of
+         * batching when the merged meshes are still referenced elsewhere, and the overhead
+         * is batchMemory - sourceMemory when they are not.
+         */
+        unsigned int batchMemory;
+    };
+
+    /**
+     * Merges the geometry of the static nodes in the given scene.
+     *
+     * @param scene The scene to batch.
+     * @param cellSize The size of the cubic cells the batches are split into, or zero
+     *      to merge nodes regardless of their position.
+     * @param report An optional report describing the batches created.
+     *
+     * @return The number of batches created.
+     */
+    static unsigned int batch(Scene* scene, float cellSize, Report* report = NULL);
+
+private:
+
+    /**
+     * Hidden constructor.
+     */
+    StaticBatcher();
+};
+
+}
+
+#endif
@@ -3,6 +3,7 @@
 #include "TerrainPatch.h"
 #include "Node.h"
 #include "FileSystem.h"
+#include "RenderCommandList.h"
 
 namespace gameplay
 {
@@ -525,11 +526,16 @@ float Terrain::getHeight(float x, float z) const
 }
 
 unsigned int Terrain::draw(bool wireframe)
+{
+    return record(RenderCommandList::getImmediate(), wireframe);
+}
+
+unsigned int Terrain::record(RenderCommandList* list, bool wireframe)
 {
     size_t visibleCount = 0;
     for (size_t i = 0, count = _patches.size(); i < count; ++i)
     {
-        visibleCount += _patches[i]->draw(wireframe);
+        visibleCount += _patches[i]->record(list, wireframe);
     }
     return visibleCount;
 }
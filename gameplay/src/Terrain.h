@@ -266,6 +266,11 @@ public:
      */
     unsigned int draw(bool wireframe = false);
 
+    /**
+     * @see Drawable#record
+     */
+    unsigned int record(RenderCommandList* list, bool wireframe = false);
+
 protected:
 
     /**
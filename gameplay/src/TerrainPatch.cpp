@@ -4,6 +4,7 @@
 #include "MeshPart.h"
 #include "Scene.h"
 #include "Game.h"
+#include "RenderCommandList.h"
 
 namespace gameplay
 {
@@ -572,6 +573,18 @@ void TerrainPatch::updateNodeBindings()
 
 unsigned int TerrainPatch::draw(bool wireframe)
 {
+    return record(RenderCommandList::getImmediate(), wireframe);
+}
+
+unsigned int TerrainPatch::drawCallback(void* cookie, bool wireframe)
+{
+    return static_cast<TerrainPatch*>(cookie)->draw(wireframe);
+}
+
+unsigned int TerrainPatch::record(RenderCommandList* list, bool wireframe)
+{
+    GP_ASSERT(list);
+
     Scene* scene = _terrain->_node ? _terrain->_node->getScene() : NULL;
     Camera* camera = scene ? scene->getActiveCamera() : NULL;
     if (!camera)
@@ -584,6 +597,13 @@ unsigned int TerrainPatch::draw(bool wireframe)
     if (_terrain->isFlagSet(Terrain::FRUSTUM_CULLING) && !camera->getFrustum().intersects(bounds))
         return 0;
 
+    // Materials are created on the rendering thread, so the patch is drawn when the list is executed.
+    if ((_bits & TERRAINPATCH_DIRTY_MATERIAL) && !list->isImmediate())
+    {
+        list->drawCallback(&drawCallback, this, wireframe);
+        return 1;
+    }
+
     if (!updateMaterial())
         return 0;
 
@@ -591,7 +611,7 @@ unsigned int TerrainPatch::draw(bool wireframe)
     _level = computeLOD(camera, bounds);
 
     // Draw the model for the current LOD
-    return _levels[_level]->model->draw(wireframe);
+    return _levels[_level]->model->record(list, wireframe);
 }
 
 const BoundingBox& TerrainPatch::getBoundingBox(bool worldSpace) const
@@ -124,6 +124,10 @@ private:
 
     unsigned int draw(bool wireframe);
 
+    unsigned int record(RenderCommandList* list, bool wireframe);
+
+    static unsigned int drawCallback(void* cookie, bool wireframe);
+
     bool updateMaterial();
 
     unsigned int computeLOD(Camera* camera, const BoundingBox& worldBounds);
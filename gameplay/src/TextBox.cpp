@@ -68,6 +68,7 @@ void TextBox::setCaretLocation(unsigned int index)
     _caretLocation = index;
     if (_caretLocation > _text.length())
         _caretLocation = (unsigned int)_text.length();
+    setDirty(DIRTY_GEOMETRY);
 }
 
 bool TextBox::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex)
@@ -139,6 +140,9 @@ static unsigned int findNextWord(const std::string& text, unsigned int from, boo
 
 bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
 {
+    // Key events may move the caret.
+    setDirty(DIRTY_GEOMETRY);
+
     switch (evt)
     {
         case Keyboard::KEY_PRESS:
@@ -402,6 +406,7 @@ void TextBox::setText(char const *text)
     {
         _caretLocation = _text.length();
     }
+    setDirty(DIRTY_GEOMETRY);
     notifyListeners(Control::Listener::TEXT_CHANGED);
 }
 
@@ -468,6 +473,7 @@ void TextBox::setCaretLocation(int x, int y)
     {
         _caretLocation = _text.length();
     }
+    setDirty(DIRTY_GEOMETRY);
 }
 
 void TextBox::getCaretLocation(Vector2* p)
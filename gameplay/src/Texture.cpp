@@ -44,18 +44,142 @@
 #define ETC1_RGB8 0x8D64
 #endif
 
+// S3TC/DXT (GL_EXT_texture_compression_s3tc) : Opaque DXT1
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+// BPTC/BC7 (GL_ARB_texture_compression_bptc) : Desktop gpus
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+// ETC2/EAC (OpenGL ES 3.0, GL_ARB_ES3_compatibility) : Most mobile gpus
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2
+#define GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2 0x9276
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+
+// ASTC (GL_KHR_texture_compression_astc_ldr) : Recent mobile gpus
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_12x12_KHR
+#define GL_COMPRESSED_RGBA_ASTC_12x12_KHR 0x93BD
+#endif
+#ifndef GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR
+#define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR 0x93D0
+#endif
+#ifndef GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR
+#define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR 0x93DD
+#endif
+
+// Number of worker threads decoding the textures created with Texture::createAsync.
+#define TEXTURE_ASYNC_THREAD_COUNT 2
+
+// Default number of bytes of asynchronously loaded textures uploaded per frame.
+#define TEXTURE_DEFAULT_UPLOAD_BUDGET (4 * 1024 * 1024)
+
 namespace gameplay
 {
 
-static std::vector<Texture*> __textureCache;
+// The images of a KTX or KTX2 file, transcoded when the driver does not support their format.
+struct TextureKTX
+{
+    GLenum internalFormat;
+    GLenum format;
+    GLenum texelType;
+    bool compressed;
+    GLenum transcodedFormat; // The compressed format that was decoded to RGBA, or 0.
+    unsigned int width;
+    unsigned int height;
+    unsigned int faceCount;
+    unsigned int levelCount;
+    unsigned int alignment;
+    unsigned int memorySize;
+    std::vector<std::vector<unsigned char> > images; // Indexed by level * faceCount + face.
+};
+
+// A texture waiting to be decoded and uploaded by Texture::createAsync.
+struct TextureAsyncLoad
+{
+    Texture* texture;
+    std::string path;
+    bool generateMipmaps;
+    bool compressed;
+    Image* image;
+    TextureKTX* ktx;
+    std::vector<std::pair<Texture::LoadCallback, void*> > callbacks;
+};
+
+static std::unordered_map<std::string, Texture*> __textureCache;
+static std::vector<std::thread> __asyncThreads;
+static std::queue<TextureAsyncLoad*> __decodeQueue;
+static std::queue<TextureAsyncLoad*> __uploadQueue;
+static std::mutex __asyncMutex;
+static std::condition_variable __asyncCondition;
+static bool __asyncShutdown = false;
+static unsigned int __uploadBudget = TEXTURE_DEFAULT_UPLOAD_BUDGET;
 static TextureHandle __currentTextureId = 0;
 static Texture::Type __currentTextureType = Texture::TEXTURE_2D;
+static std::vector<GLint> __compressedFormats;
+static bool __compressedFormatsQueried = false;
+
+// Queries the compressed formats supported by the driver, which must be done on the game thread
+// before KTX files are read on the worker threads.
+static void queryCompressedFormats()
+{
+    if (__compressedFormatsQueried)
+        return;
+    __compressedFormatsQueried = true;
+
+    GLint count = 0;
+    GL_ASSERT( glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count) );
+    if (count > 0)
+    {
+        __compressedFormats.resize(count);
+        GL_ASSERT( glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, &__compressedFormats[0]) );
+    }
+}
 
-Texture::Texture() : _handle(0), _path(""), _width(0), _height(0), _format(Texture::UNKNOWN),
-_mipmapped(false), _type((Texture::Type)TEXTURE_2D),
-_compressed(false), _cached(false),
+static bool isCompressedFormatSupported(GLenum format)
+{
+    GP_ASSERT( __compressedFormatsQueried );
+    return std::find(__compressedFormats.begin(), __compressedFormats.end(), (GLint)format) != __compressedFormats.end();
+}
+
+// Computes the number of bytes in the mipmap levels of an uncompressed image (a levelCount of 0 for a full chain).
+static unsigned int computeMipmapSize(unsigned int width, unsigned int height, unsigned int levelCount, size_t bpp)
+{
+    unsigned int size = 0;
+    for (unsigned int level = 0; levelCount == 0 || level < levelCount; ++level)
+    {
+        size += width * height * (unsigned int)bpp;
+        if (width == 1 && height == 1)
+            break;
+        width = std::max(width >> 1, 1u);
+        height = std::max(height >> 1, 1u);
+    }
+    return size;
+}
+
+// Determines whether a path has the extension of a KTX or KTX2 file.
+static bool isKTXPath(const char* path)
+{
+    const char* ext = strrchr(path, '.');
+    return ext && (strlen(ext) == 4 || (strlen(ext) == 5 && ext[4] == '2')) &&
+        tolower(ext[1]) == 'k' && tolower(ext[2]) == 't' && tolower(ext[3]) == 'x';
+}
+
+Texture::Texture() : _path(""), _handle(0), _format(Texture::UNKNOWN), _type((Texture::Type)TEXTURE_2D),
+_width(0), _height(0), _mipmapped(false), _cached(false), _asyncLoad(NULL), _compressed(false),
 _wrapS(Texture::REPEAT), _wrapT(Texture::REPEAT), _wrapR(Texture::REPEAT),
-_filterMin(Texture::NEAREST_MIPMAP_LINEAR), _filterMag(Texture::LINEAR)
+_filterMin(Texture::NEAREST_MIPMAP_LINEAR), _filterMag(Texture::LINEAR), _memorySize(0), _uncompressedMemorySize(0)
 {
 }
 
@@ -68,8 +192,8 @@ Texture::~Texture()
     }
     if (_cached)
     {
-        std::vector<Texture*>::iterator itr = std::find(__textureCache.begin(), __textureCache.end(), this);
-        if (itr != __textureCache.end())
+        std::unordered_map<std::string, Texture*>::iterator itr = __textureCache.find(_path);
+        if (itr != __textureCache.end() && itr->second == this)
         {
             __textureCache.erase(itr);
         }
@@ -81,23 +205,22 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
     GP_ASSERT( path );
 
     // Search texture cache first.
-    for (size_t i = 0, count = __textureCache.size(); i < count; ++i)
+    std::unordered_map<std::string, Texture*>::const_iterator itr = __textureCache.find(path);
+    if (itr != __textureCache.end())
     {
-        Texture* t = __textureCache[i];
+        Texture* t = itr->second;
         GP_ASSERT( t );
-        if (t->_path == path)
-        {
-            // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the
-            // texture to generate its mipmap chain if it hasn't already done so.
-            if (generateMipmaps)
-            {
-                t->generateMipmaps();
-            }
-            // Found a match.
-            t->addRef();
 
-            return t;
+        // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the
+        // texture to generate its mipmap chain if it hasn't already done so.
+        if (generateMipmaps && !t->isLoading())
+        {
+            t->generateMipmaps();
         }
+        // Found a match.
+        t->addRef();
+
+        return t;
     }
 
     Texture* texture = NULL;
@@ -109,7 +232,8 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
         switch (strlen(ext))
         {
         case 4:
-            if (tolower(ext[1]) == 'p' && tolower(ext[2]) == 'n' && tolower(ext[3]) == 'g')
+            if ((tolower(ext[1]) == 'p' && tolower(ext[2]) == 'n' && tolower(ext[3]) == 'g') ||
+                (tolower(ext[1]) == 'q' && tolower(ext[2]) == 'o' && tolower(ext[3]) == 'i'))
             {
                 Image* image = Image::create(path);
                 if (image)
@@ -126,6 +250,18 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
                 // DDS file format (DXT/S3TC) compressed textures
                 texture = createCompressedDDS(path);
             }
+            else if (isKTXPath(path))
+            {
+                // KTX file format (ETC2/ASTC/BCn) compressed textures
+                texture = createKTX(path);
+            }
+            break;
+        case 5:
+            if (isKTXPath(path))
+            {
+                // KTX2 file format (ETC2/ASTC/BCn) compressed textures
+                texture = createKTX(path);
+            }
             break;
         }
     }
@@ -136,7 +272,7 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
         texture->_cached = true;
 
         // Add to texture cache.
-        __textureCache.push_back(texture);
+        __textureCache[texture->_path] = texture;
 
         return texture;
     }
@@ -145,20 +281,299 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
     return NULL;
 }
 
+Texture* Texture::createAsync(const char* path, bool generateMipmaps, LoadCallback callback, void* cookie)
+{
+    GP_ASSERT( path );
+
+    // Share the texture if it is already loaded or loading.
+    std::unordered_map<std::string, Texture*>::const_iterator itr = __textureCache.find(path);
+    if (itr != __textureCache.end())
+    {
+        Texture* t = itr->second;
+        GP_ASSERT( t );
+        t->addRef();
+        if (t->_asyncLoad)
+        {
+            // The flag is read by the worker threads.
+            std::lock_guard<std::mutex> lock(__asyncMutex);
+            t->_asyncLoad->generateMipmaps |= generateMipmaps;
+            if (callback)
+                t->_asyncLoad->callbacks.push_back(std::make_pair(callback, cookie));
+        }
+        else
+        {
+            if (generateMipmaps)
+                t->generateMipmaps();
+            if (callback)
+                callback(t, true, cookie);
+        }
+        return t;
+    }
+
+    // Create the placeholder texture that the loaded image will be uploaded into.
+    const unsigned char placeholder[4] = { 0, 0, 0, 0 };
+    Texture* texture = create(Texture::RGBA, 1, 1, placeholder, false);
+    GP_ASSERT( texture );
+    texture->_path = path;
+    texture->_cached = true;
+    __textureCache[texture->_path] = texture;
+
+    TextureAsyncLoad* load = new TextureAsyncLoad();
+    load->texture = texture;
+    load->path = path;
+    load->generateMipmaps = generateMipmaps;
+    load->compressed = true;
+    load->image = NULL;
+    load->ktx = NULL;
+    if (callback)
+        load->callbacks.push_back(std::make_pair(callback, cookie));
+    texture->_asyncLoad = load;
+
+    // Keep the texture alive until it is uploaded.
+    texture->addRef();
+
+    // PNG and QOI images are decoded and KTX files are read (and transcoded if needed) on the worker threads.
+    const char* ext = strrchr(path, '.');
+    if (ext && strlen(ext) == 4 && tolower(ext[1]) == 'p' && tolower(ext[2]) == 'n' && tolower(ext[3]) == 'g')
+        load->compressed = false;
+    else if (ext && strlen(ext) == 4 && tolower(ext[1]) == 'q' && tolower(ext[2]) == 'o' && tolower(ext[3]) == 'i')
+        load->compressed = false;
+    else if (isKTXPath(path))
+        load->compressed = false;
+    queryCompressedFormats();
+
+    {
+        std::lock_guard<std::mutex> lock(__asyncMutex);
+        if (load->compressed)
+        {
+            __uploadQueue.push(load);
+        }
+        else
+        {
+            __decodeQueue.push(load);
+            if (__asyncThreads.empty())
+            {
+                __asyncShutdown = false;
+                for (unsigned int i = 0; i < TEXTURE_ASYNC_THREAD_COUNT; ++i)
+                    __asyncThreads.push_back(std::thread(&Texture::decodeAsync));
+            }
+        }
+    }
+    __asyncCondition.notify_one();
+
+    return texture;
+}
+
+void Texture::decodeAsync()
+{
+    while (true)
+    {
+        TextureAsyncLoad* load;
+        bool generateMipmaps;
+        {
+            std::unique_lock<std::mutex> lock(__asyncMutex);
+            while (!__asyncShutdown && __decodeQueue.empty())
+                __asyncCondition.wait(lock);
+            if (__asyncShutdown)
+                return;
+            load = __decodeQueue.front();
+            __decodeQueue.pop();
+            generateMipmaps = load->generateMipmaps;
+        }
+
+        if (isKTXPath(load->path.c_str()))
+        {
+            load->ktx = readKTX(load->path.c_str());
+        }
+        else
+        {
+            // Generate the mipmaps here rather than with GL when uploading. The values are
+            // averaged directly, like glGenerateMipmap does for Texture::create.
+            load->image = Image::create(load->path.c_str());
+            if (load->image && generateMipmaps)
+                load->image->generateMipmaps(Image::MIPMAP_BOX);
+        }
+
+        std::lock_guard<std::mutex> lock(__asyncMutex);
+        __uploadQueue.push(load);
+    }
+}
+
+void Texture::frameEnded()
+{
+    unsigned int uploaded = 0;
+    while (uploaded < __uploadBudget)
+    {
+        TextureAsyncLoad* load;
+        {
+            std::lock_guard<std::mutex> lock(__asyncMutex);
+            if (__uploadQueue.empty())
+                break;
+            load = __uploadQueue.front();
+            __uploadQueue.pop();
+        }
+
+        Texture* texture = load->texture;
+        Texture* loaded = NULL;
+        if (load->image)
+        {
+            loaded = create(load->image, load->generateMipmaps);
+            SAFE_RELEASE(load->image);
+        }
+        else if (load->ktx)
+        {
+            loaded = createKTX(load->ktx);
+            SAFE_DELETE(load->ktx);
+        }
+        else if (load->compressed)
+        {
+            const char* ext = strrchr(FileSystem::resolvePath(load->path.c_str()), '.');
+            if (ext && strlen(ext) == 4 && tolower(ext[1]) == 'p' && tolower(ext[2]) == 'v' && tolower(ext[3]) == 'r')
+                loaded = createCompressedPVRTC(load->path.c_str());
+            else if (ext && strlen(ext) == 4 && tolower(ext[1]) == 'd' && tolower(ext[2]) == 'd' && tolower(ext[3]) == 's')
+                loaded = createCompressedDDS(load->path.c_str());
+        }
+
+        bool success = loaded != NULL;
+        if (loaded)
+        {
+            texture->adopt(loaded);
+            SAFE_RELEASE(loaded);
+            uploaded += std::max(texture->_memorySize, 1u);
+        }
+        else
+        {
+            GP_WARN("Failed to load texture from file '%s'.", load->path.c_str());
+            uploaded += 1;
+
+            // Remove the placeholder from the cache, so that later requests for the path
+            // load it again (and fail) rather than share the placeholder as if it loaded.
+            std::unordered_map<std::string, Texture*>::iterator itr = __textureCache.find(texture->_path);
+            if (itr != __textureCache.end() && itr->second == texture)
+                __textureCache.erase(itr);
+            texture->_cached = false;
+        }
+
+        texture->_asyncLoad = NULL;
+        for (size_t i = 0, count = load->callbacks.size(); i < count; ++i)
+        {
+            load->callbacks[i].first(texture, success, load->callbacks[i].second);
+        }
+        SAFE_DELETE(load);
+        texture->release();
+    }
+}
+
+void Texture::finalize()
+{
+    {
+        std::lock_guard<std::mutex> lock(__asyncMutex);
+        __asyncShutdown = true;
+    }
+    __asyncCondition.notify_all();
+    for (size_t i = 0, count = __asyncThreads.size(); i < count; ++i)
+    {
+        __asyncThreads[i].join();
+    }
+    __asyncThreads.clear();
+
+    // Discard the textures that have not been uploaded.
+    std::queue<TextureAsyncLoad*>* queues[2] = { &__decodeQueue, &__uploadQueue };
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+        while (!queues[i]->empty())
+        {
+            TextureAsyncLoad* load = queues[i]->front();
+            queues[i]->pop();
+            SAFE_RELEASE(load->image);
+            SAFE_DELETE(load->ktx);
+            load->texture->_asyncLoad = NULL;
+            load->texture->release();
+            SAFE_DELETE(load);
+        }
+    }
+}
+
+void Texture::adopt(Texture* texture)
+{
+    GP_ASSERT( texture );
+
+    std::swap(_handle, texture->_handle);
+    _format = texture->_format;
+    _type = texture->_type;
+    _width = texture->_width;
+    _height = texture->_height;
+    _mipmapped = texture->_mipmapped;
+    _compressed = texture->_compressed;
+    _wrapS = texture->_wrapS;
+    _wrapT = texture->_wrapT;
+    _wrapR = texture->_wrapR;
+    _filterMin = texture->_filterMin;
+    _filterMag = texture->_filterMag;
+    _internalFormat = texture->_internalFormat;
+    _texelType = texture->_texelType;
+    _bpp = texture->_bpp;
+    _memorySize = texture->_memorySize;
+    _uncompressedMemorySize = texture->_uncompressedMemorySize;
+}
+
+void Texture::setUploadBudget(unsigned int bytes)
+{
+    __uploadBudget = bytes;
+}
+
+unsigned int Texture::getUploadBudget()
+{
+    return __uploadBudget;
+}
+
+bool Texture::isLoading() const
+{
+    return _asyncLoad != NULL;
+}
+
 Texture* Texture::create(Image* image, bool generateMipmaps)
 {
     GP_ASSERT( image );
 
+    // Upload the mipmaps of the image rather than generating them.
+    bool imageMipmaps = image->getMipmapCount() > 1;
+    Texture* texture;
     switch (image->getFormat())
     {
     case Image::RGB:
-        return create(Texture::RGB, image->getWidth(), image->getHeight(), image->getData(), generateMipmaps);
+        texture = create(Texture::RGB, image->getWidth(), image->getHeight(), image->getData(), generateMipmaps && !imageMipmaps);
+        break;
     case Image::RGBA:
-        return create(Texture::RGBA, image->getWidth(), image->getHeight(), image->getData(), generateMipmaps);
+        texture = create(Texture::RGBA, image->getWidth(), image->getHeight(), image->getData(), generateMipmaps && !imageMipmaps);
+        break;
     default:
         GP_ERROR("Unsupported image format (%d).", image->getFormat());
         return NULL;
     }
+
+    if (texture && imageMipmaps)
+    {
+        GL_ASSERT( glBindTexture(GL_TEXTURE_2D, texture->_handle) );
+        GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+        unsigned int width = texture->_width;
+        unsigned int height = texture->_height;
+        for (unsigned int level = 1, count = image->getMipmapCount(); level < count; ++level)
+        {
+            width = std::max(width >> 1, 1u);
+            height = std::max(height >> 1, 1u);
+            GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, level, texture->_internalFormat, width, height, 0, texture->_internalFormat, texture->_texelType, image->getMipmapData(level)) );
+        }
+        texture->_filterMin = NEAREST_MIPMAP_LINEAR;
+        GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture->_filterMin) );
+        texture->_mipmapped = true;
+        texture->_memorySize = texture->_uncompressedMemorySize = computeMipmapSize(texture->_width, texture->_height, 0, texture->_bpp);
+
+        // Restore the texture id
+        GL_ASSERT( glBindTexture((GLenum)__currentTextureType, __currentTextureId) );
+    }
+
+    return texture;
 }
 
 GLint Texture::getFormatInternal(Format format)
@@ -308,6 +723,7 @@ Texture* Texture::create(Format format, unsigned int width, unsigned int height,
     texture->_internalFormat = internalFormat;
     texture->_texelType = texelType;
     texture->_bpp = bpp;
+    texture->_memorySize = texture->_uncompressedMemorySize = width * height * (unsigned int)bpp * (type == TEXTURE_CUBE ? 6 : 1);
     if (generateMipmaps)
         texture->generateMipmaps();
 
@@ -347,6 +763,7 @@ Texture* Texture::create(TextureHandle handle, int width, int height, Format for
     texture->_internalFormat = getFormatInternal(format);
     texture->_texelType = getFormatTexel(format);
     texture->_bpp = getFormatBPP(format);
+    texture->_memorySize = texture->_uncompressedMemorySize = width * height * (unsigned int)texture->_bpp;
 
     return texture;
 }
@@ -385,6 +802,22 @@ void Texture::setData(const unsigned char* data)
     GL_ASSERT( glBindTexture((GLenum)__currentTextureType, __currentTextureId) );
 }
 
+void Texture::setData(const unsigned char* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+    GP_ASSERT( data );
+    GP_ASSERT( (!_compressed) );
+    GP_ASSERT( (!_cached) );
+    GP_ASSERT( _type == Texture::TEXTURE_2D );
+    GP_ASSERT( x + width <= _width && y + height <= _height );
+
+    GL_ASSERT( glBindTexture((GLenum)_type, _handle) );
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+    GL_ASSERT( glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, _internalFormat, _texelType, data) );
+
+    // Restore the texture id
+    GL_ASSERT( glBindTexture((GLenum)__currentTextureType, __currentTextureId) );
+}
+
 // Computes the size of a PVRTC data chunk for a mipmap level of the given size.
 static unsigned int computePVRTCDataSize(int width, int height, int bpp)
 {
@@ -478,12 +911,14 @@ Texture* Texture::createCompressedPVRTC(const char* path)
     texture->_mipmapped = mipMapCount > 1;
     texture->_compressed = true;
     texture->_filterMin = filterMin;
+    texture->_uncompressedMemorySize = computeMipmapSize(width, height, mipMapCount, 4) * faceCount;
 
     // Load the data for each level.
     GLubyte* ptr = data;
     for (unsigned int level = 0; level < mipMapCount; ++level)
     {
         unsigned int dataSize = computePVRTCDataSize(width, height, bpp);
+        texture->_memorySize += dataSize * faceCount;
 
         for (unsigned int face = 0; face < faceCount; ++face)
         {
@@ -1121,6 +1556,7 @@ Texture* Texture::createCompressedDDS(const char* path)
     texture->_compressed = compressed;
     texture->_mipmapped = header.dwMipMapCount > 1;
     texture->_filterMin = filterMin;
+    texture->_uncompressedMemorySize = computeMipmapSize(header.dwWidth, header.dwHeight, header.dwMipMapCount, 4) * facecount;
 
     // Load texture data.
     for (unsigned int face = 0; face < facecount; ++face)
@@ -1129,6 +1565,7 @@ Texture* Texture::createCompressedDDS(const char* path)
         for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
         {
             dds_mip_level& level = mipLevels[i + face * header.dwMipMapCount];
+            texture->_memorySize += level.size;
             if (compressed)
             {
                 GL_ASSERT(glCompressedTexImage2D(texImageTarget, i, format, level.width, level.height, 0, level.size, level.data));
@@ -1145,6 +1582,843 @@ Texture* Texture::createCompressedDDS(const char* path)
 
     // Clean up mip levels structure.
     SAFE_DELETE_ARRAY(mipLevels);
+    if (!compressed)
+        texture->_uncompressedMemorySize = texture->_memorySize;
+
+    // Restore the texture id
+    GL_ASSERT( glBindTexture((GLenum)__currentTextureType, __currentTextureId) );
+
+    return texture;
+}
+
+// Gets the size of the blocks of a compressed format, returning false for formats that are not block compressed.
+static bool getCompressedBlockSize(GLenum format, unsigned int* blockWidth, unsigned int* blockHeight, unsigned int* blockBytes)
+{
+    static const unsigned char astcBlocks[14][2] =
+    {
+        { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 },
+        { 8, 8 }, { 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 }
+    };
+
+    *blockWidth = *blockHeight = 4;
+    switch (format)
+    {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGB8_ETC2:
+    case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+    case ETC1_RGB8:
+    case ATC_RGB_AMD:
+        *blockBytes = 8;
+        return true;
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+    case GL_COMPRESSED_RGBA8_ETC2_EAC:
+    case ATC_RGBA_EXPLICIT_ALPHA_AMD:
+    case ATC_RGBA_INTERPOLATED_ALPHA_AMD:
+        *blockBytes = 16;
+        return true;
+    }
+    if (format >= GL_COMPRESSED_RGBA_ASTC_4x4_KHR && format <= GL_COMPRESSED_RGBA_ASTC_12x12_KHR)
+    {
+        *blockWidth = astcBlocks[format - GL_COMPRESSED_RGBA_ASTC_4x4_KHR][0];
+        *blockHeight = astcBlocks[format - GL_COMPRESSED_RGBA_ASTC_4x4_KHR][1];
+        *blockBytes = 16;
+        return true;
+    }
+    if (format >= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR && format <= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR)
+    {
+        *blockWidth = astcBlocks[format - GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR][0];
+        *blockHeight = astcBlocks[format - GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR][1];
+        *blockBytes = 16;
+        return true;
+    }
+    return false;
+}
+
+// Maps the Vulkan format of a KTX2 file to a GL format. sRGB formats are mapped to their UNORM
+// equivalents, since the other texture paths do not decode sRGB either.
+static bool getKTX2Format(unsigned int vkFormat, GLenum* internalFormat, GLenum* format, GLenum* texelType)
+{
+    *format = 0;
+    *texelType = 0;
+    switch (vkFormat)
+    {
+    case 23: // VK_FORMAT_R8G8B8_UNORM
+    case 29: // VK_FORMAT_R8G8B8_SRGB
+        *internalFormat = *format = GL_RGB;
+        *texelType = GL_UNSIGNED_BYTE;
+        return true;
+    case 37: // VK_FORMAT_R8G8B8A8_UNORM
+    case 43: // VK_FORMAT_R8G8B8A8_SRGB
+        *internalFormat = *format = GL_RGBA;
+        *texelType = GL_UNSIGNED_BYTE;
+        return true;
+    case 131: // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+    case 132: // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+        *internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        return true;
+    case 133: // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+    case 134: // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+        *internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        return true;
+    case 135: // VK_FORMAT_BC2_UNORM_BLOCK
+    case 136: // VK_FORMAT_BC2_SRGB_BLOCK
+        *internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+        return true;
+    case 137: // VK_FORMAT_BC3_UNORM_BLOCK
+    case 138: // VK_FORMAT_BC3_SRGB_BLOCK
+        *internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        return true;
+    case 145: // VK_FORMAT_BC7_UNORM_BLOCK
+    case 146: // VK_FORMAT_BC7_SRGB_BLOCK
+        *internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM;
+        return true;
+    case 147: // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+    case 148: // VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+        *internalFormat = GL_COMPRESSED_RGB8_ETC2;
+        return true;
+    case 149: // VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK
+    case 150: // VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK
+        *internalFormat = GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+        return true;
+    case 151: // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+    case 152: // VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+        *internalFormat = GL_COMPRESSED_RGBA8_ETC2_EAC;
+        return true;
+    }
+    if (vkFormat >= 157 && vkFormat <= 184)
+    {
+        // VK_FORMAT_ASTC_4x4_UNORM_BLOCK to VK_FORMAT_ASTC_12x12_SRGB_BLOCK, alternating UNORM and SRGB.
+        *internalFormat = GL_COMPRESSED_RGBA_ASTC_4x4_KHR + (vkFormat - 157) / 2;
+        return true;
+    }
+    return false;
+}
+
+// Expands a 565 color to 8 bits per channel.
+static void decode565(unsigned int color, unsigned char* rgb)
+{
+    unsigned int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    rgb[0] = (unsigned char)((r << 3) | (r >> 2));
+    rgb[1] = (unsigned char)((g << 2) | (g >> 4));
+    rgb[2] = (unsigned char)((b << 3) | (b >> 2));
+}
+
+// Decodes the color part of a BC1, BC2 or BC3 block into 4x4 RGBA pixels. Only BC1 blocks may use the
+// three color mode, whose fourth color is black, or transparent when alpha is written.
+static void decodeBC1Block(const unsigned char* block, bool threeColor, bool alpha, unsigned char* pixels)
+{
+    unsigned int c0 = block[0] | (block[1] << 8);
+    unsigned int c1 = block[2] | (block[3] << 8);
+    unsigned char colors[4][4];
+    decode565(c0, colors[0]);
+    decode565(c1, colors[1]);
+    colors[0][3] = colors[1][3] = colors[2][3] = colors[3][3] = 255;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        if (c0 > c1 || !threeColor)
+        {
+            colors[2][i] = (unsigned char)((2 * colors[0][i] + colors[1][i]) / 3);
+            colors[3][i] = (unsigned char)((colors[0][i] + 2 * colors[1][i]) / 3);
+        }
+        else
+        {
+            colors[2][i] = (unsigned char)((colors[0][i] + colors[1][i]) / 2);
+            colors[3][i] = 0;
+        }
+    }
+    if (c0 <= c1 && threeColor && alpha)
+        colors[3][3] = 0;
+
+    unsigned int indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((unsigned int)block[7] << 24);
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        const unsigned char* color = colors[(indices >> (i * 2)) & 3];
+        unsigned char* pixel = &pixels[i * 4];
+        pixel[0] = color[0];
+        pixel[1] = color[1];
+        pixel[2] = color[2];
+        if (alpha)
+            pixel[3] = color[3];
+    }
+}
+
+// Decodes the interpolated alpha of a BC3 block into 4x4 RGBA pixels.
+static void decodeBC3AlphaBlock(const unsigned char* block, unsigned char* pixels)
+{
+    unsigned int alphas[8];
+    alphas[0] = block[0];
+    alphas[1] = block[1];
+    if (alphas[0] > alphas[1])
+    {
+        for (unsigned int i = 2; i < 8; ++i)
+            alphas[i] = ((8 - i) * alphas[0] + (i - 1) * alphas[1]) / 7;
+    }
+    else
+    {
+        for (unsigned int i = 2; i < 6; ++i)
+            alphas[i] = ((6 - i) * alphas[0] + (i - 1) * alphas[1]) / 5;
+        alphas[6] = 0;
+        alphas[7] = 255;
+    }
+
+    unsigned long long indices = 0;
+    for (unsigned int i = 0; i < 6; ++i)
+        indices |= (unsigned long long)block[2 + i] << (i * 8);
+    for (unsigned int i = 0; i < 16; ++i)
+        pixels[i * 4 + 3] = (unsigned char)alphas[(indices >> (i * 3)) & 7];
+}
+
+static unsigned char clampColor(int value)
+{
+    return (unsigned char)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// Decodes an ETC1 or ETC2 color block into 4x4 RGBA pixels, including the punch-through alpha of
+// ETC2 RGB8A1 blocks. The alpha of the other formats is left untouched.
+static void decodeETC2Block(const unsigned char* block, bool punchthrough, unsigned char* pixels)
+{
+    static const int modifiers[8][2] = { { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 } };
+    static const int distances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+    unsigned int hi = ((unsigned int)block[0] << 24) | (block[1] << 16) | (block[2] << 8) | block[3];
+    unsigned int lo = ((unsigned int)block[4] << 24) | (block[5] << 16) | (block[6] << 8) | block[7];
+    bool differential = (hi & 2) != 0;
+    bool opaque = !punchthrough || differential;
+
+    // Pixels are indexed by column, with each index split between the two halves of lo.
+    #define ETC_PIXEL_INDEX(i) ((((lo >> ((i) + 16)) & 1) << 1) | ((lo >> (i)) & 1))
+
+    int r = 0, g = 0, b = 0;
+    if (differential || punchthrough)
+    {
+        r = (hi >> 27) & 31;
+        g = (hi >> 19) & 31;
+        b = (hi >> 11) & 31;
+        int dr = (((int)(hi >> 24) & 7) ^ 4) - 4;
+        int dg = (((int)(hi >> 16) & 7) ^ 4) - 4;
+        int db = (((int)(hi >> 8) & 7) ^ 4) - 4;
+
+        if (r + dr < 0 || r + dr > 31 || g + dg < 0 || g + dg > 31)
+        {
+            // T and H modes: four paint colors built from two base colors and a distance.
+            unsigned char paint[4][3];
+            int c1[3], c2[3], distance;
+            if (r + dr < 0 || r + dr > 31)
+            {
+                c1[0] = (((hi >> 27) & 3) << 2) | ((hi >> 24) & 3);
+                c1[1] = (hi >> 20) & 15;
+                c1[2] = (hi >> 16) & 15;
+                c2[0] = (hi >> 12) & 15;
+                c2[1] = (hi >> 8) & 15;
+                c2[2] = (hi >> 4) & 15;
+                distance = distances[(((hi >> 2) & 3) << 1) | (hi & 1)];
+                for (unsigned int i = 0; i < 3; ++i)
+                {
+                    paint[0][i] = (unsigned char)(c1[i] * 17);
+                    paint[1][i] = clampColor(c2[i] * 17 + distance);
+                    paint[2][i] = (unsigned char)(c2[i] * 17);
+                    paint[3][i] = clampColor(c2[i] * 17 - distance);
+                }
+            }
+            else
+            {
+                c1[0] = (hi >> 27) & 15;
+                c1[1] = (((hi >> 24) & 7) << 1) | ((hi >> 20) & 1);
+                c1[2] = (((hi >> 19) & 1) << 3) | ((hi >> 15) & 7);
+                c2[0] = (hi >> 11) & 15;
+                c2[1] = (hi >> 7) & 15;
+                c2[2] = (hi >> 3) & 15;
+                unsigned int order = ((c1[0] << 8) | (c1[1] << 4) | c1[2]) >= ((c2[0] << 8) | (c2[1] << 4) | c2[2]) ? 1 : 0;
+                distance = distances[(((hi >> 2) & 1) << 2) | ((hi & 1) << 1) | order];
+                for (unsigned int i = 0; i < 3; ++i)
+                {
+                    paint[0][i] = clampColor(c1[i] * 17 + distance);
+                    paint[1][i] = clampColor(c1[i] * 17 - distance);
+                    paint[2][i] = clampColor(c2[i] * 17 + distance);
+                    paint[3][i] = clampColor(c2[i] * 17 - distance);
+                }
+            }
+
+            for (unsigned int i = 0; i < 16; ++i)
+            {
+                unsigned int index = ETC_PIXEL_INDEX(i);
+                unsigned char* pixel = &pixels[((i & 3) * 4 + (i >> 2)) * 4];
+                if (!opaque && index == 2)
+                {
+                    pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
+                    continue;
+                }
+                pixel[0] = paint[index][0];
+                pixel[1] = paint[index][1];
+                pixel[2] = paint[index][2];
+                if (punchthrough)
+                    pixel[3] = 255;
+            }
+            return;
+        }
+
+        if (b + db < 0 || b + db > 31)
+        {
+            // Planar mode: colors interpolated from the origin, horizontal and vertical colors.
+            int o[3], h[3], v[3];
+            o[0] = (hi >> 25) & 63;
+            o[1] = (((hi >> 24) & 1) << 6) | ((hi >> 17) & 63);
+            o[2] = (((hi >> 16) & 1) << 5) | (((hi >> 11) & 3) << 3) | ((hi >> 7) & 7);
+            h[0] = (((hi >> 2) & 31) << 1) | (hi & 1);
+            h[1] = (lo >> 25) & 127;
+            h[2] = (lo >> 19) & 63;
+            v[0] = (lo >> 13) & 63;
+            v[1] = (lo >> 6) & 127;
+            v[2] = lo & 63;
+            for (unsigned int i = 0; i < 3; ++i)
+            {
+                if (i == 1)
+                {
+                    o[i] = (o[i] << 1) | (o[i] >> 6);
+                    h[i] = (h[i] << 1) | (h[i] >> 6);
+                    v[i] = (v[i] << 1) | (v[i] >> 6);
+                }
+                else
+                {
+                    o[i] = (o[i] << 2) | (o[i] >> 4);
+                    h[i] = (h[i] << 2) | (h[i] >> 4);
+                    v[i] = (v[i] << 2) | (v[i] >> 4);
+                }
+            }
+            for (int y = 0; y < 4; ++y)
+            {
+                for (int x = 0; x < 4; ++x)
+                {
+                    unsigned char* pixel = &pixels[(y * 4 + x) * 4];
+                    for (unsigned int i = 0; i < 3; ++i)
+                        pixel[i] = clampColor((x * (h[i] - o[i]) + y * (v[i] - o[i]) + 4 * o[i] + 2) >> 2);
+                    if (punchthrough)
+                        pixel[3] = 255;
+                }
+            }
+            return;
+        }
+    }
+
+    // Individual and differential modes: two sub-blocks, each with a base color and a modifier table.
+    int bases[2][3];
+    if (differential || punchthrough)
+    {
+        int dr = (((int)(hi >> 24) & 7) ^ 4) - 4;
+        int dg = (((int)(hi >> 16) & 7) ^ 4) - 4;
+        int db = (((int)(hi >> 8) & 7) ^ 4) - 4;
+        int c[2][3] = { { r, g, b }, { r + dr, g + dg, b + db } };
+        for (unsigned int s = 0; s < 2; ++s)
+            for (unsigned int i = 0; i < 3; ++i)
+                bases[s][i] = (c[s][i] << 3) | (c[s][i] >> 2);
+    }
+    else
+    {
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+            bases[0][i] = ((hi >> (28 - i * 8)) & 15) * 17;
+            bases[1][i] = ((hi >> (24 - i * 8)) & 15) * 17;
+        }
+    }
+    unsigned int tables[2] = { (hi >> 5) & 7, (hi >> 2) & 7 };
+    bool flip = (hi & 1) != 0;
+
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        unsigned int x = i >> 2, y = i & 3;
+        unsigned int sub = flip ? (y >= 2 ? 1 : 0) : (x >= 2 ? 1 : 0);
+        unsigned int index = ETC_PIXEL_INDEX(i);
+        unsigned char* pixel = &pixels[(y * 4 + x) * 4];
+        int modifier = modifiers[tables[sub]][index & 1];
+        if (index & 2)
+            modifier = -modifier;
+        if (!opaque)
+        {
+            if (index == 2)
+            {
+                pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
+                continue;
+            }
+            if (index == 0)
+                modifier = 0;
+        }
+        pixel[0] = clampColor(bases[sub][0] + modifier);
+        pixel[1] = clampColor(bases[sub][1] + modifier);
+        pixel[2] = clampColor(bases[sub][2] + modifier);
+        if (punchthrough)
+            pixel[3] = 255;
+    }
+
+    #undef ETC_PIXEL_INDEX
+}
+
+// Decodes the EAC alpha block of an ETC2 RGBA8 block into 4x4 RGBA pixels.
+static void decodeEACAlphaBlock(const unsigned char* block, unsigned char* pixels)
+{
+    static const int modifiers[16][8] =
+    {
+        { -3, -6, -9, -15, 2, 5, 8, 14 }, { -3, -7, -10, -13, 2, 6, 9, 12 },
+        { -2, -5, -8, -13, 1, 4, 7, 12 }, { -2, -4, -6, -13, 1, 3, 5, 12 },
+        { -3, -6, -8, -12, 2, 5, 7, 11 }, { -3, -7, -9, -11, 2, 6, 8, 10 },
+        { -4, -7, -8, -11, 3, 6, 7, 10 }, { -3, -5, -8, -11, 2, 4, 7, 10 },
+        { -2, -6, -8, -10, 1, 5, 7, 9 }, { -2, -5, -8, -10, 1, 4, 7, 9 },
+        { -2, -4, -8, -10, 1, 3, 7, 9 }, { -2, -5, -7, -10, 1, 4, 6, 9 },
+        { -3, -4, -7, -10, 2, 3, 6, 9 }, { -1, -2, -3, -10, 0, 1, 2, 9 },
+        { -4, -6, -8, -9, 3, 5, 7, 8 }, { -3, -5, -7, -9, 2, 4, 6, 8 }
+    };
+
+    int base = block[0];
+    int multiplier = block[1] >> 4;
+    const int* table = modifiers[block[1] & 15];
+    unsigned long long indices = 0;
+    for (unsigned int i = 0; i < 6; ++i)
+        indices = (indices << 8) | block[2 + i];
+
+    // Pixels are indexed by column, starting from the most significant bits.
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        unsigned int index = (unsigned int)(indices >> (45 - i * 3)) & 7;
+        pixels[((i & 3) * 4 + (i >> 2)) * 4 + 3] = clampColor(base + table[index] * multiplier);
+    }
+}
+
+// Decodes a compressed image into RGBA pixels, returning false if the format cannot be decoded.
+static bool decodeCompressedImage(GLenum format, const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba)
+{
+    unsigned int blockWidth, blockHeight, blockBytes;
+    if (!getCompressedBlockSize(format, &blockWidth, &blockHeight, &blockBytes))
+        return false;
+
+    unsigned int blocksX = (width + 3) / 4;
+    unsigned int blocksY = (height + 3) / 4;
+    unsigned char pixels[4 * 4 * 4];
+    for (unsigned int by = 0; by < blocksY; ++by)
+    {
+        for (unsigned int bx = 0; bx < blocksX; ++bx, data += blockBytes)
+        {
+            memset(pixels, 255, sizeof(pixels));
+            switch (format)
+            {
+            case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+                decodeBC1Block(data, true, false, pixels);
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+                decodeBC1Block(data, true, true, pixels);
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+                for (unsigned int i = 0; i < 16; ++i)
+                    pixels[i * 4 + 3] = (unsigned char)(((data[i / 2] >> ((i & 1) * 4)) & 15) * 17);
+                decodeBC1Block(data + 8, false, false, pixels);
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                decodeBC3AlphaBlock(data, pixels);
+                decodeBC1Block(data + 8, false, false, pixels);
+                break;
+            case ETC1_RGB8:
+            case GL_COMPRESSED_RGB8_ETC2:
+                decodeETC2Block(data, false, pixels);
+                break;
+            case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+                decodeETC2Block(data, true, pixels);
+                break;
+            case GL_COMPRESSED_RGBA8_ETC2_EAC:
+                decodeEACAlphaBlock(data, pixels);
+                decodeETC2Block(data + 8, false, pixels);
+                break;
+            default:
+                return false;
+            }
+
+            // Copy the part of the block within the image.
+            unsigned int rows = std::min(4u, height - by * 4);
+            unsigned int columns = std::min(4u, width - bx * 4);
+            for (unsigned int y = 0; y < rows; ++y)
+                memcpy(&rgba[((by * 4 + y) * width + bx * 4) * 4], &pixels[y * 16], columns * 4);
+        }
+    }
+    return true;
+}
+
+static bool readKTX1(const char* path, Stream* stream, TextureKTX* ktx)
+{
+    struct ktx_header
+    {
+        unsigned int endianness;
+        unsigned int glType;
+        unsigned int glTypeSize;
+        unsigned int glFormat;
+        unsigned int glInternalFormat;
+        unsigned int glBaseInternalFormat;
+        unsigned int pixelWidth;
+        unsigned int pixelHeight;
+        unsigned int pixelDepth;
+        unsigned int numberOfArrayElements;
+        unsigned int numberOfFaces;
+        unsigned int numberOfMipmapLevels;
+        unsigned int bytesOfKeyValueData;
+    };
+
+    ktx_header header;
+    if (stream->read(&header, sizeof(ktx_header), 1) != 1)
+    {
+        GP_ERROR("Failed to read header for KTX file '%s'.", path);
+        return false;
+    }
+
+    // Files written on big endian machines have every field byte swapped.
+    bool swap = header.endianness == 0x01020304;
+    if (swap)
+    {
+        unsigned int* fields = (unsigned int*)&header;
+        for (size_t i = 0; i < sizeof(ktx_header) / sizeof(unsigned int); ++i)
+            fields[i] = (fields[i] >> 24) | ((fields[i] >> 8) & 0xFF00) | ((fields[i] << 8) & 0xFF0000) | (fields[i] << 24);
+    }
+    if (header.endianness != 0x04030201 || (swap && header.glTypeSize > 1))
+    {
+        GP_ERROR("Failed to read KTX file '%s': unsupported endianness.", path);
+        return false;
+    }
+    if (header.pixelDepth > 1 || header.numberOfArrayElements > 0 || (header.numberOfFaces != 1 && header.numberOfFaces != 6))
+    {
+        GP_ERROR("Failed to read KTX file '%s': array and volume textures are unsupported.", path);
+        return false;
+    }
+
+    ktx->compressed = header.glType == 0;
+    ktx->internalFormat = header.glInternalFormat;
+    ktx->format = header.glFormat;
+    ktx->texelType = header.glType;
+    if (!ktx->compressed)
+    {
+        // Uncompressed images are uploaded with their unsized format, which OpenGL ES 2 requires.
+        if (header.glType != GL_UNSIGNED_BYTE || (header.glFormat != GL_RGB && header.glFormat != GL_RGBA && header.glFormat != GL_ALPHA))
+        {
+            GP_ERROR("Failed to read KTX file '%s': unsupported pixel format (0x%x, 0x%x).", path, header.glFormat, header.glType);
+            return false;
+        }
+        ktx->internalFormat = header.glFormat;
+    }
+    ktx->width = header.pixelWidth;
+    ktx->height = std::max(header.pixelHeight, 1u);
+    ktx->faceCount = header.numberOfFaces;
+    ktx->levelCount = std::max(header.numberOfMipmapLevels, 1u);
+    ktx->alignment = 4;
+
+    if (header.bytesOfKeyValueData > 0 && !stream->seek(header.bytesOfKeyValueData, SEEK_CUR))
+    {
+        GP_ERROR("Failed to seek past key/value data in KTX file '%s'.", path);
+        return false;
+    }
+
+    // Each level is its size followed by its faces, each padded to four bytes.
+    ktx->images.resize(ktx->levelCount * ktx->faceCount);
+    for (unsigned int level = 0; level < ktx->levelCount; ++level)
+    {
+        unsigned int imageSize;
+        if (stream->read(&imageSize, sizeof(unsigned int), 1) != 1)
+        {
+            GP_ERROR("Failed to read image size for KTX file '%s'.", path);
+            return false;
+        }
+        if (swap)
+            imageSize = (imageSize >> 24) | ((imageSize >> 8) & 0xFF00) | ((imageSize << 8) & 0xFF0000) | (imageSize << 24);
+
+        for (unsigned int face = 0; face < ktx->faceCount; ++face)
+        {
+            std::vector<unsigned char>& image = ktx->images[level * ktx->faceCount + face];
+            image.resize(imageSize);
+            if (imageSize > 0 && stream->read(&image[0], 1, imageSize) != imageSize)
+            {
+                GP_ERROR("Failed to read image data for KTX file '%s'.", path);
+                return false;
+            }
+            unsigned int padding = (4 - (imageSize & 3)) & 3;
+            if (padding > 0 && !stream->seek(padding, SEEK_CUR))
+            {
+                GP_ERROR("Failed to read image data for KTX file '%s'.", path);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool readKTX2(const char* path, Stream* stream, TextureKTX* ktx)
+{
+    struct ktx2_header
+    {
+        unsigned int vkFormat;
+        unsigned int typeSize;
+        unsigned int pixelWidth;
+        unsigned int pixelHeight;
+        unsigned int pixelDepth;
+        unsigned int layerCount;
+        unsigned int faceCount;
+        unsigned int levelCount;
+        unsigned int supercompressionScheme;
+        unsigned int dfdByteOffset;
+        unsigned int dfdByteLength;
+        unsigned int kvdByteOffset;
+        unsigned int kvdByteLength;
+        // The 64-bit offset and length of the supercompression data are split into 32-bit
+        // halves, since the header is not 8-byte aligned in the file.
+        unsigned int sgdByteOffset[2];
+        unsigned int sgdByteLength[2];
+    };
+    static_assert(sizeof(ktx2_header) == 68, "ktx2_header must match the size of the KTX2 file header");
+
+    struct ktx2_level
+    {
+        unsigned long long byteOffset;
+        unsigned long long byteLength;
+        unsigned long long uncompressedByteLength;
+    };
+
+    ktx2_header header;
+    if (stream->read(&header, sizeof(ktx2_header), 1) != 1)
+    {
+        GP_ERROR("Failed to read header for KTX2 file '%s'.", path);
+        return false;
+    }
+    if (header.supercompressionScheme != 0)
+    {
+        GP_ERROR("Failed to read KTX2 file '%s': supercompression scheme %d is unsupported.", path, header.supercompressionScheme);
+        return false;
+    }
+    if (header.pixelDepth > 1 || header.layerCount > 1 || (header.faceCount != 1 && header.faceCount != 6))
+    {
+        GP_ERROR("Failed to read KTX2 file '%s': array and volume textures are unsupported.", path);
+        return false;
+    }
+    if (!getKTX2Format(header.vkFormat, &ktx->internalFormat, &ktx->format, &ktx->texelType))
+    {
+        GP_ERROR("Failed to read KTX2 file '%s': unsupported format (%d).", path, header.vkFormat);
+        return false;
+    }
+
+    ktx->compressed = ktx->format == 0;
+    ktx->width = header.pixelWidth;
+    ktx->height = std::max(header.pixelHeight, 1u);
+    ktx->faceCount = header.faceCount;
+    ktx->levelCount = std::max(header.levelCount, 1u);
+    ktx->alignment = 1;
+
+    std::vector<ktx2_level> levels(ktx->levelCount);
+    if (stream->read(&levels[0], sizeof(ktx2_level), ktx->levelCount) != ktx->levelCount)
+    {
+        GP_ERROR("Failed to read level index for KTX2 file '%s'.", path);
+        return false;
+    }
+
+    // Each level holds its faces one after the other.
+    ktx->images.resize(ktx->levelCount * ktx->faceCount);
+    for (unsigned int level = 0; level < ktx->levelCount; ++level)
+    {
+        size_t faceSize = (size_t)(levels[level].byteLength / ktx->faceCount);
+        if (!stream->seek((long int)levels[level].byteOffset, SEEK_SET))
+        {
+            GP_ERROR("Failed to seek to level %d in KTX2 file '%s'.", level, path);
+            return false;
+        }
+        for (unsigned int face = 0; face < ktx->faceCount; ++face)
+        {
+            std::vector<unsigned char>& image = ktx->images[level * ktx->faceCount + face];
+            image.resize(faceSize);
+            if (faceSize > 0 && stream->read(&image[0], 1, faceSize) != faceSize)
+            {
+                GP_ERROR("Failed to read image data for KTX2 file '%s'.", path);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TextureKTX* Texture::readKTX(const char* path)
+{
+    GP_ASSERT( path );
+
+    static const unsigned char ktx1Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    static const unsigned char ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    std::unique_ptr<Stream> stream(FileSystem::open(path));
+    if (stream.get() == NULL || !stream->canRead())
+    {
+        GP_ERROR("Failed to open file '%s'.", path);
+        return NULL;
+    }
+
+    unsigned char identifier[12];
+    if (stream->read(identifier, 1, 12) != 12)
+    {
+        GP_ERROR("Failed to read KTX file '%s': invalid identifier.", path);
+        return NULL;
+    }
+
+    TextureKTX* ktx = new TextureKTX();
+    bool read = false;
+    if (memcmp(identifier, ktx1Identifier, 12) == 0)
+        read = readKTX1(path, stream.get(), ktx);
+    else if (memcmp(identifier, ktx2Identifier, 12) == 0)
+        read = readKTX2(path, stream.get(), ktx);
+    else
+        GP_ERROR("Failed to read KTX file '%s': invalid identifier.", path);
+    stream->close();
+    if (!read)
+    {
+        SAFE_DELETE(ktx);
+        return NULL;
+    }
+
+    // Check that every image holds all of its pixels or blocks.
+    unsigned int blockWidth = 1, blockHeight = 1, blockBytes = 1;
+    if (ktx->compressed && !getCompressedBlockSize(ktx->internalFormat, &blockWidth, &blockHeight, &blockBytes))
+    {
+        GP_ERROR("Failed to read KTX file '%s': unsupported compressed format (0x%x).", path, ktx->internalFormat);
+        SAFE_DELETE(ktx);
+        return NULL;
+    }
+    ktx->memorySize = 0;
+    for (unsigned int level = 0; level < ktx->levelCount; ++level)
+    {
+        unsigned int width = std::max(ktx->width >> level, 1u);
+        unsigned int height = std::max(ktx->height >> level, 1u);
+        size_t size;
+        if (ktx->compressed)
+        {
+            size = ((width + blockWidth - 1) / blockWidth) * ((height + blockHeight - 1) / blockHeight) * blockBytes;
+        }
+        else
+        {
+            size_t rowSize = width * (ktx->format == GL_RGBA ? 4 : (ktx->format == GL_RGB ? 3 : 1));
+            size = ((rowSize + ktx->alignment - 1) / ktx->alignment * ktx->alignment) * (height - 1) + rowSize;
+        }
+        for (unsigned int face = 0; face < ktx->faceCount; ++face)
+        {
+            if (ktx->images[level * ktx->faceCount + face].size() < size)
+            {
+                GP_ERROR("Failed to read KTX file '%s': level %d is truncated.", path, level);
+                SAFE_DELETE(ktx);
+                return NULL;
+            }
+        }
+        ktx->memorySize += (unsigned int)size * ktx->faceCount;
+    }
+
+    // Decode the formats that the driver does not support.
+    ktx->transcodedFormat = 0;
+    if (ktx->compressed && !isCompressedFormatSupported(ktx->internalFormat))
+    {
+        std::vector<unsigned char> rgba;
+        for (unsigned int level = 0; level < ktx->levelCount; ++level)
+        {
+            unsigned int width = std::max(ktx->width >> level, 1u);
+            unsigned int height = std::max(ktx->height >> level, 1u);
+            for (unsigned int face = 0; face < ktx->faceCount; ++face)
+            {
+                std::vector<unsigned char>& image = ktx->images[level * ktx->faceCount + face];
+                rgba.resize(width * height * 4);
+                if (!decodeCompressedImage(ktx->internalFormat, &image[0], width, height, &rgba[0]))
+                {
+                    GP_ERROR("Failed to load KTX file '%s': compressed format (0x%x) is not supported by the driver and cannot be transcoded.", path, ktx->internalFormat);
+                    SAFE_DELETE(ktx);
+                    return NULL;
+                }
+                image.swap(rgba);
+            }
+        }
+        ktx->compressed = false;
+        ktx->transcodedFormat = ktx->internalFormat;
+        ktx->internalFormat = ktx->format = GL_RGBA;
+        ktx->texelType = GL_UNSIGNED_BYTE;
+        ktx->alignment = 1;
+        ktx->memorySize = computeMipmapSize(ktx->width, ktx->height, ktx->levelCount, 4) * ktx->faceCount;
+    }
+
+    return ktx;
+}
+
+Texture* Texture::createKTX(const char* path)
+{
+    queryCompressedFormats();
+
+    TextureKTX* ktx = readKTX(path);
+    if (ktx == NULL)
+        return NULL;
+
+    Texture* texture = createKTX(ktx);
+    SAFE_DELETE(ktx);
+    return texture;
+}
+
+Texture* Texture::createKTX(TextureKTX* ktx)
+{
+    GP_ASSERT( ktx );
+
+    if (ktx->transcodedFormat != 0)
+    {
+        GP_WARN("Compressed texture format (0x%x) is not supported by the driver; texture was decoded to RGBA.", ktx->transcodedFormat);
+    }
+
+    GLenum target = ktx->faceCount > 1 ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+    GLuint textureId;
+    GL_ASSERT( glGenTextures(1, &textureId) );
+    GL_ASSERT( glBindTexture(target, textureId) );
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, ktx->alignment) );
+
+    Filter filterMin = ktx->levelCount > 1 ? NEAREST_MIPMAP_LINEAR : LINEAR;
+    GL_ASSERT( glTexParameteri(target, GL_TEXTURE_MIN_FILTER, filterMin) );
+#if !defined(OPENGL_ES) || defined(GL_ES_VERSION_3_0) && GL_ES_VERSION_3_0
+    if (ktx->levelCount > 1)
+    {
+        // Files may hold a partial mipmap chain.
+        GL_ASSERT( glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, ktx->levelCount - 1) );
+    }
+#endif
+
+    // Load the data for each level.
+    for (unsigned int level = 0; level < ktx->levelCount; ++level)
+    {
+        GLsizei width = std::max(ktx->width >> level, 1u);
+        GLsizei height = std::max(ktx->height >> level, 1u);
+        for (unsigned int face = 0; face < ktx->faceCount; ++face)
+        {
+            GLenum faceTarget = ktx->faceCount > 1 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : GL_TEXTURE_2D;
+            const std::vector<unsigned char>& image = ktx->images[level * ktx->faceCount + face];
+            if (ktx->compressed)
+            {
+                GL_ASSERT( glCompressedTexImage2D(faceTarget, level, ktx->internalFormat, width, height, 0, (GLsizei)image.size(), &image[0]) );
+            }
+            else
+            {
+                GL_ASSERT( glTexImage2D(faceTarget, level, ktx->internalFormat, width, height, 0, ktx->format, ktx->texelType, &image[0]) );
+            }
+        }
+    }
+
+    // The other uploads expect tightly packed rows.
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+
+    Texture* texture = new Texture();
+    texture->_handle = textureId;
+    texture->_type = (Type)target;
+    texture->_width = ktx->width;
+    texture->_height = ktx->height;
+    texture->_mipmapped = ktx->levelCount > 1;
+    texture->_compressed = ktx->compressed;
+    texture->_filterMin = filterMin;
+    texture->_memorySize = ktx->memorySize;
+    texture->_uncompressedMemorySize = computeMipmapSize(ktx->width, ktx->height, ktx->levelCount, 4) * ktx->faceCount;
+    if (!ktx->compressed)
+    {
+        texture->_format = ktx->format == GL_RGBA ? RGBA : (ktx->format == GL_RGB ? RGB : ALPHA);
+        texture->_internalFormat = ktx->internalFormat;
+        texture->_texelType = ktx->texelType;
+        texture->_bpp = getFormatBPP(texture->_format);
+    }
 
     // Restore the texture id
     GL_ASSERT( glBindTexture((GLenum)__currentTextureType, __currentTextureId) );
@@ -1193,6 +2467,10 @@ void Texture::generateMipmaps()
             GL_ASSERT( glGenerateMipmap(target) );
 
         _mipmapped = true;
+        if (!_compressed)
+        {
+            _memorySize = _uncompressedMemorySize = computeMipmapSize(_width, _height, 0, _bpp) * (_type == TEXTURE_CUBE ? 6 : 1);
+        }
 
         // Restore the texture id
         GL_ASSERT( glBindTexture((GLenum)__currentTextureType, __currentTextureId) );
@@ -1209,6 +2487,16 @@ bool Texture::isCompressed() const
     return _compressed;
 }
 
+unsigned int Texture::getMemorySize() const
+{
+    return _memorySize;
+}
+
+unsigned int Texture::getUncompressedMemorySize() const
+{
+    return _uncompressedMemorySize;
+}
+
 const char* Texture::getSerializedClassName() const
 {
     return "gameplay::Texture";
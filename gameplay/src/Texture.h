@@ -9,6 +9,8 @@ namespace gameplay
 {
 
 class Image;
+struct TextureAsyncLoad;
+struct TextureKTX;
 
 /**
  * Defines a standard texture.
@@ -17,6 +19,7 @@ class Texture : public Ref, public Serializable
 {
     friend class Serializer::Activator;
     friend class Sampler;
+    friend class Game;
 
 public:
 
@@ -93,6 +96,7 @@ public:
     {
         friend class Serializer::Activator;
         friend class Texture;
+        friend class MaterialParameter;
 
     public:
 
@@ -199,6 +203,10 @@ public:
     /**
      * Creates a texture from the given image resource.
      *
+     * PNG, QOI, PVR, DDS, KTX and KTX2 files are supported. The ETC2, ASTC and BCn images of KTX files
+     * are uploaded as they are when the driver supports their format; otherwise ETC1, ETC2 and
+     * BC1-3 images are decoded to RGBA, and other formats fail to load.
+     *
      * Note that for textures that include mipmap data in the source data (such as most compressed textures),
      * the generateMipmaps flags should NOT be set to true.
      *
@@ -210,11 +218,69 @@ public:
      */
     static Texture* create(const char* path, bool generateMipmaps = false);
 
+    /**
+     * Defines a callback called when a texture created by createAsync has finished loading.
+     *
+     * @param texture The texture.
+     * @param success true if the texture was loaded, false if it could not be loaded
+     *      (in which case it keeps its placeholder image and is no longer shared by path,
+     *      so later requests for the path try to load it again).
+     * @param cookie The cookie passed to createAsync.
+     */
+    typedef void (*LoadCallback)(Texture* texture, bool success, void* cookie);
+
+    /**
+     * Creates a texture from the given image resource without waiting for it to load.
+     *
+     * The returned texture holds a 1x1 transparent placeholder image until the resource has been
+     * decoded on a worker thread and uploaded. Uploads happen at the end of each frame, up to the
+     * upload budget, and the callback is called on the game thread once the texture is uploaded.
+     * Textures are shared with Texture::create by path, so a texture that is already loaded is
+     * returned directly and the callback is called immediately.
+     *
+     * PNG and QOI images are decoded and KTX files are read on the worker threads; other compressed
+     * formats are read when uploaded. The mipmaps of images are generated on the worker threads too,
+     * with the same box filter as the mipmaps generated by Texture::create.
+     *
+     * @param path The image resource path.
+     * @param generateMipmaps true to auto-generate a full mipmap chain, false otherwise.
+     * @param callback The callback to call when the texture has loaded (optional).
+     * @param cookie A pointer passed to the callback (optional).
+     *
+     * @return The new texture.
+     */
+    static Texture* createAsync(const char* path, bool generateMipmaps = false, LoadCallback callback = NULL, void* cookie = NULL);
+
+    /**
+     * Sets the number of bytes of texture data uploaded per frame for textures created with createAsync.
+     *
+     * At least one texture is uploaded per frame when any are ready, whatever its size.
+     *
+     * @param bytes The upload budget in bytes.
+     */
+    static void setUploadBudget(unsigned int bytes);
+
+    /**
+     * Gets the number of bytes of texture data uploaded per frame for textures created with createAsync.
+     *
+     * @return The upload budget in bytes.
+     */
+    static unsigned int getUploadBudget();
+
+    /**
+     * Determines if this texture is still being loaded by createAsync.
+     *
+     * @return true if the texture still holds its placeholder image, false otherwise.
+     */
+    bool isLoading() const;
+
     /**
      * Creates a texture from the given image.
      *
+     * If the image has mipmaps (see Image::generateMipmaps), they are uploaded with it.
+     *
      * @param image The image containing the texture data.
-     * @param generateMipmaps True to generate a full mipmap chain, false otherwise.
+     * @param generateMipmaps True to generate a full mipmap chain if the image has no mipmaps, false otherwise.
      *
      * @return The new texture, or NULL if the image is not of a supported texture format.
      * @script{create}
@@ -269,6 +335,19 @@ public:
      */
     void setData(const unsigned char* data);
 
+    /**
+     * Replaces a region of the image of a 2D texture.
+     *
+     * Mipmaps are not regenerated.
+     *
+     * @param data Raw texture data for the region (expected to be tightly packed).
+     * @param x The left of the region.
+     * @param y The top of the region.
+     * @param width The width of the region.
+     * @param height The height of the region.
+     */
+    void setData(const unsigned char* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
     /**
      * Returns the path that the texture was originally loaded from (if applicable).
      *
@@ -321,6 +400,23 @@ public:
      */
     bool isCompressed() const;
 
+    /**
+     * Gets the amount of memory used by the images of this texture, including its mipmaps.
+     *
+     * @return The memory size in bytes.
+     */
+    unsigned int getMemorySize() const;
+
+    /**
+     * Gets the amount of memory the images of this texture would use without compression,
+     * as RGBA for compressed textures.
+     *
+     * The difference with getMemorySize is the memory saved by compression.
+     *
+     * @return The uncompressed memory size in bytes.
+     */
+    unsigned int getUncompressedMemorySize() const;
+
     /**
      * Returns the texture handle.
      *
@@ -384,6 +480,17 @@ private:
 
     static Texture* createCompressedDDS(const char* path);
 
+    static Texture* createKTX(const char* path);
+
+    static Texture* createKTX(TextureKTX* ktx);
+
+    /**
+     * Reads a KTX or KTX2 file, decoding its images if the driver does not support their format.
+     *
+     * This does not use GL, so it can be called on a worker thread.
+     */
+    static TextureKTX* readKTX(const char* path);
+
     static GLubyte* readCompressedPVRTC(const char* path, Stream* stream, GLsizei* width, GLsizei* height,
                                         GLenum* format, unsigned int* mipMapCount, unsigned int* faceCount,
                                         GLenum faces[6]);
@@ -392,6 +499,26 @@ private:
                                               GLenum* format, unsigned int* mipMapCount, unsigned int* faceCount,
                                               GLenum faces[6]);
 
+    /**
+     * Decodes the textures queued by createAsync, on a worker thread.
+     */
+    static void decodeAsync();
+
+    /**
+     * Uploads the decoded textures, up to the upload budget.
+     */
+    static void frameEnded();
+
+    /**
+     * Stops the threads decoding textures and discards the textures still being loaded.
+     */
+    static void finalize();
+
+    /**
+     * Takes over the texture object of another texture, giving it this texture's object.
+     */
+    void adopt(Texture* texture);
+
     static int getMaskByteIndex(unsigned int mask);
     static GLint getFormatInternal(Format format);
     static GLenum getFormatTexel(Format format);
@@ -405,6 +532,7 @@ private:
     unsigned int _height;
     bool _mipmapped;
     bool _cached;
+    TextureAsyncLoad* _asyncLoad;
     bool _compressed;
     Wrap _wrapS;
     Wrap _wrapT;
@@ -414,6 +542,8 @@ private:
     GLint _internalFormat;
     GLenum _texelType;
     size_t _bpp;
+    unsigned int _memorySize;
+    unsigned int _uncompressedMemorySize;
 };
 
 }
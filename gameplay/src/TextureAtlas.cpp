@@ -0,0 +1,534 @@
+#include "Base.h"
+#include "TextureAtlas.h"
+#include "SerializerJson.h"
+
+namespace gameplay
+{
+
+// Atlases whose images are used in place of their paths.
+static std::vector<TextureAtlas*> __atlases;
+
+TextureAtlas::Entry::Entry()
+    : page(0), x(0), y(0), width(0), height(0)
+{
+}
+
+const char* TextureAtlas::Entry::getSerializedClassName() const
+{
+    return "gameplay::TextureAtlas::Entry";
+}
+
+void TextureAtlas::Entry::serialize(Serializer* serializer)
+{
+    serializer->writeString("path", path.c_str(), "");
+    serializer->writeInt("page", page, 0);
+    serializer->writeInt("x", x, 0);
+    serializer->writeInt("y", y, 0);
+    serializer->writeInt("width", width, 0);
+    serializer->writeInt("height", height, 0);
+}
+
+void TextureAtlas::Entry::deserialize(Serializer* serializer)
+{
+    serializer->readString("path", path, "");
+    page = serializer->readInt("page", 0);
+    x = serializer->readInt("x", 0);
+    y = serializer->readInt("y", 0);
+    width = serializer->readInt("width", 0);
+    height = serializer->readInt("height", 0);
+}
+
+TextureAtlas::Page::Page()
+    : width(0), height(0), image(NULL), texture(NULL)
+{
+}
+
+const char* TextureAtlas::Page::getSerializedClassName() const
+{
+    return "gameplay::TextureAtlas::Page";
+}
+
+void TextureAtlas::Page::serialize(Serializer* serializer)
+{
+    serializer->writeString("path", path.c_str(), "");
+    serializer->writeInt("width", width, 0);
+    serializer->writeInt("height", height, 0);
+}
+
+void TextureAtlas::Page::deserialize(Serializer* serializer)
+{
+    serializer->readString("path", path, "");
+    width = serializer->readInt("width", 0);
+    height = serializer->readInt("height", 0);
+}
+
+TextureAtlas::TextureAtlas()
+    : _pageWidth(0), _pageHeight(0), _padding(0), _extrusion(0)
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    unregisterAtlas(this);
+
+    for (size_t i = 0, count = _pages.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_pages[i].image);
+        SAFE_RELEASE(_pages[i].texture);
+    }
+    for (size_t i = 0, count = _pending.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_pending[i].image);
+    }
+}
+
+bool TextureAtlas::PendingImage::operator<(const PendingImage& other) const
+{
+    if (image->getHeight() != other.image->getHeight())
+        return image->getHeight() > other.image->getHeight();
+    return image->getWidth() > other.image->getWidth();
+}
+
+TextureAtlas* TextureAtlas::create(unsigned int pageWidth, unsigned int pageHeight, unsigned int padding, unsigned int extrusion)
+{
+    GP_ASSERT(pageWidth > 0 && pageHeight > 0);
+
+    TextureAtlas* atlas = new TextureAtlas();
+    atlas->_pageWidth = pageWidth;
+    atlas->_pageHeight = pageHeight;
+    atlas->_padding = padding;
+    atlas->_extrusion = extrusion;
+    return atlas;
+}
+
+TextureAtlas* TextureAtlas::load(const char* path)
+{
+    GP_ASSERT(path);
+
+    TextureAtlas* atlas = NULL;
+    Serializer* reader = Serializer::createReader(path);
+    if (reader)
+    {
+        atlas = dynamic_cast<TextureAtlas*>(reader->readObject(NULL));
+        reader->close();
+        SAFE_DELETE(reader);
+    }
+    if (!atlas)
+    {
+        GP_WARN("Failed to load texture atlas: %s", path);
+    }
+    return atlas;
+}
+
+bool TextureAtlas::add(const char* path)
+{
+    GP_ASSERT(path);
+
+    Image* image = Image::create(path);
+    if (!image)
+    {
+        GP_WARN("Failed to load image for texture atlas: %s", path);
+        return false;
+    }
+    bool added = add(path, image);
+    image->release();
+    return added;
+}
+
+bool TextureAtlas::add(const char* path, Image* image)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(image);
+
+    bool pending = false;
+    for (size_t i = 0, count = _pending.size(); i < count && !pending; ++i)
+    {
+        pending = _pending[i].path == path;
+    }
+    if (pending || findEntry(path))
+    {
+        GP_WARN("Image is already in the texture atlas: %s", path);
+        return false;
+    }
+
+    PendingImage pendingImage;
+    pendingImage.path = path;
+    pendingImage.image = image;
+    image->addRef();
+    _pending.push_back(pendingImage);
+    return true;
+}
+
+static void copyImage(const Image* image, Image* page, unsigned int x, unsigned int y, unsigned int extrusion)
+{
+    GP_ASSERT(page->getFormat() == Image::RGBA);
+
+    // Image rows are stored bottom row first, while (x, y) is the top left of the image in
+    // the page. Pixels outside of the image repeat its nearest edge pixel.
+    int width = (int)image->getWidth();
+    int height = (int)image->getHeight();
+    int e = (int)extrusion;
+    unsigned int pixelSize = image->getFormat() == Image::RGBA ? 4 : 3;
+    const unsigned char* src = image->getData();
+    unsigned char* dst = page->getData();
+    for (int row = -e; row < height + e; ++row)
+    {
+        int srcRow = height - 1 - std::max(0, std::min(height - 1, row));
+        unsigned int dstRow = page->getHeight() - 1 - (y + row);
+        const unsigned char* srcPixels = src + srcRow * width * pixelSize;
+        unsigned char* dstPixel = dst + (dstRow * page->getWidth() + x - e) * 4;
+        for (int col = -e; col < width + e; ++col, dstPixel += 4)
+        {
+            const unsigned char* srcPixel = srcPixels + std::max(0, std::min(width - 1, col)) * pixelSize;
+            dstPixel[0] = srcPixel[0];
+            dstPixel[1] = srcPixel[1];
+            dstPixel[2] = srcPixel[2];
+            dstPixel[3] = pixelSize == 4 ? srcPixel[3] : 255;
+        }
+    }
+}
+
+bool TextureAtlas::build()
+{
+    // Pack the tallest images first, which leaves the least room unused under the skyline.
+    std::stable_sort(_pending.begin(), _pending.end());
+
+    bool packed = true;
+    std::vector<bool> pagesChanged(_pages.size(), false);
+    for (size_t i = 0, count = _pending.size(); i < count; ++i)
+    {
+        Image* image = _pending[i].image;
+        unsigned int width = image->getWidth() + _extrusion * 2 + _padding;
+        unsigned int height = image->getHeight() + _extrusion * 2 + _padding;
+        if (width > _pageWidth || height > _pageHeight)
+        {
+            GP_WARN("Image is too large for the texture atlas pages: %s", _pending[i].path.c_str());
+            packed = false;
+            SAFE_RELEASE(_pending[i].image);
+            continue;
+        }
+
+        // Use the first page with room for the image, or start a new one.
+        unsigned int x = 0;
+        unsigned int y = 0;
+        int segment = -1;
+        unsigned int pageIndex = 0;
+        for (unsigned int pageCount = (unsigned int)_pages.size(); pageIndex < pageCount && segment < 0; )
+        {
+            segment = findPosition(_pages[pageIndex], width, height, &x, &y);
+            if (segment < 0)
+                ++pageIndex;
+        }
+        if (segment < 0)
+        {
+            pageIndex = addPage();
+            pagesChanged.push_back(false);
+            segment = findPosition(_pages[pageIndex], width, height, &x, &y);
+            GP_ASSERT(segment >= 0);
+        }
+
+        Page& page = _pages[pageIndex];
+        insert(page, segment, x, y, width, height);
+        copyImage(image, page.image, x + _extrusion, y + _extrusion, _extrusion);
+        pagesChanged[pageIndex] = true;
+
+        Entry entry;
+        entry.path = _pending[i].path;
+        entry.page = pageIndex;
+        entry.x = x + _extrusion;
+        entry.y = y + _extrusion;
+        entry.width = image->getWidth();
+        entry.height = image->getHeight();
+        addEntry(entry);
+
+        SAFE_RELEASE(_pending[i].image);
+    }
+    _pending.clear();
+
+    // Update the textures already created for the pages.
+    for (size_t i = 0, count = _pages.size(); i < count; ++i)
+    {
+        if (pagesChanged[i] && _pages[i].texture)
+        {
+            _pages[i].texture->setData(_pages[i].image->getData());
+        }
+    }
+
+    return packed;
+}
+
+unsigned int TextureAtlas::addPage()
+{
+    Page page;
+    page.width = _pageWidth;
+    page.height = _pageHeight;
+    page.image = Image::create(_pageWidth, _pageHeight, Image::RGBA);
+    memset(page.image->getData(), 0, _pageWidth * _pageHeight * 4);
+
+    Page::Segment segment;
+    segment.x = 0;
+    segment.y = 0;
+    segment.width = _pageWidth;
+    page.skyline.push_back(segment);
+
+    _pages.push_back(page);
+    return (unsigned int)_pages.size() - 1;
+}
+
+int TextureAtlas::findPosition(const Page& page, unsigned int width, unsigned int height, unsigned int* x, unsigned int* y)
+{
+    // Place the rectangle where its bottom is the highest up, resting on the lowest of the
+    // skyline segments it spans, and prefer the narrowest segment among equal positions.
+    const std::vector<Page::Segment>& skyline = page.skyline;
+    int best = -1;
+    unsigned int bestBottom = 0;
+    unsigned int bestWidth = 0;
+    for (size_t i = 0, count = skyline.size(); i < count; ++i)
+    {
+        if (skyline[i].x + width > page.width)
+            break;
+
+        unsigned int top = 0;
+        for (size_t j = i, spanned = 0; spanned < width; ++j)
+        {
+            top = std::max(top, skyline[j].y);
+            spanned += skyline[j].width;
+        }
+        unsigned int bottom = top + height;
+        if (bottom > page.height)
+            continue;
+
+        if (best < 0 || bottom < bestBottom || (bottom == bestBottom && skyline[i].width < bestWidth))
+        {
+            best = (int)i;
+            bestBottom = bottom;
+            bestWidth = skyline[i].width;
+            *x = skyline[i].x;
+            *y = top;
+        }
+    }
+    return best;
+}
+
+void TextureAtlas::insert(Page& page, int segment, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+    std::vector<Page::Segment>& skyline = page.skyline;
+    Page::Segment top;
+    top.x = x;
+    top.y = y + height;
+    top.width = width;
+    skyline.insert(skyline.begin() + segment, top);
+
+    // Remove or shorten the segments now under the rectangle.
+    unsigned int right = x + width;
+    for (size_t i = segment + 1; i < skyline.size(); )
+    {
+        Page::Segment& next = skyline[i];
+        if (next.x >= right)
+            break;
+        if (next.x + next.width <= right)
+        {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+        next.width -= right - next.x;
+        next.x = right;
+        break;
+    }
+
+    // Merge neighbouring segments of the same height.
+    for (size_t i = 0; i + 1 < skyline.size(); )
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+void TextureAtlas::addEntry(const Entry& entry)
+{
+    _entryIndices[entry.path] = (unsigned int)_entries.size();
+    _entries.push_back(entry);
+}
+
+bool TextureAtlas::save(const char* path)
+{
+    GP_ASSERT(path);
+
+    // Name the pages after the lookup table, without its extension.
+    std::string base = path;
+    size_t extension = base.find_last_of('.');
+    size_t separator = base.find_last_of("/\\");
+    if (extension != std::string::npos && (separator == std::string::npos || extension > separator))
+        base.erase(extension);
+
+    for (size_t i = 0, count = _pages.size(); i < count; ++i)
+    {
+        // Pages of a loaded atlas that were not packed again are already saved.
+        Page& page = _pages[i];
+        if (!page.image)
+            continue;
+
+        std::ostringstream pagePath;
+        pagePath << base << "_" << i << ".qoi";
+        page.path = pagePath.str();
+        if (!page.image->saveQOI(page.path.c_str()))
+        {
+            GP_WARN("Failed to save texture atlas page: %s", page.path.c_str());
+            return false;
+        }
+    }
+
+    Serializer* writer = SerializerJson::createWriter(path);
+    if (!writer)
+    {
+        GP_WARN("Failed to save texture atlas: %s", path);
+        return false;
+    }
+    writer->writeObject(NULL, this);
+    writer->close();
+    SAFE_DELETE(writer);
+    return true;
+}
+
+unsigned int TextureAtlas::getPageCount() const
+{
+    return (unsigned int)_pages.size();
+}
+
+Image* TextureAtlas::getPageImage(unsigned int index) const
+{
+    GP_ASSERT(index < _pages.size());
+    return _pages[index].image;
+}
+
+Texture* TextureAtlas::getPageTexture(unsigned int index)
+{
+    GP_ASSERT(index < _pages.size());
+
+    Page& page = _pages[index];
+    if (!page.texture)
+    {
+        if (page.image)
+            page.texture = Texture::create(page.image, true);
+        else
+            page.texture = Texture::create(page.path.c_str(), true);
+    }
+    return page.texture;
+}
+
+unsigned int TextureAtlas::getEntryCount() const
+{
+    return (unsigned int)_entries.size();
+}
+
+const TextureAtlas::Entry& TextureAtlas::getEntry(unsigned int index) const
+{
+    GP_ASSERT(index < _entries.size());
+    return _entries[index];
+}
+
+const TextureAtlas::Entry* TextureAtlas::findEntry(const char* path) const
+{
+    GP_ASSERT(path);
+
+    std::unordered_map<std::string, unsigned int>::const_iterator itr = _entryIndices.find(path);
+    return itr != _entryIndices.end() ? &_entries[itr->second] : NULL;
+}
+
+void TextureAtlas::registerAtlas(TextureAtlas* atlas)
+{
+    GP_ASSERT(atlas);
+
+    if (std::find(__atlases.begin(), __atlases.end(), atlas) == __atlases.end())
+        __atlases.push_back(atlas);
+}
+
+void TextureAtlas::unregisterAtlas(TextureAtlas* atlas)
+{
+    std::vector<TextureAtlas*>::iterator itr = std::find(__atlases.begin(), __atlases.end(), atlas);
+    if (itr != __atlases.end())
+        __atlases.erase(itr);
+}
+
+bool TextureAtlas::lookup(const char* path, Texture** texture, Rectangle* region)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(texture);
+    GP_ASSERT(region);
+
+    for (size_t i = 0, count = __atlases.size(); i < count; ++i)
+    {
+        const Entry* entry = __atlases[i]->findEntry(path);
+        if (!entry)
+            continue;
+
+        Texture* pageTexture = __atlases[i]->getPageTexture(entry->page);
+        if (!pageTexture)
+            return false;
+
+        *texture = pageTexture;
+        region->set((float)entry->x, (float)entry->y, (float)entry->width, (float)entry->height);
+        return true;
+    }
+    return false;
+}
+
+Serializable* TextureAtlas::createInstance()
+{
+    return static_cast<Serializable*>(new TextureAtlas());
+}
+
+const char* TextureAtlas::getSerializedClassName() const
+{
+    return "gameplay::TextureAtlas";
+}
+
+void TextureAtlas::serialize(Serializer* serializer)
+{
+    serializer->writeInt("pageWidth", _pageWidth, 0);
+    serializer->writeInt("pageHeight", _pageHeight, 0);
+    serializer->writeInt("padding", _padding, 0);
+    serializer->writeInt("extrusion", _extrusion, 0);
+    serializer->writeObjectList("pages", (unsigned int)_pages.size());
+    for (size_t i = 0, count = _pages.size(); i < count; ++i)
+    {
+        serializer->writeObject(NULL, &_pages[i]);
+    }
+    serializer->writeObjectList("entries", (unsigned int)_entries.size());
+    for (size_t i = 0, count = _entries.size(); i < count; ++i)
+    {
+        serializer->writeObject(NULL, &_entries[i]);
+    }
+}
+
+void TextureAtlas::deserialize(Serializer* serializer)
+{
+    _pageWidth = serializer->readInt("pageWidth", 0);
+    _pageHeight = serializer->readInt("pageHeight", 0);
+    _padding = serializer->readInt("padding", 0);
+    _extrusion = serializer->readInt("extrusion", 0);
+
+    // Loaded pages have no skyline, so images added later go to new pages.
+    unsigned int pageCount = serializer->readObjectList("pages");
+    _pages.resize(pageCount);
+    for (unsigned int i = 0; i < pageCount; ++i)
+    {
+        serializer->readObject(NULL, &_pages[i]);
+    }
+    unsigned int entryCount = serializer->readObjectList("entries");
+    for (unsigned int i = 0; i < entryCount; ++i)
+    {
+        Entry entry;
+        serializer->readObject(NULL, &entry);
+        addEntry(entry);
+    }
+}
+
+}
@@ -0,0 +1,338 @@
+#ifndef TEXTUREATLAS_H_
+#define TEXTUREATLAS_H_
+
+#include "Ref.h"
+#include "Serializable.h"
+#include "Image.h"
+#include "Texture.h"
+#include "Rectangle.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a set of texture pages that many small images are packed into.
+ *
+ * Images are added to the atlas and then packed together by build(), tallest first, with
+ * a skyline packer. Each image is surrounded by copies of its edge pixels (the extrusion)
+ * and by empty pixels (the padding), so that filtering and mipmapping do not sample its
+ * neighbours. When an image does not fit into any page, a new page is started.
+ *
+ * Packing works on images held in memory, so atlases can be built at runtime or ahead of
+ * time. save() writes the pages as QOI images along with a lookup table that load() reads
+ * back, without packing again.
+ *
+ * When an atlas is registered, sprites, tile sets and particle emitters created from the
+ * path of one of its images draw that image from the atlas page instead of loading it as
+ * a texture of its own, so they share textures and can be batched together. Their frame
+ * and tile coordinates remain relative to the original image.
+ */
+class TextureAtlas : public Ref, public Serializable
+{
+    friend class Serializer::Activator;
+
+public:
+
+    /**
+     * Defines an image packed into the atlas.
+     */
+    class Entry : public Serializable
+    {
+    public:
+
+        /**
+         * Constructor.
+         */
+        Entry();
+
+        /**
+         * @see Serializable::getSerializedClassName
+         */
+        const char* getSerializedClassName() const;
+
+        /**
+         * @see Serializable::serialize
+         */
+        void serialize(Serializer* serializer);
+
+        /**
+         * @see Serializable::deserialize
+         */
+        void deserialize(Serializer* serializer);
+
+        /**
+         * The path of the image.
+         */
+        std::string path;
+
+        /**
+         * The index of the page holding the image.
+         */
+        unsigned int page;
+
+        /**
+         * The left of the image in the page, in pixels.
+         */
+        unsigned int x;
+
+        /**
+         * The top of the image in the page, in pixels.
+         */
+        unsigned int y;
+
+        /**
+         * The width of the image.
+         */
+        unsigned int width;
+
+        /**
+         * The height of the image.
+         */
+        unsigned int height;
+    };
+
+    /**
+     * Creates a new, empty texture atlas.
+     *
+     * @param pageWidth The width of the pages in pixels.
+     * @param pageHeight The height of the pages in pixels.
+     * @param padding The number of empty pixels between images.
+     * @param extrusion The number of times the edge pixels of each image are repeated around it.
+     *
+     * @return The new texture atlas.
+     * @script{create}
+     */
+    static TextureAtlas* create(unsigned int pageWidth = 1024, unsigned int pageHeight = 1024,
+                                unsigned int padding = 2, unsigned int extrusion = 1);
+
+    /**
+     * Loads a texture atlas from a lookup table written by save().
+     *
+     * The pages are loaded as textures the first time they are requested.
+     *
+     * @param path The path of the lookup table.
+     *
+     * @return The texture atlas, or NULL if it could not be loaded.
+     * @script{create}
+     */
+    static TextureAtlas* load(const char* path);
+
+    /**
+     * Adds an image to be packed by the next call to build().
+     *
+     * @param path The path of the image, which also identifies it within the atlas.
+     *
+     * @return true if the image was loaded, false otherwise.
+     */
+    bool add(const char* path);
+
+    /**
+     * Adds an image to be packed by the next call to build().
+     *
+     * @param path The path identifying the image within the atlas.
+     * @param image The image to pack.
+     *
+     * @return true if the image was added, false if the atlas already has an image with that path.
+     */
+    bool add(const char* path, Image* image);
+
+    /**
+     * Packs the images added since the last build into the pages of the atlas.
+     *
+     * Pages that already have a texture are updated with their new content.
+     *
+     * @return true if all images were packed, false if some are too large for a page.
+     */
+    bool build();
+
+    /**
+     * Saves the pages and the lookup table of the atlas.
+     *
+     * The pages are written next to the lookup table, as QOI images named after it.
+     *
+     * @param path The path of the lookup table.
+     *
+     * @return true if the atlas was saved, false otherwise.
+     */
+    bool save(const char* path);
+
+    /**
+     * Gets the number of pages in the atlas.
+     *
+     * @return The number of pages.
+     */
+    unsigned int getPageCount() const;
+
+    /**
+     * Gets the image of a page.
+     *
+     * @param index The index of the page.
+     *
+     * @return The image of the page, or NULL if the atlas was loaded and the page was not packed in memory.
+     */
+    Image* getPageImage(unsigned int index) const;
+
+    /**
+     * Gets the texture of a page, creating it if needed.
+     *
+     * @param index The index of the page.
+     *
+     * @return The texture of the page, or NULL if it could not be created.
+     */
+    Texture* getPageTexture(unsigned int index);
+
+    /**
+     * Gets the number of images packed into the atlas.
+     *
+     * @return The number of packed images.
+     */
+    unsigned int getEntryCount() const;
+
+    /**
+     * Gets an image packed into the atlas.
+     *
+     * @param index The index of the entry.
+     *
+     * @return The entry.
+     */
+    const Entry& getEntry(unsigned int index) const;
+
+    /**
+     * Finds a packed image by its path.
+     *
+     * @param path The path of the image.
+     *
+     * @return The entry of the image, or NULL if it is not in the atlas.
+     */
+    const Entry* findEntry(const char* path) const;
+
+    /**
+     * Registers an atlas, so that the images packed into it are used in place of their paths.
+     *
+     * The atlas stays registered until it is unregistered or destroyed.
+     *
+     * @param atlas The atlas to register.
+     */
+    static void registerAtlas(TextureAtlas* atlas);
+
+    /**
+     * Unregisters an atlas.
+     *
+     * Objects created from its images keep using its page textures.
+     *
+     * @param atlas The atlas to unregister.
+     */
+    static void unregisterAtlas(TextureAtlas* atlas);
+
+    /**
+     * Looks up an image path in the registered atlases.
+     *
+     * @param path The path of the image.
+     * @param texture Populated with the texture of the page holding the image, which is owned by the atlas.
+     * @param region Populated with the region of the image within the page, in pixels from the top left.
+     *
+     * @return true if the image is in a registered atlas, false otherwise.
+     */
+    static bool lookup(const char* path, Texture** texture, Rectangle* region);
+
+    /**
+     * @see Serializer::Activator::CreateInstanceCallback
+     */
+    static Serializable* createInstance();
+
+    /**
+     * @see Serializable::getSerializedClassName
+     */
+    const char* getSerializedClassName() const;
+
+    /**
+     * @see Serializable::serialize
+     */
+    void serialize(Serializer* serializer);
+
+    /**
+     * @see Serializable::deserialize
+     */
+    void deserialize(Serializer* serializer);
+
+private:
+
+    /**
+     * Defines a page of the atlas.
+     */
+    class Page : public Serializable
+    {
+    public:
+
+        struct Segment
+        {
+            unsigned int x;
+            unsigned int y;
+            unsigned int width;
+        };
+
+        Page();
+
+        const char* getSerializedClassName() const;
+
+        void serialize(Serializer* serializer);
+
+        void deserialize(Serializer* serializer);
+
+        std::string path;
+        unsigned int width;
+        unsigned int height;
+        Image* image;
+        Texture* texture;
+        std::vector<Segment> skyline;
+    };
+
+    struct PendingImage
+    {
+        bool operator<(const PendingImage& other) const;
+
+        std::string path;
+        Image* image;
+    };
+
+    /**
+     * Constructor.
+     */
+    TextureAtlas();
+
+    /**
+     * Destructor.
+     */
+    ~TextureAtlas();
+
+    /**
+     * Hidden copy constructor.
+     */
+    TextureAtlas(const TextureAtlas& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    TextureAtlas& operator=(const TextureAtlas&);
+
+    unsigned int addPage();
+
+    static int findPosition(const Page& page, unsigned int width, unsigned int height, unsigned int* x, unsigned int* y);
+
+    static void insert(Page& page, int segment, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+    void addEntry(const Entry& entry);
+
+    unsigned int _pageWidth;
+    unsigned int _pageHeight;
+    unsigned int _padding;
+    unsigned int _extrusion;
+    std::vector<Page> _pages;
+    std::vector<Entry> _entries;
+    std::unordered_map<std::string, unsigned int> _entryIndices;
+    std::vector<PendingImage> _pending;
+};
+
+}
+
+#endif
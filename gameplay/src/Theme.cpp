@@ -10,7 +10,7 @@ namespace gameplay
 static std::vector<Theme*> __themeCache;
 static Theme* __defaultTheme = NULL;
 
-Theme::Theme() : _texture(NULL), _spriteBatch(NULL), _emptyImage(NULL)
+Theme::Theme() : _texture(NULL), _spriteBatch(NULL), _emptyImage(NULL), _indexedStyleCount(0)
 {
 }
 
@@ -504,6 +504,21 @@ Theme::Style* Theme::getStyle(const char* name) const
 {
     GP_ASSERT(name);
 
+    // Index the styles added since the last lookup, keeping the first style with each ID.
+    for (; _indexedStyleCount < _styles.size(); ++_indexedStyleCount)
+    {
+        Style* style = _styles[_indexedStyleCount];
+        GP_ASSERT(style);
+        _styleIndex.insert(std::make_pair(hashId(style->getId()), style));
+    }
+
+    std::unordered_map<unsigned long long, Style*>::const_iterator itr = _styleIndex.find(hashId(name));
+    if (itr == _styleIndex.end())
+        return NULL;
+    if (strcmpnocase(name, itr->second->getId()) == 0)
+        return itr->second;
+
+    // Another ID has the same hash, so search all of the styles.
     for (size_t i = 0, count = _styles.size(); i < count; ++i)
     {
         GP_ASSERT(_styles[i]);
@@ -643,12 +658,12 @@ const Vector4& Theme::ThemeImage::getColor() const
 /********************
  * Theme::ImageList *
  ********************/
-Theme::ImageList::ImageList(const Vector4& color) : _color(color)
+Theme::ImageList::ImageList(const Vector4& color) : _color(color), _indexedImageCount(0)
 {
 }
 
 Theme::ImageList::ImageList(const ImageList& copy)
-    : _id(copy._id), _color(copy._color)
+    : _id(copy._id), _color(copy._color), _indexedImageCount(0)
 {
     std::vector<ThemeImage*>::const_iterator it;
     for (it = copy._images.begin(); it != copy._images.end(); ++it)
@@ -708,6 +723,22 @@ Theme::ThemeImage* Theme::ImageList::getImage(const char* imageId) const
 {
     GP_ASSERT(imageId);
 
+    // Index the images added since the last lookup, keeping the first image with each ID.
+    for (; _indexedImageCount < _images.size(); ++_indexedImageCount)
+    {
+        ThemeImage* image = _images[_indexedImageCount];
+        GP_ASSERT(image);
+        GP_ASSERT(image->getId());
+        _imageIndex.insert(std::make_pair(hashId(image->getId()), image));
+    }
+
+    std::unordered_map<unsigned long long, ThemeImage*>::const_iterator itr = _imageIndex.find(hashId(imageId));
+    if (itr == _imageIndex.end())
+        return NULL;
+    if (strcmpnocase(imageId, itr->second->getId()) == 0)
+        return itr->second;
+
+    // Another ID has the same hash, so search all of the images.
     for (size_t i = 0, count = _images.size(); i < count; ++i)
     {
         ThemeImage* image = _images[i];
@@ -844,6 +875,19 @@ void Theme::generateUVs(float tw, float th, float x, float y, float width, float
     uvs->v2 = 1.0f - ((y + height) * th);
 }
 
+unsigned long long Theme::hashId(const char* id)
+{
+    GP_ASSERT(id);
+
+    // 64-bit FNV-1a of the lower case ID, since IDs are compared without case.
+    unsigned long long hash = 14695981039346656037ULL;
+    for (const char* c = id; *c; ++c)
+    {
+        hash = (hash ^ (unsigned char)tolower(*c)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
 /*void Theme::lookUpSprites(const Properties* overlaySpace, ImageList** imageList, ThemeImage** cursor, Skin** skin)
 {
     GP_ASSERT(overlaySpace);
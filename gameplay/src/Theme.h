@@ -269,6 +269,8 @@ private:
         std::string _id;
         std::vector<ThemeImage*> _images;
         Vector4 _color;
+        mutable std::unordered_map<unsigned long long, ThemeImage*> _imageIndex;
+        mutable size_t _indexedImageCount;
     };
 
     /**
@@ -374,6 +376,8 @@ private:
 
     static void generateUVs(float tw, float th, float x, float y, float width, float height, UVs* uvs);
 
+    static unsigned long long hashId(const char* id);
+
     /*void lookUpSprites(const Properties* overlaySpace, ImageList** imageList, ThemeImage** mouseCursor, Skin** skin);*/
 
     std::string _url;
@@ -381,6 +385,8 @@ private:
     SpriteBatch* _spriteBatch;
     Theme::ThemeImage* _emptyImage;
     std::vector<Style*> _styles;
+    mutable std::unordered_map<unsigned long long, Style*> _styleIndex;
+    mutable size_t _indexedStyleCount;
     std::vector<ThemeImage*> _images;
     std::vector<ImageList*> _imageLists;
     std::vector<Skin*> _skins;
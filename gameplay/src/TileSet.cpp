@@ -2,6 +2,10 @@
 #include "TileSet.h"
 #include "Matrix.h"
 #include "Scene.h"
+#include "TextureAtlas.h"
+
+// Number of rows and columns of tiles per chunk
+#define TILESET_CHUNK_SIZE 16
 
 namespace gameplay
 {
@@ -9,7 +13,7 @@ namespace gameplay
 TileSet::TileSet() : Drawable(),
     _tiles(NULL), _tileWidth(0), _tileHeight(0),
     _rowCount(0), _columnCount(0), _width(0), _height(0),
-    _opacity(1.0f), _color(Vector4::one()), _batch(NULL)
+    _batch(NULL), _opacity(1.0f), _color(Vector4::one()), _chunkColumnCount(0), _chunkRowCount(0), _depth(0)
 {
 }
 
@@ -32,7 +36,14 @@ TileSet* TileSet::create(const char* imagePath,
     GP_ASSERT(tileWidth > 0 && tileHeight > 0);
     GP_ASSERT(rowCount > 0 && columnCount > 0);
     
-    SpriteBatch* batch = SpriteBatch::create(imagePath);
+    // Draw the tiles from an atlas page when the image was packed into a registered atlas.
+    Texture* atlasTexture = NULL;
+    Rectangle region;
+    SpriteBatch* batch;
+    if (TextureAtlas::lookup(imagePath, &atlasTexture, &region))
+        batch = SpriteBatch::create(atlasTexture);
+    else
+        batch = SpriteBatch::create(imagePath);
     batch->getSampler()->setWrapMode(Texture::CLAMP, Texture::CLAMP);
     batch->getSampler()->setFilterMode(Texture::Filter::NEAREST, Texture::Filter::NEAREST);
     batch->getStateBlock()->setDepthWrite(false);
@@ -40,6 +51,7 @@ TileSet* TileSet::create(const char* imagePath,
     
     TileSet* tileset = new TileSet();
     tileset->_batch = batch;
+    tileset->_imageOffset.set(region.x, region.y);
     tileset->_tiles = new Vector2[rowCount * columnCount];
     memset(tileset->_tiles, -1, sizeof(float) * rowCount * columnCount * 2);
     tileset->_tileWidth = tileWidth;
@@ -48,8 +60,79 @@ TileSet* TileSet::create(const char* imagePath,
     tileset->_columnCount = columnCount;
     tileset->_width = tileWidth * columnCount;
     tileset->_height = tileHeight * rowCount;
+    tileset->_projectionMatrix = batch->getProjectionMatrix();
+    tileset->initChunks();
     return tileset;
 }
+
+void TileSet::initChunks()
+{
+    _chunkColumnCount = (_columnCount + TILESET_CHUNK_SIZE - 1) / TILESET_CHUNK_SIZE;
+    _chunkRowCount = (_rowCount + TILESET_CHUNK_SIZE - 1) / TILESET_CHUNK_SIZE;
+    _chunks.clear();
+    _chunks.resize(_chunkColumnCount * _chunkRowCount);
+    for (size_t i = 0, count = _chunks.size(); i < count; ++i)
+    {
+        _chunks[i].dirty = true;
+    }
+}
+
+void TileSet::buildChunk(unsigned int chunkColumn, unsigned int chunkRow)
+{
+    Chunk& chunk = _chunks[chunkRow * _chunkColumnCount + chunkColumn];
+    chunk.vertices.clear();
+    chunk.indices.clear();
+    chunk.dirty = false;
+
+    Texture* texture = _batch->getSampler()->getTexture();
+    GP_ASSERT(texture);
+    float widthRatio = 1.0f / (float)texture->getWidth();
+    float heightRatio = 1.0f / (float)texture->getHeight();
+    Vector4 color(_color.x, _color.y, _color.z, _color.w * _opacity);
+
+    // Build the tiles in the space of the tile set, with the first row at the top, as a
+    // single triangle strip joined by degenerate triangles. The tiles are placed at the depth
+    // of the node, so tile sets drawn through a shared batcher are sorted by it.
+    unsigned int lastRow = std::min((chunkRow + 1) * TILESET_CHUNK_SIZE, _rowCount);
+    unsigned int lastColumn = std::min((chunkColumn + 1) * TILESET_CHUNK_SIZE, _columnCount);
+    for (unsigned int row = chunkRow * TILESET_CHUNK_SIZE; row < lastRow; ++row)
+    {
+        for (unsigned int col = chunkColumn * TILESET_CHUNK_SIZE; col < lastColumn; ++col)
+        {
+            // Negative values are skipped to allow blank tiles
+            const Vector2& source = _tiles[row * _columnCount + col];
+            if (source.x < 0 || source.y < 0)
+                continue;
+
+            float x = _tileWidth * col;
+            float y = _tileHeight * (_rowCount - 1 - row);
+            float u1 = widthRatio * (_imageOffset.x + source.x);
+            float v1 = 1.0f - heightRatio * (_imageOffset.y + source.y);
+            float u2 = u1 + widthRatio * _tileWidth;
+            float v2 = v1 - heightRatio * _tileHeight;
+
+            unsigned short index = (unsigned short)chunk.vertices.size();
+            if (index > 0)
+            {
+                chunk.indices.push_back(index - 1);
+                chunk.indices.push_back(index);
+            }
+            for (unsigned short i = 0; i < 4; ++i)
+            {
+                chunk.indices.push_back(index + i);
+            }
+
+            SpriteBatch::SpriteVertex v[4] =
+            {
+                { x, y + _tileHeight, _depth, u1, v1, color.x, color.y, color.z, color.w },
+                { x, y, _depth, u1, v2, color.x, color.y, color.z, color.w },
+                { x + _tileWidth, y + _tileHeight, _depth, u2, v1, color.x, color.y, color.z, color.w },
+                { x + _tileWidth, y, _depth, u2, v2, color.x, color.y, color.z, color.w }
+            };
+            chunk.vertices.insert(chunk.vertices.end(), v, v + 4);
+        }
+    }
+}
     
 /*TileSet* TileSet::create(Properties* properties)
 {
@@ -152,6 +235,7 @@ void TileSet::setTileSource(unsigned int column, unsigned int row, const Vector2
     GP_ASSERT(row < _rowCount);
     
     _tiles[row * _columnCount + column] = source;
+    _chunks[(row / TILESET_CHUNK_SIZE) * _chunkColumnCount + column / TILESET_CHUNK_SIZE].dirty = true;
 }
 
 void TileSet::getTileSource(unsigned int column, unsigned int row, Vector2* source)
@@ -196,7 +280,14 @@ float TileSet::getHeight() const
     
 void TileSet::setOpacity(float opacity)
 {
+    if (_opacity == opacity)
+        return;
+
     _opacity = opacity;
+    for (size_t i = 0, count = _chunks.size(); i < count; ++i)
+    {
+        _chunks[i].dirty = true;
+    }
 }
 
 float TileSet::getOpacity() const
@@ -206,7 +297,14 @@ float TileSet::getOpacity() const
 
 void TileSet::setColor(const Vector4& color)
 {
+    if (_color == color)
+        return;
+
     _color = color;
+    for (size_t i = 0, count = _chunks.size(); i < count; ++i)
+    {
+        _chunks[i].dirty = true;
+    }
 }
 
 const Vector4& TileSet::getColor() const
@@ -217,6 +315,7 @@ const Vector4& TileSet::getColor() const
 unsigned int TileSet::draw(bool wireframe)
 {
     // Apply scene camera projection and translation offsets
+    Matrix projectionMatrix = _projectionMatrix;
     Vector3 position = Vector3::zero();
     if (_node && _node->getScene())
     {
@@ -227,9 +326,7 @@ unsigned int TileSet::draw(bool wireframe)
             if (cameraNode)
             {
                 // Scene projection
-                Matrix projectionMatrix;
                 projectionMatrix = _node->getProjectionMatrix();
-                _batch->setProjectionMatrix(projectionMatrix);
 
                 position.x -= cameraNode->getTranslationWorld().x;
                 position.y -= cameraNode->getTranslationWorld().y;
@@ -240,33 +337,69 @@ unsigned int TileSet::draw(bool wireframe)
         Vector3 translation = _node->getTranslationWorld();
         position.x += translation.x;
         position.y += translation.y;
-        position.z += translation.z;
+
+        // The depth is written into the chunk vertices, so they are rebuilt when it changes.
+        if (_depth != translation.z)
+        {
+            _depth = translation.z;
+            for (size_t i = 0, count = _chunks.size(); i < count; ++i)
+            {
+                _chunks[i].dirty = true;
+            }
+        }
     }
-    
-    // Draw each cell in the tile set
-    position.y += _tileHeight * (_rowCount - 1);
-    float xStart = position.x;
+
+    // The chunks are cached in the space of the tile set, so move them into place with the projection.
+    // Tile sets at the same position share the projection and can be merged by a batcher.
+    Matrix translationMatrix;
+    Matrix::createTranslation(position, &translationMatrix);
+    _batch->setProjectionMatrix(projectionMatrix * translationMatrix);
+
+    // Find the tiles in view. The view can only be bounded for orthographic projections.
+    unsigned int firstChunkColumn = 0;
+    unsigned int lastChunkColumn = _chunkColumnCount;
+    unsigned int firstChunkRow = 0;
+    unsigned int lastChunkRow = _chunkRowCount;
+    Matrix inverse;
+    const float* m = projectionMatrix.m;
+    if (m[3] == 0.0f && m[7] == 0.0f && m[11] == 0.0f && projectionMatrix.invert(&inverse))
+    {
+        Vector3 corner;
+        float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            inverse.transformPoint(Vector3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, 0.0f), &corner);
+            minX = std::min(minX, corner.x - position.x);
+            maxX = std::max(maxX, corner.x - position.x);
+            minY = std::min(minY, corner.y - position.y);
+            maxY = std::max(maxY, corner.y - position.y);
+        }
+
+        // Rows are counted from the top of the tile set.
+        float chunkWidth = _tileWidth * TILESET_CHUNK_SIZE;
+        float chunkHeight = _tileHeight * TILESET_CHUNK_SIZE;
+        if (maxX < 0 || maxY < 0 || minX >= _width || minY >= _height)
+            return 0;
+        firstChunkColumn = (unsigned int)(std::max(minX, 0.0f) / chunkWidth);
+        lastChunkColumn = std::min((unsigned int)(maxX / chunkWidth) + 1, _chunkColumnCount);
+        firstChunkRow = (unsigned int)(std::max(_height - maxY, 0.0f) / chunkHeight);
+        lastChunkRow = std::min((unsigned int)((_height - minY) / chunkHeight) + 1, _chunkRowCount);
+    }
+
+    // Draw the visible chunks, rebuilding those that changed.
     _batch->start();
-    for (unsigned int row = 0; row < _rowCount; row++)
+    for (unsigned int chunkRow = firstChunkRow; chunkRow < lastChunkRow; ++chunkRow)
     {
-        for (unsigned int col = 0; col < _columnCount; col++)
+        for (unsigned int chunkColumn = firstChunkColumn; chunkColumn < lastChunkColumn; ++chunkColumn)
         {
-            Vector2 scale = Vector2(_tileWidth, _tileHeight);
-            
-            // Negative values are skipped to allow blank tiles
-            if (_tiles[row * _columnCount + col].x >= 0 &&
-                _tiles[row * _columnCount + col].y >= 0)
+            Chunk& chunk = _chunks[chunkRow * _chunkColumnCount + chunkColumn];
+            if (chunk.dirty)
+                buildChunk(chunkColumn, chunkRow);
+            if (!chunk.vertices.empty())
             {
-                Rectangle source = Rectangle(_tiles[row * _columnCount + col].x,
-                                             _tiles[row * _columnCount + col].y, _tileWidth, _tileHeight);
-                _batch->draw(position, source, scale, Vector4(_color.x, _color.y, _color.z, _color.w * _opacity),
-                             Vector2(0.5f, 0.5f), 0);
+                _batch->draw(&chunk.vertices[0], (unsigned int)chunk.vertices.size(), &chunk.indices[0], (unsigned int)chunk.indices.size());
             }
-            
-            position.x += _tileWidth;
         }
-        position.x = xStart;
-        position.y -= _tileHeight;
     }
     _batch->finish();
     return 1;
@@ -277,18 +410,20 @@ Drawable* TileSet::clone(NodeCloneContext& context)
     TileSet* tilesetClone = new TileSet();
 
     // Clone properties
-    tilesetClone->_tiles = new Vector2[tilesetClone->_rowCount * tilesetClone->_columnCount];
-    memset(tilesetClone->_tiles, -1, sizeof(float) * tilesetClone->_rowCount * tilesetClone->_columnCount * 2);
-    memcpy(tilesetClone->_tiles, _tiles, sizeof(Vector2) * tilesetClone->_rowCount * tilesetClone->_columnCount);
     tilesetClone->_tileWidth = _tileWidth;
     tilesetClone->_tileHeight = _tileHeight;
     tilesetClone->_rowCount = _rowCount;
     tilesetClone->_columnCount = _columnCount;
+    tilesetClone->_tiles = new Vector2[tilesetClone->_rowCount * tilesetClone->_columnCount];
+    memcpy(tilesetClone->_tiles, _tiles, sizeof(Vector2) * tilesetClone->_rowCount * tilesetClone->_columnCount);
     tilesetClone->_width = _tileWidth * _columnCount;
     tilesetClone->_height = _tileHeight * _rowCount;
     tilesetClone->_opacity = _opacity;
     tilesetClone->_color = _color;
     tilesetClone->_batch = _batch;
+    tilesetClone->_imageOffset = _imageOffset;
+    tilesetClone->_projectionMatrix = _projectionMatrix;
+    tilesetClone->initChunks();
 
     return tilesetClone;
 }
@@ -25,6 +25,11 @@ namespace gameplay
  * a gutter of duplicate pixels on each side of the region.
  *
  * The tile set does not support rotation or scaling.
+ *
+ * The tiles are drawn in chunks of 16 x 16 tiles whose vertices are built once and
+ * only rebuilt after a tile, the color or the opacity of the chunk changes. Where the
+ * projection is orthographic, only the chunks overlapping the view are drawn, so the
+ * cost of drawing a large map depends on the visible area rather than on the map size.
  */
 class TileSet : public Ref, public Drawable
 {
@@ -175,6 +180,20 @@ protected:
 
 private:
 
+    /**
+     * A block of tiles whose vertices are cached.
+     */
+    struct Chunk
+    {
+        std::vector<SpriteBatch::SpriteVertex> vertices;
+        std::vector<unsigned short> indices;
+        bool dirty;
+    };
+
+    void initChunks();
+
+    void buildChunk(unsigned int chunkColumn, unsigned int chunkRow);
+
     Vector2* _tiles;
     float _tileWidth;
     float _tileHeight;
@@ -183,8 +202,14 @@ private:
     float _width;
     float _height;
     SpriteBatch* _batch;
+    Vector2 _imageOffset;
     float _opacity;
     Vector4 _color;
+    Matrix _projectionMatrix;
+    std::vector<Chunk> _chunks;
+    unsigned int _chunkColumnCount;
+    unsigned int _chunkRowCount;
+    float _depth;
 };
     
 }
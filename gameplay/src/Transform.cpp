@@ -482,6 +482,9 @@ void Transform::setScale(float sx, float sy, float sz)
 
 void Transform::setScale(const Vector3& scale)
 {
+    if (isStatic())
+        return;
+
     _scale.set(scale);
     dirty(DIRTY_SCALE);
 }
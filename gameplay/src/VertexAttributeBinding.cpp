@@ -68,7 +68,29 @@ VertexAttributeBinding* VertexAttributeBinding::create(const VertexFormat& verte
     return create(NULL, vertexFormat, vertexPointer, effect);
 }
 
-VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect)
+VertexAttributeBinding* VertexAttributeBinding::create(const VertexFormat& vertexFormat, VertexBufferHandle vertexBuffer, Effect* effect)
+{
+    GP_ASSERT(vertexBuffer);
+
+    return create(NULL, vertexFormat, 0, effect, NULL, 0, vertexBuffer);
+}
+
+VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, Effect* effect, const VertexFormat& instanceFormat, VertexBufferHandle instanceBuffer)
+{
+    GP_ASSERT(mesh);
+    GP_ASSERT(instanceBuffer);
+
+#ifdef GP_USE_INSTANCING
+    if (glVertexAttribDivisor)
+    {
+        return create(mesh, mesh->getVertexFormat(), 0, effect, &instanceFormat, instanceBuffer);
+    }
+#endif
+    return NULL;
+}
+
+VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect,
+                                                       const VertexFormat* instanceFormat, GLuint instanceBuffer, GLuint vertexBuffer)
 {
     GP_ASSERT(effect);
 
@@ -90,7 +112,7 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
     VertexAttributeBinding* b = new VertexAttributeBinding();
 
 #ifdef GP_USE_VAO
-    if (mesh && glGenVertexArrays)
+    if ((mesh || vertexBuffer) && glGenVertexArrays)
     {
         GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
         GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
@@ -109,7 +131,7 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
         GL_ASSERT( glBindVertexArray(b->_handle) );
 
         // Bind the Mesh VBO so our glVertexAttribPointer calls use it.
-        GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, mesh->getVertexBuffer()) );
+        GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, mesh ? mesh->getVertexBuffer() : vertexBuffer) );
     }
     else
 #endif
@@ -125,6 +147,8 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
             attribs[i].type = GL_FLOAT;
             attribs[i].normalized = GL_FALSE;
             attribs[i].pointer = 0;
+            attribs[i].buffer = 0;
+            attribs[i].divisor = 0;
         }
         b->_attributes = attribs;
     }
@@ -139,6 +163,30 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
     effect->addRef();
 
     // Call setVertexAttribPointer for each vertex element.
+    b->setVertexAttribPointers(vertexFormat, vertexPointer, effect, vertexBuffer, 0);
+
+    // Per-instance elements are read from the instance buffer and advanced once per instance.
+    if (instanceFormat)
+    {
+        if (b->_handle)
+        {
+            GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer) );
+        }
+        b->setVertexAttribPointers(*instanceFormat, 0, effect, instanceBuffer, 1);
+    }
+
+    if (b->_handle)
+    {
+        GL_ASSERT( glBindVertexArray(0) );
+    }
+
+    return b;
+}
+
+void VertexAttributeBinding::setVertexAttribPointers(const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect, GLuint buffer, GLuint divisor)
+{
+    GP_ASSERT(effect);
+
     std::string name;
     size_t offset = 0;
     for (size_t i = 0, count = vertexFormat.getElementCount(); i < count; ++i)
@@ -185,6 +233,12 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
             name += '0' + (e.usage - VertexFormat::TEXCOORD0);
             attrib = effect->getVertexAttribute(name.c_str());
             break;
+        case VertexFormat::INSTANCE_MATRIX:
+            attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME);
+            break;
+        case VertexFormat::INSTANCE_PARAMETER:
+            attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_INSTANCE_PARAMETER_NAME);
+            break;
         default:
             // This happens whenever vertex data contains extra information (not an error).
             attrib = -1;
@@ -195,24 +249,27 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
         {
             //GP_WARN("Warning: Vertex element with usage '%s' in mesh '%s' does not correspond to an attribute in effect '%s'.", VertexFormat::toString(e.usage), mesh->getUrl(), effect->getId());
         }
+        else if (e.size > 4)
+        {
+            // Matrix attributes occupy one attribute location per column.
+            for (unsigned int column = 0; column < e.size / 4; ++column)
+            {
+                size_t columnOffset = offset + column * 4 * sizeof(float);
+                void* pointer = vertexPointer ? (void*)(((unsigned char*)vertexPointer) + columnOffset) : (void*)columnOffset;
+                setVertexAttribPointer(attrib + column, 4, GL_FLOAT, GL_FALSE, (GLsizei)vertexFormat.getVertexSize(), pointer, buffer, divisor);
+            }
+        }
         else
         {
             void* pointer = vertexPointer ? (void*)(((unsigned char*)vertexPointer) + offset) : (void*)offset;
-            b->setVertexAttribPointer(attrib, (GLint)e.size, GL_FLOAT, GL_FALSE, (GLsizei)vertexFormat.getVertexSize(), pointer);
+            setVertexAttribPointer(attrib, (GLint)e.size, GL_FLOAT, GL_FALSE, (GLsizei)vertexFormat.getVertexSize(), pointer, buffer, divisor);
         }
 
         offset += e.size * sizeof(float);
     }
-
-    if (b->_handle)
-    {
-        GL_ASSERT( glBindVertexArray(0) );
-    }
-
-    return b;
 }
 
-void VertexAttributeBinding::setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer)
+void VertexAttributeBinding::setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer, GLuint buffer, GLuint divisor)
 {
     GP_ASSERT(indx < (GLuint)__maxVertexAttribs);
 
@@ -221,6 +278,12 @@ void VertexAttributeBinding::setVertexAttribPointer(GLuint indx, GLint size, GLe
         // Hardware mode.
         GL_ASSERT( glVertexAttribPointer(indx, size, type, normalize, stride, pointer) );
         GL_ASSERT( glEnableVertexAttribArray(indx) );
+#ifdef GP_USE_INSTANCING
+        if (divisor)
+        {
+            GL_ASSERT( glVertexAttribDivisor(indx, divisor) );
+        }
+#endif
     }
     else
     {
@@ -232,6 +295,8 @@ void VertexAttributeBinding::setVertexAttribPointer(GLuint indx, GLint size, GLe
         _attributes[indx].normalized = normalize;
         _attributes[indx].stride = stride;
         _attributes[indx].pointer = pointer;
+        _attributes[indx].buffer = buffer;
+        _attributes[indx].divisor = divisor;
     }
 }
 
@@ -260,8 +325,22 @@ void VertexAttributeBinding::bind()
             VertexAttribute& a = _attributes[i];
             if (a.enabled)
             {
+                if (a.buffer)
+                {
+                    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, a.buffer) );
+                }
                 GL_ASSERT( glVertexAttribPointer(i, a.size, a.type, a.normalized, a.stride, a.pointer) );
                 GL_ASSERT( glEnableVertexAttribArray(i) );
+#ifdef GP_USE_INSTANCING
+                if (a.divisor)
+                {
+                    GL_ASSERT( glVertexAttribDivisor(i, a.divisor) );
+                }
+#endif
+                if (a.buffer)
+                {
+                    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _mesh ? _mesh->getVertexBuffer() : 0) );
+                }
             }
         }
     }
@@ -288,6 +367,12 @@ void VertexAttributeBinding::unbind()
             if (_attributes[i].enabled)
             {
                 GL_ASSERT( glDisableVertexAttribArray(i) );
+#ifdef GP_USE_INSTANCING
+                if (_attributes[i].divisor)
+                {
+                    GL_ASSERT( glVertexAttribDivisor(i, 0) );
+                }
+#endif
             }
         }
     }
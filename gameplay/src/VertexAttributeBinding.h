@@ -68,6 +68,42 @@ public:
      */
     static VertexAttributeBinding* create(const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect);
 
+    /**
+     * Creates a vertex attribute binding that reads the vertices from the given vertex buffer.
+     *
+     * This is used for vertex buffers that are not owned by a mesh, such as the streaming
+     * buffers of a MeshBatch. The binding refers to the buffer handle, so the contents of
+     * the buffer can be replaced without creating a new binding. These bindings are not
+     * shared, so the caller owns the returned binding.
+     *
+     * @param vertexFormat The vertex format.
+     * @param vertexBuffer The vertex buffer holding the vertices.
+     * @param effect The effect.
+     *
+     * @return A VertexAttributeBinding for the requested parameters.
+     * @script{ignore}
+     */
+    static VertexAttributeBinding* create(const VertexFormat& vertexFormat, VertexBufferHandle vertexBuffer, Effect* effect);
+
+    /**
+     * Creates a new VertexAttributeBinding between the given Mesh and Effect that
+     * also binds per-instance attributes from the specified instance buffer.
+     *
+     * The elements of the instance format are advanced once per instance rather than
+     * once per vertex, for drawing the mesh with instanced draw calls. Instanced
+     * bindings are not shared, so the caller owns the returned binding.
+     *
+     * @param mesh The mesh.
+     * @param effect The effect.
+     * @param instanceFormat The format of a single instance in the instance buffer.
+     * @param instanceBuffer The vertex buffer holding the per-instance data.
+     *
+     * @return A VertexAttributeBinding for the requested parameters, or NULL if
+     *      instanced vertex attributes are not supported.
+     * @script{ignore}
+     */
+    static VertexAttributeBinding* create(Mesh* mesh, Effect* effect, const VertexFormat& instanceFormat, VertexBufferHandle instanceBuffer);
+
     /**
      * Binds this vertex array object.
      */
@@ -89,6 +125,8 @@ private:
         bool normalized;
         unsigned int stride;
         void* pointer;
+        GLuint buffer;
+        GLuint divisor;
     };
 
     /**
@@ -106,9 +144,12 @@ private:
      */
     VertexAttributeBinding& operator=(const VertexAttributeBinding&);
 
-    static VertexAttributeBinding* create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect);
+    static VertexAttributeBinding* create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect,
+                                          const VertexFormat* instanceFormat = NULL, GLuint instanceBuffer = 0, GLuint vertexBuffer = 0);
+
+    void setVertexAttribPointers(const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect, GLuint buffer, GLuint divisor);
 
-    void setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer);
+    void setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer, GLuint buffer = 0, GLuint divisor = 0);
 
     GLuint _handle;
     VertexAttribute* _attributes;
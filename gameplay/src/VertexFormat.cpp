@@ -129,6 +129,10 @@ const char* VertexFormat::enumToString(const char* enumName, int value)
                 return "TEXCOORD6";
             case VertexFormat::TEXCOORD7:
                 return "TEXCOORD7";
+            case VertexFormat::INSTANCE_MATRIX:
+                return "INSTANCE_MATRIX";
+            case VertexFormat::INSTANCE_PARAMETER:
+                return "INSTANCE_PARAMETER";
             default:
                 return "UNKNOWN";
         }
@@ -170,6 +174,10 @@ int VertexFormat::enumParse(const char* enumName, const char* str)
             return VertexFormat::TEXCOORD6;
         else if (std::strcmp("TEXCOORD7", str) == 0)
             return VertexFormat::TEXCOORD7;
+        else if (std::strcmp("INSTANCE_MATRIX", str) == 0)
+            return VertexFormat::INSTANCE_MATRIX;
+        else if (std::strcmp("INSTANCE_PARAMETER", str) == 0)
+            return VertexFormat::INSTANCE_PARAMETER;
     }
     return -1;
 }
@@ -37,7 +37,17 @@ public:
         TEXCOORD4 = 12,
         TEXCOORD5 = 13,
         TEXCOORD6 = 14,
-        TEXCOORD7 = 15
+        TEXCOORD7 = 15,
+
+        /**
+         * A per-instance world matrix (16 floats), advanced once per instance.
+         */
+        INSTANCE_MATRIX = 16,
+
+        /**
+         * A per-instance parameter (1-4 floats), advanced once per instance.
+         */
+        INSTANCE_PARAMETER = 17
     };
 
     /**
@@ -47,6 +57,10 @@ public:
      * have a varying number of float values (1-4), which is represented
      * by the size attribute. Additionally, vertex elements are assumed
      * to be tightly packed.
+     *
+     * Elements with an INSTANCE_ usage describe per-instance data stored in
+     * a separate instance buffer (see VertexAttributeBinding). An INSTANCE_MATRIX
+     * element has a size of 16 and is bound to four consecutive attributes.
      */
     class Element : public Serializable
     {
@@ -34,6 +34,7 @@
 // Graphics
 #include "Image.h"
 #include "Texture.h"
+#include "TextureAtlas.h"
 #include "Mesh.h"
 #include "MeshPart.h"
 #include "Effect.h"
@@ -43,17 +44,23 @@
 #include "VertexAttributeBinding.h"
 #include "Drawable.h"
 #include "Model.h"
+#include "RenderCommandList.h"
+#include "ModelBatch.h"
 #include "Camera.h"
 #include "Light.h"
 #include "Node.h"
 #include "Joint.h"
 #include "Scene.h"
+#include "StaticBatcher.h"
 #include "Font.h"
+#include "GlyphAtlas.h"
 #include "SpriteBatch.h"
+#include "SpriteBatcher.h"
 #include "Sprite.h"
 #include "Text.h"
 #include "TileSet.h"
 #include "ParticleEmitter.h"
+#include "ParticleSystem.h"
 #include "FrameBuffer.h"
 #include "RenderTarget.h"
 #include "DepthStencilTarget.h"
@@ -102,6 +109,7 @@
 #include "Control.h"
 #include "ControlFactory.h"
 #include "Container.h"
+#include "ListContainer.h"
 #include "Form.h"
 #include "Label.h"
 #include "Button.h"